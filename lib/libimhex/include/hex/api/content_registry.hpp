@@ -904,13 +904,11 @@ namespace hex {
                     [[nodiscard]] const Hash *getType() const { return m_type; }
                     [[nodiscard]] const std::string &getName() const { return m_name; }
 
-                    const std::vector<u8>& get(const Region& region, prv::Provider *provider) {
-                        if (m_cache.empty()) {
-                            m_cache = m_callback(region, provider);
-                        }
-
-                        return m_cache;
-                    }
+                    /**
+                     * @brief Gets the hash of the given region
+                     * @note The result is cached until reset() is called or the region's data gets modified
+                     */
+                    const std::vector<u8>& get(const Region& region, prv::Provider *provider);
 
                     void reset() {
                         m_cache.clear();
@@ -922,6 +920,7 @@ namespace hex {
                     Callback m_callback;
 
                     std::vector<u8> m_cache;
+                    u64 m_cacheGeneration = 0;
                 };
 
                 virtual void draw() { }
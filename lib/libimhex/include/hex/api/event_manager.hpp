@@ -35,6 +35,10 @@ struct GLFWwindow;
 namespace hex {
     class Achievement;
     class View;
+
+    namespace prv {
+        class WriteBatch;
+    }
 }
 
 
@@ -254,6 +258,7 @@ namespace hex {
     EVENT_DEF(EventViewOpened, View*);
 
     EVENT_DEF(EventProviderDataModified, prv::Provider *, u64, u64, const u8*);
+    EVENT_DEF(EventProviderDataBatchModified, prv::Provider *, const prv::WriteBatch &);
     EVENT_DEF(EventProviderDataInserted, prv::Provider *, u64, u64);
     EVENT_DEF(EventProviderDataRemoved, prv::Provider *, u64, u64);
 
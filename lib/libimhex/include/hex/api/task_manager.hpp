@@ -142,6 +142,17 @@ namespace hex {
          */
         static TaskHolder createBackgroundTask(std::string name, std::function<void(Task &)> function);
 
+        /**
+         * @brief Calls a function for every index in [0, count) on all worker threads and waits for all calls to finish
+         * @note Has to be called from within a task. The calling task works on the indices as well and reports the number
+         * of finished ones as its progress. Exceptions thrown by the function, including the interruption of the calling
+         * task, are rethrown once no worker is using the function anymore
+         * @param task Task this function is called from
+         * @param count Number of indices
+         * @param function Function to be executed for every index
+         */
+        static void parallelFor(Task &task, u64 count, const std::function<void(u64 index)> &function);
+
         /**
          * @brief Creates a new synchronous task that will execute the given function at the start of the next frame
          * @param function Function to be executed
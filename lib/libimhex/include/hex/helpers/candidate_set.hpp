@@ -0,0 +1,101 @@
+#pragma once
+
+#include <hex.hpp>
+
+#include <functional>
+#include <span>
+#include <vector>
+
+namespace hex {
+
+    /**
+     * @brief Compact set of candidate addresses, each stored together with the value it had when it was last checked
+     * @note Candidates are grouped into blocks covering BlockSize addresses each. Blocks with many candidates store their positions
+     * as a bitmap, blocks with only a few of them as a sorted array of 16 bit offsets. That keeps the positions at no more than
+     * two bytes per candidate and never more than BlockSize / 8 bytes per block.
+     * The previous values can't be dropped in favour of reading them from a snapshot later on, since the data of providers like the
+     * process memory provider changes without going through the provider. The total memory used is therefore the number of candidates
+     * times the value size, plus the positions on top of that. Use getMemoryUsage() to find out how much that is for a given set
+     */
+    class CandidateSet {
+    public:
+        constexpr static u64 BlockSize = 0x1'0000;
+
+        class Block {
+        public:
+            /**
+             * @brief Creates a block from the candidates found in it
+             * @param address Address of the first byte covered by the block
+             * @param valueSize Size of a single value in bytes
+             * @param offsets Offsets of the candidates relative to the block address, sorted and without duplicates
+             * @param values Values of all candidates packed one after another, in the same order as the offsets
+             */
+            Block(u64 address, size_t valueSize, std::span<const u16> offsets, std::span<const u8> values);
+
+            [[nodiscard]] u64 getAddress() const { return m_address; }
+            [[nodiscard]] size_t getValueSize() const { return m_valueSize; }
+            [[nodiscard]] size_t getCount() const { return m_count; }
+
+            /**
+             * @brief Checks if the candidates are stored as a bitmap instead of a list of offsets
+             */
+            [[nodiscard]] bool isDense() const { return !m_bitmap.empty(); }
+
+            [[nodiscard]] bool contains(u64 address) const;
+
+            /**
+             * @brief Gets the offsets of all candidates relative to the block address in ascending order
+             */
+            [[nodiscard]] std::vector<u16> getOffsets() const;
+
+            /**
+             * @brief Gets the packed values of all candidates in the same order as getOffsets()
+             */
+            [[nodiscard]] std::span<const u8> getValues() const { return m_values; }
+
+            /**
+             * @brief Gets the number of bytes used to store the block's candidates and values
+             */
+            [[nodiscard]] size_t getMemoryUsage() const;
+
+        private:
+            u64 m_address;
+            size_t m_valueSize;
+            size_t m_count;
+
+            std::vector<u64> m_bitmap;
+            std::vector<u16> m_offsets;
+            std::vector<u8> m_values;
+        };
+
+        /**
+         * @brief Adds a block to the end of the set
+         * @note Blocks have to be added ordered by address. Blocks without any candidates are dropped
+         */
+        void addBlock(Block block);
+
+        [[nodiscard]] const std::vector<Block>& getBlocks() const { return m_blocks; }
+
+        /**
+         * @brief Gets the total number of candidates in all blocks
+         */
+        [[nodiscard]] u64 getCount() const { return m_count; }
+
+        [[nodiscard]] size_t getMemoryUsage() const;
+
+        [[nodiscard]] bool contains(u64 address) const;
+
+        /**
+         * @brief Calls the callback for every candidate, ordered by address
+         */
+        void forEach(const std::function<void(u64 address, std::span<const u8> value)> &callback) const;
+
+        void clear() { m_blocks.clear(); m_count = 0; }
+        [[nodiscard]] bool empty() const { return m_blocks.empty(); }
+
+    private:
+        std::vector<Block> m_blocks;
+        u64 m_count = 0;
+    };
+
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <hex.hpp>
+
+#include <functional>
+#include <map>
+#include <span>
+#include <vector>
+
+namespace hex {
+
+    /**
+     * @brief Sparse map of bytes stored as runs of consecutive bytes (extents) ordered by address
+     * @note Writing to overlapping or directly adjacent addresses merges the data into a single extent, later writes
+     * overwrite earlier ones. Compared to a map with one entry per byte, this needs memory proportional to the amount of
+     * data plus a small overhead per extent
+     */
+    class ExtentMap {
+    public:
+        /**
+         * @brief Stores data in the map
+         * @param address address of the first byte
+         * @param buffer data to store
+         * @param size number of bytes to store
+         */
+        void write(u64 address, const void *buffer, size_t size);
+
+        /**
+         * @brief Removes all bytes in the range [address, address + size) from the map
+         */
+        void erase(u64 address, u64 size);
+
+        /**
+         * @brief Moves all bytes at or after the given address up by the given number of bytes
+         */
+        void insertGap(u64 address, u64 size);
+
+        /**
+         * @brief Removes all bytes in the range [address, address + size) and moves all bytes after it down to close the gap
+         */
+        void removeRange(u64 address, u64 size);
+
+        [[nodiscard]] bool contains(u64 address) const;
+
+        void clear() { m_extents.clear(); }
+        [[nodiscard]] bool empty() const { return m_extents.empty(); }
+
+        /**
+         * @brief Gets the number of extents in the map
+         */
+        [[nodiscard]] size_t getExtentCount() const { return m_extents.size(); }
+
+        /**
+         * @brief Gets the total number of bytes stored in the map
+         */
+        [[nodiscard]] u64 getSize() const;
+
+        /**
+         * @brief Gets the address one past the last byte stored in the map
+         */
+        [[nodiscard]] u64 getEndAddress() const;
+
+        /**
+         * @brief Gets the regions covered by the extents, sorted by address
+         */
+        [[nodiscard]] std::vector<Region> getRegions() const;
+
+        /**
+         * @brief Calls the callback for every extent, ordered by address
+         */
+        void forEachExtent(const std::function<void(u64 address, std::span<const u8> data)> &callback) const;
+
+    private:
+        std::map<u64, std::vector<u8>> m_extents;
+    };
+
+}
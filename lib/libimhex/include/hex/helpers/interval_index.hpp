@@ -0,0 +1,220 @@
+#pragma once
+
+#include <hex.hpp>
+
+#include <algorithm>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace hex {
+
+    /**
+     * @brief Index of half-open intervals that allows finding all intervals overlapping a range in O(log n + k)
+     * @note Implemented as a treap ordered by (start, id) where every node additionally stores the largest end
+     * address found in its subtree. This allows skipping entire subtrees that cannot contain any overlapping interval.
+     * The id is chosen by the caller and is used to tell apart intervals that start at the same address
+     * @tparam T Value stored alongside each interval
+     */
+    template<typename T>
+    class IntervalIndex {
+    public:
+        IntervalIndex() = default;
+
+        IntervalIndex(const IntervalIndex &) = delete;
+        IntervalIndex(IntervalIndex &&) noexcept = default;
+        IntervalIndex& operator=(const IntervalIndex &) = delete;
+        IntervalIndex& operator=(IntervalIndex &&) noexcept = default;
+
+        /**
+         * @brief Adds a new interval to the index
+         * @param start First address of the interval
+         * @param end Address one past the last address of the interval. Empty intervals are ignored
+         * @param id Caller chosen identifier, must be unique among all intervals with the same start address
+         * @param value Value to store
+         */
+        void insert(u64 start, u64 end, u64 id, T value) {
+            if (end <= start)
+                return;
+
+            auto node = std::make_unique<Node>(Node { start, end, id, std::move(value), this->nextPriority(), end, 0, nullptr, nullptr });
+            update(node);
+
+            auto [left, right] = split(std::move(m_root), start, id);
+            m_root = merge(merge(std::move(left), std::move(node)), std::move(right));
+        }
+
+        /**
+         * @brief Removes an interval from the index
+         * @param start First address of the interval
+         * @param id Identifier the interval was inserted with
+         * @return True if the interval was found and removed
+         */
+        bool erase(u64 start, u64 id) {
+            auto [left, rest] = split(std::move(m_root), start, id);
+            auto [match, right] = splitAfter(std::move(rest), start, id);
+
+            const bool found = match != nullptr;
+            m_root = merge(std::move(left), std::move(right));
+
+            return found;
+        }
+
+        void clear() {
+            m_root.reset();
+        }
+
+        [[nodiscard]] bool empty() const { return m_root == nullptr; }
+        [[nodiscard]] size_t size() const { return m_root == nullptr ? 0 : m_root->count; }
+
+        /**
+         * @brief Checks if any interval overlaps the range [start, end)
+         */
+        [[nodiscard]] bool overlaps(u64 start, u64 end) const {
+            bool result = false;
+            this->visit(m_root.get(), start, end, [&](u64, u64, u64, const T &) {
+                result = true;
+                return false;
+            });
+
+            return result;
+        }
+
+        /**
+         * @brief Calls the callback for every interval overlapping the range [start, end), ordered by start address
+         * @param callback Called with the start, end, id and value of the interval. Returning false stops the iteration
+         */
+        template<typename Callback>
+        void forEachOverlapping(u64 start, u64 end, Callback &&callback) const {
+            this->visit(m_root.get(), start, end, [&](u64 intervalStart, u64 intervalEnd, u64 id, const T &value) {
+                if constexpr (std::is_same_v<std::invoke_result_t<Callback, u64, u64, u64, const T&>, void>) {
+                    callback(intervalStart, intervalEnd, id, value);
+                    return true;
+                } else {
+                    return bool(callback(intervalStart, intervalEnd, id, value));
+                }
+            });
+        }
+
+    private:
+        struct Node {
+            u64 start, end, id;
+            T value;
+
+            u32 priority;
+            u64 maxEnd;
+            size_t count;
+
+            std::unique_ptr<Node> left, right;
+        };
+
+        using NodePtr = std::unique_ptr<Node>;
+
+        static void update(NodePtr &node) {
+            node->maxEnd = node->end;
+            node->count  = 1;
+
+            for (const auto &child : { node->left.get(), node->right.get() }) {
+                if (child != nullptr) {
+                    node->maxEnd = std::max(node->maxEnd, child->maxEnd);
+                    node->count += child->count;
+                }
+            }
+        }
+
+        static bool isBefore(const Node &node, u64 start, u64 id) {
+            return node.start < start || (node.start == start && node.id < id);
+        }
+
+        // Splits into nodes ordered before (start, id) and all remaining ones
+        static std::pair<NodePtr, NodePtr> split(NodePtr &&node, u64 start, u64 id) {
+            if (node == nullptr)
+                return { nullptr, nullptr };
+
+            if (isBefore(*node, start, id)) {
+                auto [left, right] = split(std::move(node->right), start, id);
+                node->right = std::move(left);
+                update(node);
+
+                return { std::move(node), std::move(right) };
+            } else {
+                auto [left, right] = split(std::move(node->left), start, id);
+                node->left = std::move(right);
+                update(node);
+
+                return { std::move(left), std::move(node) };
+            }
+        }
+
+        // Splits into nodes ordered before or equal to (start, id) and all remaining ones
+        static std::pair<NodePtr, NodePtr> splitAfter(NodePtr &&node, u64 start, u64 id) {
+            if (node == nullptr)
+                return { nullptr, nullptr };
+
+            if (isBefore(*node, start, id) || (node->start == start && node->id == id)) {
+                auto [left, right] = splitAfter(std::move(node->right), start, id);
+                node->right = std::move(left);
+                update(node);
+
+                return { std::move(node), std::move(right) };
+            } else {
+                auto [left, right] = splitAfter(std::move(node->left), start, id);
+                node->left = std::move(right);
+                update(node);
+
+                return { std::move(left), std::move(node) };
+            }
+        }
+
+        static NodePtr merge(NodePtr &&left, NodePtr &&right) {
+            if (left == nullptr)
+                return std::move(right);
+            if (right == nullptr)
+                return std::move(left);
+
+            if (left->priority > right->priority) {
+                left->right = merge(std::move(left->right), std::move(right));
+                update(left);
+
+                return std::move(left);
+            } else {
+                right->left = merge(std::move(left), std::move(right->left));
+                update(right);
+
+                return std::move(right);
+            }
+        }
+
+        template<typename Callback>
+        static bool visit(const Node *node, u64 start, u64 end, Callback &&callback) {
+            // Nothing in this subtree ends after the start of the range
+            if (node == nullptr || node->maxEnd <= start)
+                return true;
+
+            if (!visit(node->left.get(), start, end, callback))
+                return false;
+
+            // Everything from here on starts after the end of the range
+            if (node->start >= end)
+                return true;
+
+            if (node->end > start && !callback(node->start, node->end, node->id, node->value))
+                return false;
+
+            return visit(node->right.get(), start, end, callback);
+        }
+
+        u32 nextPriority() {
+            m_seed ^= m_seed << 13;
+            m_seed ^= m_seed >> 17;
+            m_seed ^= m_seed << 5;
+
+            return m_seed;
+        }
+
+    private:
+        NodePtr m_root;
+        u32 m_seed = 0x2545'F491;
+    };
+
+}
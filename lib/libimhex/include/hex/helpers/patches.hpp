@@ -1,8 +1,10 @@
 #pragma once
 
 #include <hex.hpp>
+#include <hex/helpers/extent_map.hpp>
 
-#include <map>
+#include <functional>
+#include <span>
 #include <vector>
 
 #include <wolv/utils/expected.hpp>
@@ -24,19 +26,33 @@ namespace hex {
     class Patches {
     public:
         Patches() = default;
-        Patches(std::map<u64, u8> &&patches) : m_patches(std::move(patches)) {}
+        Patches(ExtentMap &&patches) : m_patches(std::move(patches)) {}
 
         static wolv::util::Expected<Patches, IPSError> fromProvider(hex::prv::Provider *provider);
-        static wolv::util::Expected<Patches, IPSError> fromIPSPatch(const std::vector<u8> &ipsPatch);
-        static wolv::util::Expected<Patches, IPSError> fromIPS32Patch(const std::vector<u8> &ipsPatch);
+        static wolv::util::Expected<Patches, IPSError> fromIPSPatch(std::span<const u8> ipsPatch);
+        static wolv::util::Expected<Patches, IPSError> fromIPS32Patch(std::span<const u8> ipsPatch);
 
         wolv::util::Expected<std::vector<u8>, IPSError> toIPSPatch() const;
         wolv::util::Expected<std::vector<u8>, IPSError> toIPS32Patch() const;
 
-        const auto& get() const { return m_patches; }
-        auto& get() { return m_patches; }
+        /**
+         * @brief Writes the patches in the IPS format piece by piece, without building the entire patch in memory first
+         * @param writer Called with consecutive parts of the patch
+         */
+        wolv::util::Expected<void, IPSError> writeIPSPatch(const std::function<void(std::span<const u8>)> &writer) const;
+        wolv::util::Expected<void, IPSError> writeIPS32Patch(const std::function<void(std::span<const u8>)> &writer) const;
+
+        /**
+         * @brief Serializes the patches into a compact binary stream of extents without any address or size limits
+         * @note Used to store patches in project files
+         */
+        std::vector<u8> toExtentStream() const;
+        static wolv::util::Expected<Patches, IPSError> fromExtentStream(std::span<const u8> data);
+
+        const ExtentMap& get() const { return m_patches; }
+        ExtentMap& get() { return m_patches; }
 
     private:
-        std::map<u64, u8> m_patches;
+        ExtentMap m_patches;
     };
 }
\ No newline at end of file
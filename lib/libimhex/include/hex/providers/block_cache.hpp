@@ -0,0 +1,119 @@
+#pragma once
+
+#include <hex.hpp>
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <limits>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace hex::prv {
+
+    /**
+     * @brief Block based read cache that slow providers can use to avoid issuing one request per read
+     * @note Blocks are evicted in least recently used order once the cache is full. When sequential accesses are detected,
+     * additional blocks following the requested range are fetched in the same request. All functions are thread-safe,
+     * the read function is called without holding the cache's lock so misses on different blocks can be fetched concurrently
+     */
+    class BlockCache {
+    public:
+        /**
+         * @brief Function used to fetch data from the underlying data source
+         * @return True if the entire range was read successfully. Failed reads are not cached
+         */
+        using ReadFunction = std::function<bool(u64 address, void *buffer, size_t size)>;
+
+        struct Statistics {
+            u64 hits = 0;
+            u64 misses = 0;
+            u64 readAheadBlocks = 0;
+        };
+
+        explicit BlockCache(size_t blockSize = 0x1000, size_t maxBlocks = 1024);
+
+        /**
+         * @brief Reads data through the cache, fetching missing blocks using the given read function
+         * @note Blocks that cannot be read leave the corresponding part of the buffer untouched
+         */
+        void read(u64 address, void *buffer, size_t size, const ReadFunction &readFunction);
+
+        /**
+         * @brief Updates cached blocks with data that has been written to the underlying data source
+         * @note Only blocks that are already cached are modified, no new blocks are added
+         */
+        void update(u64 address, const void *buffer, size_t size);
+
+        void invalidate();
+        void invalidate(u64 address, size_t size);
+
+        /**
+         * @brief Sets the block size. Changing it clears the cache
+         */
+        void setBlockSize(size_t blockSize);
+        [[nodiscard]] size_t getBlockSize() const;
+
+        void setMaxBlocks(size_t maxBlocks);
+        void setReadAheadBlocks(size_t readAheadBlocks);
+
+        /**
+         * @brief Sets the address past the last valid byte of the data source. Blocks are never fetched beyond it
+         */
+        void setEndAddress(u64 endAddress);
+
+        /**
+         * @brief Sets how long blocks stay valid after being fetched, for data sources that may change on their own
+         * @param maxAge Maximum age of a block. Zero keeps blocks around until they're evicted or invalidated
+         */
+        void setMaxAge(std::chrono::milliseconds maxAge);
+
+        /**
+         * @brief Gets the start addresses of all currently cached blocks, most recently used first
+         */
+        [[nodiscard]] std::vector<u64> getCachedBlocks() const;
+
+        [[nodiscard]] Statistics getStatistics() const;
+        void resetStatistics();
+
+    private:
+        struct Block {
+            u64 index;
+            std::chrono::steady_clock::time_point fetchTime;
+            std::vector<u8> data;
+        };
+
+        const Block* lookup(u64 blockIndex);
+        [[nodiscard]] bool contains(u64 blockIndex) const;
+        static void fetch(u64 firstBlock, u64 endBlock, size_t blockSize, u64 endAddress, const ReadFunction &readFunction, std::vector<Block> &result);
+        void insert(Block &&block);
+        void evict();
+
+    private:
+        mutable std::mutex m_mutex;
+        std::condition_variable m_fetchFinished;
+
+        size_t m_blockSize;
+        size_t m_maxBlocks;
+        size_t m_readAheadBlocks = 16;
+        u64 m_endAddress = std::numeric_limits<u64>::max();
+        std::chrono::milliseconds m_maxAge = std::chrono::milliseconds::zero();
+
+        std::list<Block> m_lruList;
+        std::unordered_map<u64, std::list<Block>::iterator> m_blocks;
+
+        // Blocks currently being read by some thread and a counter that changes whenever cached data becomes outdated,
+        // so data that was read while the cache got updated or invalidated isn't added to it
+        std::unordered_set<u64> m_inFlightBlocks;
+        u64 m_generation = 0;
+
+        u64 m_nextSequentialBlock = 0;
+        u32 m_sequentialReads = 0;
+
+        Statistics m_statistics;
+    };
+
+}
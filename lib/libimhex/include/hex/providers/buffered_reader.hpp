@@ -5,22 +5,128 @@
 
 #include <wolv/io/buffered_reader.hpp>
 
+#include <deque>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <span>
+#include <vector>
+
 namespace hex::prv {
 
     using namespace hex::literals;
 
-    inline void providerReaderFunction(Provider *provider, void *buffer, u64 address, size_t size) {
-        provider->read(address, buffer, size);
+    /**
+     * @brief Reads data from a provider on behalf of a ProviderReader, fetching upcoming windows ahead of time
+     * @note Once the reader walks through the data sequentially, the next windows in the same direction are read
+     * on TaskManager workers while the current one is being consumed. Any non-sequential access drops the prefetched windows
+     */
+    class ProviderPrefetcher {
+    public:
+        constexpr static size_t DefaultDepth = 1;
+
+        explicit ProviderPrefetcher(Provider *provider, size_t depth = DefaultDepth);
+        explicit ProviderPrefetcher(Snapshot snapshot, size_t depth = DefaultDepth);
+        ~ProviderPrefetcher();
+
+        ProviderPrefetcher(const ProviderPrefetcher &) = delete;
+        ProviderPrefetcher& operator=(const ProviderPrefetcher &) = delete;
+
+        void read(u64 address, void *buffer, size_t size);
+
+        /**
+         * @brief Sets how many windows are fetched ahead of the one currently being read. Zero disables prefetching
+         */
+        void setDepth(size_t depth);
+        [[nodiscard]] size_t getDepth() const { return m_depth; }
+
+        [[nodiscard]] Provider* getProvider() const { return m_provider; }
+        [[nodiscard]] const Snapshot& getSnapshot() const { return m_snapshot; }
+
+    private:
+        struct Window;
+
+        static void readData(Provider *provider, const Snapshot &snapshot, u64 address, void *buffer, size_t size);
+
+        std::shared_ptr<Window> takeWindow(u64 address, size_t size);
+        void schedule(u64 address, size_t size);
+        void fillWindows(bool forward, u64 address, size_t size);
+        void cancelWindows();
+        static void cancelWindow(const std::shared_ptr<Window> &window);
+
+        // Lets the provider know while this reader walks through its data sequentially
+        void setSequential(bool sequential);
+
+    private:
+        Provider *m_provider;
+        Snapshot m_snapshot;
+        size_t m_depth;
+
+        std::deque<std::shared_ptr<Window>> m_windows;
+        std::vector<u8> m_spareBuffer;
+
+        std::optional<Region> m_previousRead;
+        bool m_sequential = false;
+    };
+
+    inline void providerReaderFunction(ProviderPrefetcher *prefetcher, void *buffer, u64 address, size_t size) {
+        prefetcher->read(address, buffer, size);
     }
 
-    class ProviderReader : public wolv::io::BufferedReader<prv::Provider, providerReaderFunction> {
+    namespace impl {
+
+        // Owns the prefetcher so it is constructed before the BufferedReader that refers to it
+        struct ProviderPrefetcherHolder {
+            explicit ProviderPrefetcherHolder(Provider *provider) : m_prefetcher(std::make_unique<ProviderPrefetcher>(provider)) { }
+            explicit ProviderPrefetcherHolder(Snapshot snapshot) : m_prefetcher(std::make_unique<ProviderPrefetcher>(std::move(snapshot))) { }
+
+            std::unique_ptr<ProviderPrefetcher> m_prefetcher;
+        };
+
+    }
+
+    class ProviderReader : private impl::ProviderPrefetcherHolder, public wolv::io::BufferedReader<ProviderPrefetcher, providerReaderFunction> {
     public:
-        using BufferedReader::BufferedReader;
+        explicit ProviderReader(Provider *provider, size_t bufferSize = 0x100000) : ProviderPrefetcherHolder(provider), BufferedReader(m_prefetcher.get(), provider->getActualSize(), bufferSize) {
+            this->setEndAddress(provider->getBaseAddress() + provider->getActualSize() - 1);
+            this->seek(provider->getBaseAddress());
+        }
+
+        /**
+         * @brief Creates a reader that reads the data as it was when the snapshot was taken
+         */
+        explicit ProviderReader(const Snapshot &snapshot, size_t bufferSize = 0x100000) : ProviderPrefetcherHolder(snapshot), BufferedReader(m_prefetcher.get(), snapshot.getProvider()->getActualSize(), bufferSize) {
+            const auto provider = snapshot.getProvider();
 
-        explicit ProviderReader(Provider *provider, size_t bufferSize = 0x100000) : BufferedReader(provider, provider->getActualSize(), bufferSize) {
             this->setEndAddress(provider->getBaseAddress() + provider->getActualSize() - 1);
             this->seek(provider->getBaseAddress());
         }
+
+        /**
+         * @brief Sets how many buffer sized windows are read ahead in the background during sequential reads. Zero disables prefetching
+         */
+        void setPrefetchDepth(size_t depth) {
+            m_prefetcher->setDepth(depth);
+        }
     };
 
-}
\ No newline at end of file
+    /**
+     * @brief Walks over a region of a provider in chunks, without copying the data if the provider allows direct access to it
+     * @param callback Called for every chunk with its address and data. Returning false stops the iteration
+     * @note The provider's data may stay locked while the callback runs, see DataSpan. The lock is released between chunks, so writes only
+     * wait for a single callback to finish. The callback must not access the provider itself
+     */
+    inline void forEachChunk(Provider *provider, const Region &region, const std::function<bool(u64, std::span<const u8>)> &callback, size_t chunkSize = 1_MiB) {
+        if (region.getSize() == 0)
+            return;
+
+        std::vector<u8> fallbackBuffer;
+        for (u64 address = region.getStartAddress(); address <= region.getEndAddress(); address += chunkSize) {
+            const auto readSize = std::min<u64>(chunkSize, (region.getEndAddress() - address) + 1);
+
+            if (!callback(address, provider->readSpan(address, readSize, fallbackBuffer)))
+                break;
+        }
+    }
+
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <hex.hpp>
+
+#include <functional>
+#include <memory>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace hex::prv {
+
+    /**
+     * @brief Growable in-memory byte buffer stored as a rope of chunks of at most ChunkSize bytes each
+     * @note The chunks are kept in a treap ordered by their position, so inserting or removing data anywhere costs
+     * O(log n) in the number of chunks instead of moving everything after it. Splitting a chunk doesn't copy it, both
+     * halves keep referencing the same storage until one of them gets written to. Ranges that haven't been written to
+     * since they were inserted don't have any storage at all and read as zeros
+     */
+    class ChunkedBuffer {
+    public:
+        constexpr static size_t ChunkSize = 0x1'0000;
+
+        ChunkedBuffer();
+        ~ChunkedBuffer();
+
+        ChunkedBuffer(const ChunkedBuffer &) = delete;
+        ChunkedBuffer(ChunkedBuffer &&other) noexcept;
+        ChunkedBuffer& operator=(const ChunkedBuffer &) = delete;
+        ChunkedBuffer& operator=(ChunkedBuffer &&other) noexcept;
+
+        [[nodiscard]] u64 getSize() const;
+        [[nodiscard]] bool empty() const { return this->getSize() == 0; }
+
+        /**
+         * @brief Gets the number of pieces the buffer currently consists of
+         */
+        [[nodiscard]] size_t getPieceCount() const;
+
+        /**
+         * @brief Gets the number of bytes of chunk storage referenced by the buffer
+         */
+        [[nodiscard]] u64 getStorageSize() const;
+
+        void read(u64 offset, void *buffer, size_t size) const;
+        void write(u64 offset, const void *buffer, size_t size);
+
+        /**
+         * @brief Inserts zero bytes at the given offset
+         */
+        void insert(u64 offset, u64 size);
+        void remove(u64 offset, u64 size);
+        void resize(u64 newSize);
+        void clear();
+
+        /**
+         * @brief Appends data to the end of the buffer
+         * @note Data of up to ChunkSize bytes is taken over as a chunk without copying it
+         */
+        void append(std::vector<u8> data);
+
+        /**
+         * @brief Gets direct access to the stored bytes of a range
+         * @note Only possible if the whole range lies within a single chunk. The span is only valid until the next modification of the buffer
+         */
+        [[nodiscard]] std::optional<std::span<const u8>> getSpan(u64 offset, size_t size) const;
+
+    private:
+        using Chunk = std::shared_ptr<std::vector<u8>>;
+
+        struct Piece {
+            Chunk chunk;    // nullptr for ranges that only contain zeros
+            u64 offset;
+            u64 size;
+        };
+
+        struct Node;
+        using NodePtr = std::unique_ptr<Node>;
+
+        [[nodiscard]] NodePtr createNode(Piece piece);
+        [[nodiscard]] std::pair<NodePtr, NodePtr> split(NodePtr &&node, u64 position);
+        [[nodiscard]] static NodePtr merge(NodePtr &&left, NodePtr &&right);
+
+        void forEach(u64 offset, u64 size, const std::function<void(u64 pieceStart, Piece &piece)> &callback);
+        void forEach(u64 offset, u64 size, const std::function<void(u64 pieceStart, const Piece &piece)> &callback) const;
+
+    private:
+        NodePtr m_root;
+        u32 m_seed = 0x2545'F491;
+    };
+
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <hex.hpp>
+
+#include <mutex>
+#include <shared_mutex>
+#include <span>
+
+namespace hex::prv {
+
+    /**
+     * @brief Read-only view of a provider's data, as returned by Provider::readSpan() and Snapshot::readSpan()
+     * @note While the view points straight into the provider's backing store, it keeps the provider's data lock held in shared mode
+     * so the data can't be modified or moved around underneath it. Writes to the provider block until the view is destroyed,
+     * so only keep it alive for as long as it takes to process a single chunk.
+     * The lock is not reentrant: while holding a view, the same thread must not read from the provider, take another view of it,
+     * modify it or release snapshots of it. Taking the shared lock a second time on the same thread is undefined behaviour and
+     * deadlocks on some platforms as soon as a writer is waiting
+     */
+    class DataSpan {
+    public:
+        DataSpan() = default;
+        DataSpan(std::span<const u8> data, std::shared_lock<std::shared_mutex> lock = { }) : m_data(data), m_lock(std::move(lock)) { }
+
+        [[nodiscard]] const u8* data() const { return m_data.data(); }
+        [[nodiscard]] size_t size() const { return m_data.size(); }
+        [[nodiscard]] bool empty() const { return m_data.empty(); }
+
+        [[nodiscard]] auto begin() const { return m_data.begin(); }
+        [[nodiscard]] auto end() const { return m_data.end(); }
+
+        [[nodiscard]] std::span<const u8> getSpan() const { return m_data; }
+        operator std::span<const u8>() const { return m_data; }
+
+    private:
+        std::span<const u8> m_data;
+        std::shared_lock<std::shared_mutex> m_lock;
+    };
+
+}
@@ -26,6 +26,7 @@ namespace hex::prv {
 
         void readRaw(u64 offset, void *buffer, size_t size) override;
         void writeRaw(u64 offset, const void *buffer, size_t size) override;
+        [[nodiscard]] std::optional<std::span<const u8>> getRawSpan(u64 offset, size_t size) override;
         [[nodiscard]] u64 getActualSize() const override { return m_data.size(); }
 
         void resizeRaw(u64 newSize) override;
@@ -6,19 +6,29 @@
 
 namespace hex::prv {
 
+    class Provider;
+
     class Overlay {
     public:
         Overlay() = default;
 
-        void setAddress(u64 address) { m_address = address; }
+        void setAddress(u64 address);
         [[nodiscard]] u64 getAddress() const { return m_address; }
 
         [[nodiscard]] u64 getSize() const { return m_data.size(); }
-        [[nodiscard]] std::vector<u8> &getData() { return m_data; }
+
+        void setData(std::vector<u8> data);
+        [[nodiscard]] const std::vector<u8> &getData() const { return m_data; }
 
     private:
+        friend class Provider;
+
+        // Set by the provider owning this overlay so it can keep its overlay index up to date
+        Provider *m_provider = nullptr;
+        u64 m_order = 0;
+
         u64 m_address = 0;
         std::vector<u8> m_data;
     };
 
-}
\ No newline at end of file
+}
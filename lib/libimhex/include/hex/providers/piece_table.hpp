@@ -0,0 +1,106 @@
+#pragma once
+
+#include <hex.hpp>
+
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace hex::prv {
+
+    /**
+     * @brief Extent list describing the logical layout of a provider's data in terms of its original backing store
+     * @note Insertions and removals are recorded as splices over the original data instead of physically moving it around.
+     * Each edit therefore costs O(log n) in the number of pieces, independent of the size of the data.
+     * The logical data only has to be materialized once, e.g. when the provider gets saved.
+     */
+    class PieceTable {
+    public:
+        enum class Source : u8 {
+            Original,   // Data located in the original backing store
+            Buffer,     // Data located in the piece table's own append buffer
+            Zero        // Inserted data that hasn't been written to yet
+        };
+
+        struct Piece {
+            Source source;
+            u64 offset;
+            u64 size;
+        };
+
+        using ReadCallback  = std::function<void(u64 originalOffset, void *buffer, size_t size)>;
+        using WriteCallback = std::function<void(u64 originalOffset, const void *buffer, size_t size)>;
+
+        PieceTable();
+        explicit PieceTable(u64 originalSize);
+        ~PieceTable();
+
+        PieceTable(const PieceTable &) = delete;
+        PieceTable(PieceTable &&other) noexcept;
+        PieceTable& operator=(const PieceTable &) = delete;
+        PieceTable& operator=(PieceTable &&other) noexcept;
+
+        /**
+         * @brief Discards all edits and maps the entire original data again
+         * @param originalSize Size of the original backing store
+         */
+        void reset(u64 originalSize);
+
+        /**
+         * @brief Gets the logical size of the data described by this table
+         */
+        [[nodiscard]] u64 getSize() const;
+
+        /**
+         * @brief Checks if the layout differs from a plain one-to-one mapping of the original data
+         */
+        [[nodiscard]] bool isModified() const;
+
+        [[nodiscard]] size_t getPieceCount() const;
+
+        void insert(u64 offset, u64 size);
+        void remove(u64 offset, u64 size);
+        void resize(u64 newSize);
+
+        /**
+         * @brief Reads logical data
+         * @param readOriginal Callback used to fetch data that is located in the original backing store
+         */
+        void read(u64 offset, void *buffer, size_t size, const ReadCallback &readOriginal) const;
+
+        /**
+         * @brief Writes logical data
+         * @param writeOriginal Callback used to modify data that is located in the original backing store
+         */
+        void write(u64 offset, const void *buffer, size_t size, const WriteCallback &writeOriginal);
+
+        /**
+         * @brief Calls the given callback for every piece overlapping the given logical range, in order
+         * @note The pieces passed to the callback are clipped to the requested range
+         */
+        void forEach(u64 offset, u64 size, const std::function<void(u64 logicalOffset, const Piece &piece)> &callback) const;
+
+        /**
+         * @brief Gets a pointer into the append buffer
+         * @note Only valid until the next modification of the table
+         */
+        [[nodiscard]] const u8* getBufferData(u64 offset) const { return m_buffer.data() + offset; }
+
+    private:
+        struct Node;
+        using NodePtr = std::unique_ptr<Node>;
+
+        [[nodiscard]] NodePtr createNode(const Piece &piece);
+        [[nodiscard]] std::pair<NodePtr, NodePtr> split(NodePtr &&node, u64 position);
+        [[nodiscard]] static NodePtr merge(NodePtr &&left, NodePtr &&right);
+
+    private:
+        NodePtr m_root;
+        u64 m_originalSize = 0;
+        u32 m_seed = 0x2545'F491;
+
+        std::vector<u8> m_buffer;
+    };
+
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <hex.hpp>
+#include <hex/providers/provider.hpp>
+#include <hex/providers/sparse_memory_provider.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <span>
+#include <vector>
+
+namespace hex::prv {
+
+    #if defined(OS_WINDOWS) || defined(OS_LINUX)
+
+        #if defined(OS_WINDOWS)
+            // HANDLE of a process opened with PROCESS_VM_READ access
+            using NativeProcess = void*;
+        #else
+            // ID of the process
+            using NativeProcess = int;
+        #endif
+
+        /**
+         * @brief Reads memory of another process
+         * @param process Process to read from
+         * @param mappedRanges Readable address ranges of the process, sorted by address and not overlapping. Parts of the requests outside
+         * of them aren't read and are filled with zeros instead. If there are no ranges at all, everything that was requested is read
+         * @param requests Memory to read
+         * @param hitHole Set to true if any request covered memory outside of the mapped ranges
+         * @return false if any of the mapped memory couldn't be read. Those parts are filled with zeros as well
+         */
+        bool readProcessMemory(NativeProcess process, std::span<const Region> mappedRanges, std::span<const Provider::ReadRequest> requests, bool *hitHole = nullptr);
+
+    #endif
+
+    /**
+     * @brief Copies large, sparsely populated regions of memory, e.g. of a process, into chunks for a SparseMemoryProvider
+     * @note The regions are split up into pieces of a fixed size that any number of workers take and read in parallel.
+     * Only runs of pages that contain non-zero bytes are kept
+     */
+    class SparseMemoryCapture {
+    public:
+        using ReadFunction = std::function<void(std::span<const Provider::ReadRequest> requests)>;
+
+        /**
+         * @param regions Regions to copy
+         * @param workSize Size of the pieces the regions get split up into
+         * @param pageSize Size of the pages that get checked for non-zero data
+         * @param readFunction Function that reads the data. Called from all workers at the same time
+         */
+        SparseMemoryCapture(const std::vector<Region> &regions, size_t workSize, size_t pageSize, ReadFunction readFunction);
+
+        /**
+         * @brief Takes and reads pieces until none are left or the capture got cancelled
+         * @note Can be called from any number of threads at once. The read function isn't called anymore once cancel() returned
+         * and all calls to work() that were already running finished, see waitForWorkers()
+         * @param progressCallback Called after every finished piece
+         */
+        void work(const std::function<void()> &progressCallback = { });
+
+        /**
+         * @brief Stops all workers once they're done with their current piece
+         */
+        void cancel() { m_cancelled = true; }
+        [[nodiscard]] bool isCancelled() const { return m_cancelled; }
+
+        /**
+         * @brief Waits until no worker is inside of work() anymore
+         * @note Once all pieces were taken or the capture got cancelled, no worker can enter it again, so this waits for all of them to finish
+         * @param tick Called regularly while waiting, e.g. to update progress
+         */
+        void waitForWorkers(const std::function<void()> &tick = { });
+
+        [[nodiscard]] size_t getWorkItemCount() const { return m_workItems.size(); }
+        [[nodiscard]] u64 getTotalSize() const { return m_totalSize; }
+        [[nodiscard]] u64 getBytesProcessed() const { return m_bytesProcessed; }
+
+        /**
+         * @brief Takes the captured chunks out. Only call this once all workers finished
+         */
+        [[nodiscard]] SparseMemoryProvider::Chunks takeChunks() { return std::move(m_chunks); }
+
+    private:
+        void finishWork();
+
+    private:
+        std::vector<Region> m_workItems;
+        size_t m_workSize, m_pageSize;
+        u64 m_totalSize = 0;
+        ReadFunction m_readFunction;
+
+        std::atomic<size_t> m_nextWorkItem = 0;
+        std::atomic<size_t> m_activeWorkers = 0;
+        std::atomic<u64> m_bytesProcessed = 0;
+        std::atomic<bool> m_cancelled = false;
+
+        std::mutex m_mutex;
+        std::condition_variable m_workerFinished;
+        SparseMemoryProvider::Chunks m_chunks;
+    };
+
+}
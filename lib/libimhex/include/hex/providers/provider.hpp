@@ -2,15 +2,25 @@
 
 #include <hex.hpp>
 
+#include <atomic>
+#include <deque>
 #include <list>
 #include <map>
+#include <mutex>
 #include <optional>
+#include <set>
+#include <shared_mutex>
+#include <span>
 #include <string>
 #include <variant>
 #include <vector>
 
+#include <hex/providers/data_span.hpp>
 #include <hex/providers/overlay.hpp>
+#include <hex/providers/snapshot.hpp>
+#include <hex/providers/write_batch.hpp>
 #include <hex/helpers/fs.hpp>
+#include <hex/helpers/interval_index.hpp>
 
 #include <nlohmann/json_fwd.hpp>
 
@@ -33,6 +43,18 @@ namespace hex::prv {
             std::function<void()> callback;
         };
 
+        struct ReadRequest {
+            u64 address;
+            size_t size;
+            void *buffer;
+        };
+
+        struct WriteRequest {
+            u64 address;
+            size_t size;
+            const void *buffer;
+        };
+
         constexpr static u64 MaxPageSize = 0xFFFF'FFFF'FFFF'FFFF;
 
         Provider();
@@ -109,6 +131,15 @@ namespace hex::prv {
          * @param overlays apply overlays and patches is true. Same as readRaw() if false
          */
         void read(u64 offset, void *buffer, size_t size, bool overlays = true);
+
+        /**
+         * @brief Read multiple scattered ranges from this provider at once, applying overlays and patches
+         * @note Adjacent and overlapping requests are merged so each merged range only gets read and patched once.
+         * The merged ranges are then passed to readRawv() in a single batch
+         * @param requests list of ranges to read and the buffers to read them into
+         * @param overlays apply overlays and patches is true
+         */
+        void readv(std::span<const ReadRequest> requests, bool overlays = true);
         
         /**
          * @brief Write data to the patches of this provider. Will not directly modify provider.
@@ -118,6 +149,13 @@ namespace hex::prv {
          */
         void write(u64 offset, const void *buffer, size_t size);
 
+        /**
+         * @brief Write all data collected in a batch to the patches of this provider at once
+         * @note Posts a single EventProviderDataBatchModified event, which results in a single undo operation for the entire batch
+         * @param batch batch of writes to apply
+         */
+        void write(const WriteBatch &batch);
+
         /**
          * @brief Read data from this provider, without applying overlays and patches
          * @param offset offset to start reading the data
@@ -125,6 +163,14 @@ namespace hex::prv {
          * @param size number of bytes to read
          */
         virtual void readRaw(u64 offset, void *buffer, size_t size) = 0;
+
+        /**
+         * @brief Read multiple ranges from this provider, without applying overlays and patches
+         * @note Providers with expensive individual reads, e.g. remote ones, can override this to pipeline the requests.
+         * The default implementation calls readRaw() for every request
+         * @param requests list of ranges to read, relative to the start of the provider's data. Requests are sorted by address and don't overlap
+         */
+        virtual void readRawv(std::span<const ReadRequest> requests);
         /**
          * @brief Write data directly to this provider
          * @param offset offset to start writing the data
@@ -133,6 +179,27 @@ namespace hex::prv {
          */
         virtual void writeRaw(u64 offset, const void *buffer, size_t size) = 0;
 
+        /**
+         * @brief Gets read-only access to data of this provider, applying overlays and patches
+         * @note If the provider can expose the range directly through getRawSpan() and no overlay covers it,
+         * the returned span points straight into the provider's backing store. Otherwise, the data is copied into the fallback buffer
+         * @param offset offset to start reading the data
+         * @param size number of bytes to read
+         * @param fallbackBuffer buffer that will hold a copy of the data if it cannot be accessed directly
+         * @return View of the requested data. Valid for as long as the view and the fallback buffer are alive
+         */
+        [[nodiscard]] DataSpan readSpan(u64 offset, size_t size, std::vector<u8> &fallbackBuffer);
+
+        /**
+         * @brief Gets direct read-only access to the backing store of this provider, without applying overlays and patches
+         * @note Providers that keep their data contiguously in memory should override this to allow consumers to skip copying it.
+         * The default implementation always returns std::nullopt. Called with the data lock held, the span only has to stay valid until it's released
+         * @param offset offset to start reading the data
+         * @param size number of bytes to access
+         * @return Span over the requested data or std::nullopt if the range isn't available in memory
+         */
+        [[nodiscard]] virtual std::optional<std::span<const u8>> getRawSpan(u64 offset, size_t size);
+
         /**
          * @brief Get the full size of the data in this provider
          * @return The size of the entire available data of this provider
@@ -160,6 +227,53 @@ namespace hex::prv {
         void insert(u64 offset, u64 size);
         void remove(u64 offset, u64 size);
 
+        /**
+         * @brief Modifies the data of this provider through writeRaw(), insertRaw(), removeRaw() or resizeRaw()
+         * @note These are the functions undo operations use to actually change data. They advance the data generation and
+         * make sure readers and snapshots never observe a modification that has only been partially applied
+         * @param offset offset relative to the start of the provider's data
+         */
+        void applyWrite(u64 offset, const void *buffer, size_t size);
+        void applyWrites(std::span<const WriteRequest> requests);
+        void applyResize(u64 newSize);
+        void applyInsert(u64 offset, u64 size);
+        void applyRemove(u64 offset, u64 size);
+
+        /**
+         * @brief Gets the current generation of this provider's data
+         * @note The generation is advanced by one for every modification. Results computed from a provider can
+         * store it to later find out if they are still up to date
+         */
+        [[nodiscard]] u64 getGeneration() const { return m_generation; }
+
+        /**
+         * @brief Gets all regions that were modified since the given generation
+         * @note Regions are sorted by address, and overlapping or adjacent ones are merged. This allows analyses to only
+         * recompute the parts of their results that are affected by changes instead of starting over
+         * @param generation Generation to compare against, usually the one the previous results were computed from
+         * @return Modified regions or std::nullopt if data has been inserted or removed since then, or the changes are too old to be known anymore
+         */
+        [[nodiscard]] std::optional<std::vector<Region>> getModifiedRegions(u64 generation) const;
+
+        /**
+         * @brief Takes a snapshot of the current data of this provider
+         * @note Background tasks should read through a snapshot so edits made in the meantime don't show up halfway through their work
+         */
+        [[nodiscard]] Snapshot createSnapshot();
+
+        /**
+         * @brief Tells the provider that its data is about to be read from start to end, e.g. by a search
+         * @note Calls are counted, every call to beginSequentialAccess() needs to be followed by one to endSequentialAccess().
+         * Providers backed by slow storage get notified through setSequentialAccessHint() so they can read further ahead
+         */
+        void beginSequentialAccess();
+        void endSequentialAccess();
+
+        /**
+         * @brief Called when the data of this provider starts or stops being read sequentially
+         */
+        virtual void setSequentialAccessHint(bool sequential) { hex::unused(sequential); }
+
         virtual void resizeRaw(u64 newSize) { hex::unused(newSize); }
         virtual void insertRaw(u64 offset, u64 size) { hex::unused(offset, size); }
         virtual void removeRaw(u64 offset, u64 size) { hex::unused(offset, size); }
@@ -170,6 +284,7 @@ namespace hex::prv {
         [[nodiscard]] Overlay *newOverlay();
         void deleteOverlay(Overlay *overlay);
         void applyOverlays(u64 offset, void *buffer, size_t size) const;
+        [[nodiscard]] bool hasOverlays(u64 offset, size_t size) const;
         [[nodiscard]] const std::list<std::unique_ptr<Overlay>> &getOverlays() const;
 
         [[nodiscard]] u64 getPageSize() const;
@@ -228,13 +343,61 @@ namespace hex::prv {
 
         [[nodiscard]] undo::Stack& getUndoStack() { return m_undoRedoStack; }
 
+    private:
+        friend class Overlay;
+        friend class Snapshot;
+
+        void indexOverlay(Overlay *overlay);
+        void unindexOverlay(Overlay *overlay);
+
+        bool readSnapshot(u64 generation, u64 offset, void *buffer, size_t size, bool overlays);
+        [[nodiscard]] DataSpan readSnapshotSpan(u64 generation, u64 offset, size_t size, std::vector<u8> &fallbackBuffer, bool overlays);
+        void releaseSnapshot(u64 generation);
+
+        // Data that got overwritten by the write that produced the given generation
+        struct Preimage {
+            u64 generation;
+            u64 offset;
+            std::vector<u8> data;
+        };
+
+        mutable std::shared_mutex m_dataMutex;
+        std::atomic<u64> m_generation = 0;
+        std::atomic<u64> m_structureGeneration = 0;
+
+        std::multiset<u64> m_snapshotGenerations;
+        std::deque<Preimage> m_preimages;
+
+        // Regions touched by every write, used to answer getModifiedRegions() queries
+        struct JournalEntry {
+            u64 generation;
+            u64 offset;
+            u64 size;
+        };
+
+        constexpr static size_t MaxJournalEntries = 0x2000;
+        std::deque<JournalEntry> m_journal;
+        u64 m_journalStartGeneration = 0;
+
+        std::mutex m_sequentialAccessMutex;
+        u32 m_sequentialAccessCount = 0;
+
     protected:
+        /**
+         * @brief Gets the mutex that guards this provider's data
+         * @note Readers hold it shared and the apply functions hold it exclusively. Providers that change their backing data in any
+         * other way, e.g. while saving, need to lock it exclusively as well
+         */
+        [[nodiscard]] std::shared_mutex& getDataMutex() const { return m_dataMutex; }
+
         u32 m_currPage    = 0;
         u64 m_baseAddress = 0;
 
         undo::Stack m_undoRedoStack;
 
         std::list<std::unique_ptr<Overlay>> m_overlays;
+        IntervalIndex<Overlay*> m_overlayIndex;
+        u64 m_overlayCounter = 0;
 
         u32 m_id;
 
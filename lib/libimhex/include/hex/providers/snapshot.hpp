@@ -0,0 +1,82 @@
+#pragma once
+
+#include <hex.hpp>
+#include <hex/providers/data_span.hpp>
+
+#include <memory>
+#include <vector>
+
+namespace hex::prv {
+
+    class Provider;
+
+    /**
+     * @brief Immutable view of the data of a provider at the time the snapshot was taken
+     * @note Snapshots are cheap handles that can be copied around freely. While at least one snapshot is alive, the provider
+     * keeps a copy of the bytes overwritten by every later write so reads through the snapshot keep returning the old data.
+     * Inserting, removing or resizing data cannot be undone that way, snapshots taken before such a change become stale instead.
+     * All reads through a stale snapshot fail, so consumers have to check for that and drop or redo their work
+     */
+    class Snapshot {
+    public:
+        Snapshot() = default;
+
+        /**
+         * @brief Reads data as it was when the snapshot was taken
+         * @param address address to start reading the data from, including the provider's base address
+         * @param buffer buffer to write read data
+         * @param size number of bytes to read
+         * @param overlays apply the provider's current overlays if true
+         * @return false if the snapshot is stale or invalid. The buffer is filled with zeros in that case
+         */
+        bool read(u64 address, void *buffer, size_t size, bool overlays = true) const;
+
+        /**
+         * @brief Gets read-only access to data as it was when the snapshot was taken, without copying it if possible
+         * @note The view points straight into the provider's backing store if it allows direct access and no write since the snapshot
+         * was taken touched the range. Otherwise, the data is copied into the fallback buffer
+         * @param address address to start reading the data from, including the provider's base address
+         * @param size number of bytes to read
+         * @param fallbackBuffer buffer that will hold a copy of the data if it cannot be accessed directly
+         * @param overlays apply the provider's current overlays if true
+         * @return View of the requested data. Valid for as long as the view and the fallback buffer are alive. Empty if the snapshot is stale
+         */
+        [[nodiscard]] DataSpan readSpan(u64 address, size_t size, std::vector<u8> &fallbackBuffer, bool overlays = true) const;
+
+        [[nodiscard]] bool isValid() const { return m_state != nullptr; }
+        [[nodiscard]] Provider* getProvider() const;
+
+        /**
+         * @brief Gets the generation of the provider's data this snapshot refers to
+         */
+        [[nodiscard]] u64 getGeneration() const;
+
+        /**
+         * @brief Checks if data has been inserted, removed or resized since the snapshot was taken
+         * @note Addresses no longer line up with the data the snapshot was taken from once it's stale, so all reads through it fail
+         */
+        [[nodiscard]] bool isStale() const;
+
+    private:
+        friend class Provider;
+
+        struct State {
+            State(Provider *provider, u64 generation) : provider(provider), generation(generation) { }
+            ~State();
+
+            State(const State &) = delete;
+            State& operator=(const State &) = delete;
+
+            Provider *provider;
+            u64 generation;
+        };
+
+        explicit Snapshot(std::shared_ptr<const State> state) : m_state(std::move(state)) { }
+
+        static void release(Provider *provider, u64 generation);
+
+    private:
+        std::shared_ptr<const State> m_state;
+    };
+
+}
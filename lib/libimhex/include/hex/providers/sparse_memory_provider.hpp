@@ -0,0 +1,64 @@
+#pragma once
+
+#include <hex/providers/provider.hpp>
+
+#include <map>
+#include <utility>
+#include <vector>
+
+namespace hex::prv {
+
+    /**
+     * @brief Read-only provider holding a sparse copy of a large address space, e.g. the memory of a process
+     * @note All data is kept at its original address. Only chunks that contain non-zero bytes are stored, the rest of the
+     * valid regions reads back as zeros. Addresses between the valid regions are reported as invalid and read back as zeros as well
+     */
+    class SparseMemoryProvider : public hex::prv::Provider {
+    public:
+        using Chunks = std::map<u64, std::vector<u8>>;
+
+        SparseMemoryProvider() = default;
+        ~SparseMemoryProvider() override = default;
+
+        [[nodiscard]] bool isAvailable() const override { return !m_regions.empty(); }
+        [[nodiscard]] bool isReadable() const override { return true; }
+        [[nodiscard]] bool isWritable() const override { return false; }
+        [[nodiscard]] bool isResizable() const override { return false; }
+        [[nodiscard]] bool isSavable() const override { return false; }
+        [[nodiscard]] bool isSavableAsRecent() const override { return false; }
+
+        [[nodiscard]] bool open() override;
+        void close() override { }
+
+        void readRaw(u64 offset, void *buffer, size_t size) override;
+        void writeRaw(u64 offset, const void *buffer, size_t size) override;
+        [[nodiscard]] std::optional<std::span<const u8>> getRawSpan(u64 offset, size_t size) override;
+        [[nodiscard]] u64 getActualSize() const override;
+
+        [[nodiscard]] std::string getName() const override { return ""; }
+        [[nodiscard]] std::string getTypeName() const override { return "SparseMemoryProvider"; }
+
+        [[nodiscard]] std::pair<Region, bool> getRegionValidity(u64 address) const override;
+
+        /**
+         * @brief Sets the stored data
+         * @param regions Valid address ranges, sorted by address and not overlapping
+         * @param chunks Data of all stored chunks keyed by their address. Chunks must not overlap
+         */
+        void setData(std::vector<Region> regions, Chunks chunks);
+
+        /**
+         * @brief Splits data into runs of pages that contain non-zero bytes, leaving out all pages that are entirely zero
+         * @param address Address of the first byte of the data
+         * @param data Data to split up
+         * @param pageSize Size of the pages the data is checked in
+         * @return Address and data of every run
+         */
+        [[nodiscard]] static std::vector<std::pair<u64, std::vector<u8>>> getNonZeroRuns(u64 address, std::span<const u8> data, size_t pageSize);
+
+    protected:
+        std::vector<Region> m_regions;
+        Chunks m_chunks;
+    };
+
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <hex.hpp>
+
+#include <functional>
+#include <memory>
+#include <span>
+#include <vector>
+
+namespace hex::prv::undo {
+
+    namespace impl {
+        class SpillFile;
+    }
+
+    /**
+     * @brief Data overwritten by an operation together with the data it was replaced with
+     * @note While the operation isn't needed, the data can be compressed and later moved to a temporary file on disk
+     * to keep long undo histories from using up all memory. The data is decoded again transparently when it's requested
+     */
+    class ModificationData {
+    public:
+        ModificationData() = default;
+        ModificationData(std::vector<u8> oldData, std::vector<u8> newData);
+
+        /**
+         * @brief Only keeps the data from before the modification, for operations that can generate the new data themselves
+         */
+        explicit ModificationData(std::vector<u8> oldData);
+
+        /**
+         * @brief Gets the data from before the modification
+         */
+        [[nodiscard]] std::vector<u8> getOldData() const;
+
+        /**
+         * @brief Gets the data from after the modification
+         * @return The new data, or an empty buffer if only the old data is being kept
+         */
+        [[nodiscard]] std::vector<u8> getNewData() const;
+
+        /**
+         * @brief Gets the number of bytes that were modified
+         */
+        [[nodiscard]] size_t getSize() const { return m_size; }
+
+        /**
+         * @brief Gets the number of bytes currently kept in memory
+         */
+        [[nodiscard]] size_t getMemoryUsage() const;
+
+        /**
+         * @brief Replaces the old data with its difference to the new data and run-length encodes both
+         * @note Most modifications only change a few bytes or write repeating values, which makes this very effective
+         */
+        void compress();
+
+        /**
+         * @brief Compresses the data and moves it to a temporary file
+         * @return False if the data couldn't be written to disk, in which case it stays compressed in memory
+         */
+        bool spill();
+
+        [[nodiscard]] bool isCompressed() const { return m_state != State::Plain; }
+        [[nodiscard]] bool isSpilled() const { return m_state == State::Spilled; }
+
+    private:
+        enum class State : u8 {
+            Plain,
+            Compressed,
+            Spilled
+        };
+
+        void visitEncoded(const std::function<void(std::span<const u8> encodedData, std::span<const u8> encodedDelta)> &callback) const;
+
+    private:
+        State m_state = State::Plain;
+        size_t m_size = 0;
+        bool m_hasNewData = true;
+
+        // Plain: old and new data
+        // Compressed: encoded new data and encoded XOR difference between old and new data
+        // Spilled: both empty, the encoded data lives in the spill file
+        std::vector<u8> m_first, m_second;
+
+        std::shared_ptr<impl::SpillFile> m_spillFile;
+        u64 m_spillOffset = 0;
+        size_t m_firstSize = 0, m_secondSize = 0;
+    };
+
+}
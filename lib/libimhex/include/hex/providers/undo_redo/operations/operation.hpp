@@ -20,12 +20,43 @@ namespace hex::prv::undo {
 
         [[nodiscard]] virtual Region getRegion() const = 0;
 
+        /**
+         * @brief Gets the individual regions touched by this operation
+         * @note Operations that modify multiple disjoint ranges should override this so only the modified bytes get highlighted
+         * instead of everything covered by getRegion()
+         */
+        [[nodiscard]] virtual std::vector<Region> getRegions() const {
+            return { this->getRegion() };
+        }
+
         [[nodiscard]] virtual std::string format() const = 0;
         [[nodiscard]] virtual std::vector<std::string> formatContent() const {
             return { };
         }
 
         [[nodiscard]] virtual bool shouldHighlight() const { return true; }
+
+        /**
+         * @brief Checks if undoing or redoing this operation changes the provider's data. Operations that only affect
+         * other state, like bookmarks, return false and are skipped when a stack's modifications get replayed elsewhere
+         */
+        [[nodiscard]] virtual bool modifiesData() const { return true; }
+
+        /**
+         * @brief Gets the number of bytes of data this operation currently keeps in memory
+         */
+        [[nodiscard]] virtual size_t getMemoryUsage() const { return 0; }
+
+        /**
+         * @brief Stores the data of this operation in a more compact form. Called by the undo stack once the operation is
+         * no longer one of the most recent ones and the stack uses more memory than allowed
+         */
+        virtual void compress() { }
+
+        /**
+         * @brief Moves the data of this operation out of memory. Called by the undo stack if compressing operations wasn't enough
+         */
+        virtual void spill() { }
     };
 
 }
\ No newline at end of file
@@ -6,6 +6,8 @@
 #include <hex/helpers/fmt.hpp>
 #include <hex/helpers/utils.hpp>
 
+#include <algorithm>
+
 namespace hex::prv::undo {
 
     class OperationGroup : public Operation {
@@ -50,10 +52,45 @@ namespace hex::prv::undo {
             return Region { m_startAddress, (m_endAddress - m_startAddress) + 1 };
         }
 
+        [[nodiscard]] std::vector<Region> getRegions() const override {
+            std::vector<Region> result;
+            for (const auto &operation : m_operations) {
+                if (!operation->shouldHighlight())
+                    continue;
+
+                auto regions = operation->getRegions();
+                result.insert(result.end(), regions.begin(), regions.end());
+            }
+
+            return result;
+        }
+
+        [[nodiscard]] bool modifiesData() const override {
+            return std::ranges::any_of(m_operations, [](const auto &operation) { return operation->modifiesData(); });
+        }
+
         std::unique_ptr<Operation> clone() const override {
             return std::make_unique<OperationGroup>(*this);
         }
 
+        [[nodiscard]] size_t getMemoryUsage() const override {
+            size_t result = 0;
+            for (const auto &operation : m_operations)
+                result += operation->getMemoryUsage();
+
+            return result;
+        }
+
+        void compress() override {
+            for (auto &operation : m_operations)
+                operation->compress();
+        }
+
+        void spill() override {
+            for (auto &operation : m_operations)
+                operation->spill();
+        }
+
         std::vector<std::string> formatContent() const override {
             return m_formattedContent;
         }
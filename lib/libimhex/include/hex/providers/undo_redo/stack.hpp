@@ -4,10 +4,14 @@
 #include <hex/api/localization_manager.hpp>
 
 #include <hex/providers/undo_redo/operations/operation.hpp>
+#include <hex/helpers/interval_index.hpp>
 
+#include <atomic>
 #include <map>
 #include <memory>
 #include <mutex>
+#include <optional>
+#include <shared_mutex>
 #include <vector>
 
 namespace hex::prv {
@@ -16,16 +20,23 @@ namespace hex::prv {
 
 namespace hex::prv::undo {
 
-    using Patches = std::map<u64, u8>;
-
     class Stack {
     public:
+        constexpr static size_t DefaultMemoryLimit = 256 * 1024 * 1024;
+
+        // Number of most recent operations that are never compressed, so quickly undoing or redoing them stays cheap
+        constexpr static size_t HotOperationCount = 16;
+
         explicit Stack(Provider *provider);
 
         void undo(u32 count = 1);
         void redo(u32 count = 1);
 
         void groupOperations(u32 count, const UnlocalizedString &unlocalizedName);
+
+        /**
+         * @brief Adds copies of all applied operations of another stack that modify data to this stack
+         */
         void apply(const Stack &otherStack);
 
         [[nodiscard]] bool canUndo() const;
@@ -38,27 +49,103 @@ namespace hex::prv::undo {
 
         bool add(std::unique_ptr<Operation> &&operation);
 
+        /**
+         * @brief Gets the operations that are currently applied
+         * @note If the stack might be modified by another thread, hold the lock returned by tryLockShared() while accessing the operations
+         */
         const std::vector<std::unique_ptr<Operation>> &getAppliedOperations() const {
             return m_undoStack;
         }
 
+        /**
+         * @brief Gets the operations that have been undone and can be redone
+         * @note If the stack might be modified by another thread, hold the lock returned by tryLockShared() while accessing the operations
+         */
         const std::vector<std::unique_ptr<Operation>> &getUndoneOperations() const {
             return m_redoStack;
         }
 
-        void reset() {
-            m_undoStack.clear();
-            m_redoStack.clear();
+        /**
+         * @brief Tries to lock the stack for reading without waiting for operations that are currently being executed
+         * @return Lock that owns the stack's mutex if locking was successful
+         */
+        [[nodiscard]] std::shared_lock<std::shared_mutex> tryLockShared() const {
+            return std::shared_lock(m_mutex, std::try_to_lock);
         }
 
+        /**
+         * @brief Gets all regions of applied operations that should be highlighted and overlap the given region
+         * @param region Region to query, relative to the start of the provider's data
+         * @return Overlapping regions ordered by start address. They are not clipped to the queried region.
+         * std::nullopt if the stack is currently being modified by another thread
+         */
+        [[nodiscard]] std::optional<std::vector<Region>> getHighlightedRegions(const Region &region) const;
+
+        /**
+         * @brief Gets a counter that changes every time operations get added, undone, redone or grouped
+         */
+        [[nodiscard]] u64 getRevision() const {
+            return m_revision;
+        }
+
+        /**
+         * @brief Gets the number of bytes of operation data each undo stack is allowed to keep in memory
+         * @note Above this limit, the data of older operations gets compressed and then moved to a temporary file
+         */
+        [[nodiscard]] static size_t getMemoryLimit();
+        static void setMemoryLimit(size_t limit);
+
+        /**
+         * @brief Gets the number of bytes of operation data this stack currently keeps in memory
+         */
+        [[nodiscard]] size_t getMemoryUsage() const {
+            return m_memoryUsage;
+        }
+
+        /**
+         * @brief Remembers the operations that are currently applied, so it can later be checked if any of them got undone or grouped
+         * @note Must be called while holding the lock returned by tryLockShared()
+         */
+        void setMark();
+
+        /**
+         * @brief Gets the number of operations at the start of the undo stack that have stayed applied and unchanged since setMark() was last called
+         * @note Operations after these were either added or modified since then
+         */
+        [[nodiscard]] size_t getUnchangedCount() const;
+
+        void reset();
+
     private:
         [[nodiscard]] Operation* getLastOperation() const {
             return m_undoStack.back().get();
         }
 
+        void indexLastOperation();
+        void unindexLastOperation();
+
+        bool addOperation(std::unique_ptr<Operation> &&operation);
+        void clearRedoStack();
+        void enforceMemoryLimit();
+
     private:
+        // Locked exclusively while operations are being added, executed or rearranged
+        mutable std::shared_mutex m_mutex;
+
         std::vector<std::unique_ptr<Operation>> m_undoStack, m_redoStack;
         Provider *m_provider;
+
+        // Highlighted regions of all applied operations, along with the keys each entry of the undo stack inserted them under
+        IntervalIndex<Operation*> m_highlightIndex;
+        std::vector<std::vector<std::pair<u64, u64>>> m_indexedRegions;
+        u64 m_nextRegionId = 0;
+        std::atomic<u64> m_revision = 0;
+
+        // The oldest m_compressedCount operations of the undo stack have been compressed, the oldest m_spilledCount spilled to disk
+        std::atomic<size_t> m_memoryUsage = 0;
+        size_t m_compressedCount = 0, m_spilledCount = 0;
+
+        std::atomic<size_t> m_unchangedCount = 0;
     };
 
 }
\ No newline at end of file
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <hex.hpp>
+#include <hex/api/localization_manager.hpp>
+#include <hex/helpers/extent_map.hpp>
+
+#include <functional>
+#include <span>
+#include <vector>
+
+namespace hex::prv {
+
+    /**
+     * @brief Collects many writes to a provider so they can be applied at once
+     * @note Writes to overlapping or adjacent addresses are merged into a single run, later writes overwrite earlier ones.
+     * Passing the batch to Provider::write() posts a single modification event and creates a single undo operation for all of them
+     */
+    class WriteBatch {
+    public:
+        explicit WriteBatch(UnlocalizedString unlocalizedName) : m_unlocalizedName(std::move(unlocalizedName)) { }
+
+        /**
+         * @brief Adds data to the batch
+         * @param address address to write the data to, including the provider's base address
+         * @param buffer buffer to take data to write from
+         * @param size number of bytes to write
+         */
+        void write(u64 address, const void *buffer, size_t size) { m_runs.write(address, buffer, size); }
+
+        void clear() { m_runs.clear(); }
+
+        [[nodiscard]] bool empty() const { return m_runs.empty(); }
+        [[nodiscard]] size_t getRunCount() const { return m_runs.getExtentCount(); }
+
+        /**
+         * @brief Gets the total number of bytes written by this batch
+         */
+        [[nodiscard]] u64 getSize() const { return m_runs.getSize(); }
+
+        /**
+         * @brief Gets the regions written by this batch, sorted by address
+         */
+        [[nodiscard]] std::vector<Region> getRegions() const { return m_runs.getRegions(); }
+
+        /**
+         * @brief Calls the callback for every run of consecutive bytes in the batch, ordered by address
+         */
+        void forEachRun(const std::function<void(u64 address, std::span<const u8> data)> &callback) const { m_runs.forEachExtent(callback); }
+
+        [[nodiscard]] const UnlocalizedString& getUnlocalizedName() const { return m_unlocalizedName; }
+
+    private:
+        UnlocalizedString m_unlocalizedName;
+        ExtentMap m_runs;
+    };
+
+}
@@ -5,6 +5,7 @@
 #include <hex/helpers/logger.hpp>
 
 #include <hex/ui/view.hpp>
+#include <hex/providers/provider.hpp>
 #include <hex/data_processor/node.hpp>
 
 #include <filesystem>
@@ -984,6 +985,28 @@ namespace hex {
 
     namespace ContentRegistry::Hashes {
 
+        const std::vector<u8>& Hash::Function::get(const Region& region, prv::Provider *provider) {
+            // Only throw away the cached hash if the hashed region was actually modified
+            if (!m_cache.empty() && provider != nullptr && provider->getGeneration() != m_cacheGeneration) {
+                const auto modifiedRegions = provider->getModifiedRegions(m_cacheGeneration);
+                const bool affected = !modifiedRegions.has_value() || std::any_of(modifiedRegions->begin(), modifiedRegions->end(), [&](const Region &modifiedRegion) {
+                    return modifiedRegion.overlaps(region);
+                });
+
+                if (affected)
+                    m_cache.clear();
+                else
+                    m_cacheGeneration = provider->getGeneration();
+            }
+
+            if (m_cache.empty()) {
+                m_cacheGeneration = provider != nullptr ? provider->getGeneration() : 0;
+                m_cache = m_callback(region, provider);
+            }
+
+            return m_cache;
+        }
+
         namespace impl {
 
             std::vector<std::unique_ptr<Hash>> &getHashes() {
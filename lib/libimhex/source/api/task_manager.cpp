@@ -4,6 +4,8 @@
 #include <hex/helpers/logger.hpp>
 
 #include <algorithm>
+#include <atomic>
+#include <exception>
 
 #include <jthread.hpp>
 
@@ -329,6 +331,86 @@ namespace hex {
         return createTask(std::move(name), 0, true, std::move(function));
     }
 
+    void TaskManager::parallelFor(Task &task, u64 count, const std::function<void(u64 index)> &function) {
+        struct State {
+            std::function<void(u64)> function;
+            u64 count = 0;
+
+            std::atomic<u64> nextIndex = 0;
+            std::atomic<u64> finished = 0;
+            std::atomic<size_t> activeWorkers = 0;
+            std::atomic<bool> cancelled = false;
+
+            std::mutex mutex;
+            std::condition_variable workerFinished;
+            std::exception_ptr exception;
+        };
+
+        auto state = std::make_shared<State>();
+        state->function = function;
+        state->count    = count;
+
+        // Workers register themselves as active before checking for cancellation and taking an index. Once all indices
+        // are taken or the work got cancelled, waiting for the active worker count to drop to zero therefore guarantees
+        // that no worker is still running the function or will ever run it again
+        const auto processIndices = [](State &state, const std::function<void()> &progressCallback) {
+            bool done = false;
+            while (!done && !state.cancelled) {
+                state.activeWorkers += 1;
+
+                if (!state.cancelled) {
+                    const auto index = state.nextIndex.fetch_add(1);
+                    if (index < state.count) {
+                        try {
+                            state.function(index);
+                            state.finished += 1;
+
+                            if (progressCallback)
+                                progressCallback();
+                        } catch (...) {
+                            std::scoped_lock lock(state.mutex);
+                            if (state.exception == nullptr)
+                                state.exception = std::current_exception();
+                            state.cancelled = true;
+                        }
+                    } else {
+                        done = true;
+                    }
+                }
+
+                state.activeWorkers -= 1;
+                state.workerFinished.notify_all();
+            }
+        };
+
+        // The calling task already occupies one of the workers
+        const auto workerCount = std::min<u64>(std::max<size_t>(s_workers.size(), 1), count);
+        for (u64 i = 1; i < workerCount; i += 1) {
+            createBackgroundTask(task.getUnlocalizedName().get(), [state, processIndices](Task &) {
+                processIndices(*state, nullptr);
+            });
+        }
+
+        processIndices(*state, [&task, &state] {
+            task.update(state->finished);
+        });
+
+        {
+            std::unique_lock lock(state->mutex);
+            while (state->activeWorkers > 0) {
+                state->workerFinished.wait_for(lock, std::chrono::milliseconds(100));
+
+                if (task.shouldInterrupt())
+                    state->cancelled = true;
+            }
+
+            if (state->exception != nullptr)
+                std::rethrow_exception(state->exception);
+        }
+
+        task.update(state->finished);
+    }
+
     void TaskManager::collectGarbage() {
         {
             std::scoped_lock lock(s_queueMutex);
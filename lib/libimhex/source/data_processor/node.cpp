@@ -145,7 +145,7 @@ namespace hex::dp {
             throwNodeError("Tried setting overlay data on a node that's not the end of a chain!");
 
         m_overlay->setAddress(address);
-        m_overlay->getData() = data;
+        m_overlay->setData(data);
     }
 
     void Node::setIdCounter(int id) {
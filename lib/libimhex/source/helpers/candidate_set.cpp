@@ -0,0 +1,86 @@
+#include <hex/helpers/candidate_set.hpp>
+
+#include <algorithm>
+#include <bit>
+
+namespace hex {
+
+    CandidateSet::Block::Block(u64 address, size_t valueSize, std::span<const u16> offsets, std::span<const u8> values)
+        : m_address(address), m_valueSize(valueSize), m_count(offsets.size()), m_values(values.begin(), values.end()) {
+
+        // A bitmap needs one bit per address in the block, an offset list two bytes per candidate. Pick whichever is smaller
+        constexpr static size_t BitmapSize = BlockSize / 64;
+        if (offsets.size() * sizeof(u16) > BitmapSize * sizeof(u64)) {
+            m_bitmap.resize(BitmapSize);
+            for (const auto offset : offsets)
+                m_bitmap[offset / 64] |= u64(1) << (offset % 64);
+        } else {
+            m_offsets.assign(offsets.begin(), offsets.end());
+        }
+    }
+
+    bool CandidateSet::Block::contains(u64 address) const {
+        if (address < m_address || address - m_address >= BlockSize)
+            return false;
+
+        const auto offset = u16(address - m_address);
+        if (this->isDense())
+            return (m_bitmap[offset / 64] >> (offset % 64)) & 1;
+        else
+            return std::ranges::binary_search(m_offsets, offset);
+    }
+
+    std::vector<u16> CandidateSet::Block::getOffsets() const {
+        if (!this->isDense())
+            return m_offsets;
+
+        std::vector<u16> result;
+        result.reserve(m_count);
+        for (size_t word = 0; word < m_bitmap.size(); word += 1) {
+            for (u64 bits = m_bitmap[word]; bits != 0; bits &= bits - 1)
+                result.push_back(u16(word * 64 + std::countr_zero(bits)));
+        }
+
+        return result;
+    }
+
+    size_t CandidateSet::Block::getMemoryUsage() const {
+        return m_bitmap.size() * sizeof(u64) + m_offsets.size() * sizeof(u16) + m_values.size();
+    }
+
+    void CandidateSet::addBlock(Block block) {
+        if (block.getCount() == 0)
+            return;
+
+        m_count += block.getCount();
+        m_blocks.push_back(std::move(block));
+    }
+
+    size_t CandidateSet::getMemoryUsage() const {
+        size_t result = 0;
+        for (const auto &block : m_blocks)
+            result += block.getMemoryUsage();
+
+        return result;
+    }
+
+    bool CandidateSet::contains(u64 address) const {
+        auto it = std::ranges::upper_bound(m_blocks, address, { }, &Block::getAddress);
+        if (it == m_blocks.begin())
+            return false;
+
+        return std::prev(it)->contains(address);
+    }
+
+    void CandidateSet::forEach(const std::function<void(u64 address, std::span<const u8> value)> &callback) const {
+        for (const auto &block : m_blocks) {
+            const auto offsets = block.getOffsets();
+            const auto values  = block.getValues();
+            const auto valueSize = block.getValueSize();
+
+            for (size_t i = 0; i < offsets.size(); i += 1)
+                callback(block.getAddress() + offsets[i], values.subspan(i * valueSize, valueSize));
+        }
+    }
+
+}
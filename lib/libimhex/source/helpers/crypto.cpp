@@ -18,6 +18,7 @@
 #include <cstddef>
 #include <cstdint>
 #include <bit>
+#include <vector>
 
 #if MBEDTLS_VERSION_MAJOR <= 2
 
@@ -42,13 +43,15 @@
 namespace hex::crypt {
     using namespace std::placeholders;
 
-    template<std::invocable<unsigned char *, size_t> Func>
+    template<std::invocable<const unsigned char *, size_t> Func>
     void processDataByChunks(prv::Provider *data, u64 offset, size_t size, Func func) {
-        std::array<u8, 512> buffer = { 0 };
-        for (size_t bufferOffset = 0; bufferOffset < size; bufferOffset += buffer.size()) {
-            const auto readSize = std::min(buffer.size(), size - bufferOffset);
-            data->read(offset + bufferOffset, buffer.data(), readSize);
-            func(buffer.data(), readSize);
+        constexpr static size_t ChunkSize = 0x10'0000;
+
+        std::vector<u8> buffer;
+        for (size_t bufferOffset = 0; bufferOffset < size; bufferOffset += ChunkSize) {
+            const auto readSize = std::min(ChunkSize, size - bufferOffset);
+            const auto chunk = data->readSpan(offset + bufferOffset, readSize, buffer);
+            func(chunk.data(), chunk.size());
         }
     }
 
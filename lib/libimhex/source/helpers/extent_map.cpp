@@ -0,0 +1,168 @@
+#include <hex/helpers/extent_map.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+
+namespace hex {
+
+    void ExtentMap::write(u64 address, const void *buffer, size_t size) {
+        if (size == 0 || buffer == nullptr)
+            return;
+
+        const auto bytes = static_cast<const u8*>(buffer);
+        const auto endAddress = address + size;
+
+        // Find the first extent that overlaps or directly precedes the new data
+        auto first = m_extents.upper_bound(address);
+        if (first != m_extents.begin()) {
+            auto previous = std::prev(first);
+            if (previous->first + previous->second.size() >= address)
+                first = previous;
+        }
+
+        auto last = first;
+        while (last != m_extents.end() && last->first <= endAddress)
+            ++last;
+
+        // Common case of extending or overwriting a single extent that starts before the new data, can be done in place
+        if (first != m_extents.end() && std::next(first) == last && first->first <= address) {
+            auto &data = first->second;
+            data.resize(std::max<u64>(data.size(), endAddress - first->first));
+            std::memcpy(data.data() + (address - first->first), bytes, size);
+
+            return;
+        }
+
+        // Otherwise merge all touched extents and the new data into a new extent
+        u64 extentStart = address, extentEnd = endAddress;
+        if (first != last) {
+            extentStart = std::min(extentStart, first->first);
+            extentEnd   = std::max(extentEnd, std::prev(last)->first + std::prev(last)->second.size());
+        }
+
+        std::vector<u8> data(extentEnd - extentStart);
+        for (auto it = first; it != last; ++it)
+            std::memcpy(data.data() + (it->first - extentStart), it->second.data(), it->second.size());
+        std::memcpy(data.data() + (address - extentStart), bytes, size);
+
+        m_extents.erase(first, last);
+        m_extents.emplace(extentStart, std::move(data));
+    }
+
+    void ExtentMap::erase(u64 address, u64 size) {
+        if (size == 0)
+            return;
+
+        const auto endAddress = address + size;
+
+        auto it = m_extents.upper_bound(address);
+        if (it != m_extents.begin())
+            it = std::prev(it);
+
+        while (it != m_extents.end() && it->first < endAddress) {
+            const auto extentStart = it->first;
+            const auto extentEnd   = extentStart + it->second.size();
+
+            if (extentEnd <= address) {
+                ++it;
+                continue;
+            }
+
+            auto data = std::move(it->second);
+            it = m_extents.erase(it);
+
+            // Keep the parts of the extent that lie outside of the erased range
+            if (extentStart < address)
+                m_extents.emplace(extentStart, std::vector<u8>(data.begin(), data.begin() + (address - extentStart)));
+            if (extentEnd > endAddress)
+                it = m_extents.emplace(endAddress, std::vector<u8>(data.begin() + (endAddress - extentStart), data.end())).first;
+        }
+    }
+
+    void ExtentMap::insertGap(u64 address, u64 size) {
+        if (size == 0)
+            return;
+
+        // Split the extent containing the address so its second half can be moved
+        if (this->contains(address)) {
+            auto it = std::prev(m_extents.upper_bound(address));
+            if (it->first < address) {
+                auto &data = it->second;
+                m_extents.emplace(address, std::vector<u8>(data.begin() + (address - it->first), data.end()));
+                data.resize(address - it->first);
+            }
+        }
+
+        // Move extents starting at the highest address first so no keys collide
+        auto begin = m_extents.lower_bound(address);
+        std::vector<std::pair<u64, std::vector<u8>>> moved;
+        for (auto it = begin; it != m_extents.end(); ++it)
+            moved.emplace_back(it->first + size, std::move(it->second));
+
+        m_extents.erase(begin, m_extents.end());
+        for (auto &[extentAddress, data] : moved)
+            m_extents.emplace_hint(m_extents.end(), extentAddress, std::move(data));
+    }
+
+    void ExtentMap::removeRange(u64 address, u64 size) {
+        if (size == 0)
+            return;
+
+        this->erase(address, size);
+
+        auto begin = m_extents.lower_bound(address + size);
+        std::vector<std::pair<u64, std::vector<u8>>> moved;
+        for (auto it = begin; it != m_extents.end(); ++it)
+            moved.emplace_back(it->first - size, std::move(it->second));
+
+        m_extents.erase(begin, m_extents.end());
+
+        // The first moved extent may now directly follow an extent before the removed range
+        for (auto &[extentAddress, data] : moved)
+            this->write(extentAddress, data.data(), data.size());
+    }
+
+    bool ExtentMap::contains(u64 address) const {
+        auto it = m_extents.upper_bound(address);
+        if (it == m_extents.begin())
+            return false;
+
+        it = std::prev(it);
+
+        return address < it->first + it->second.size();
+    }
+
+    u64 ExtentMap::getSize() const {
+        u64 size = 0;
+        for (const auto &[address, data] : m_extents)
+            size += data.size();
+
+        return size;
+    }
+
+    u64 ExtentMap::getEndAddress() const {
+        if (m_extents.empty())
+            return 0;
+
+        const auto &[address, data] = *m_extents.rbegin();
+
+        return address + data.size();
+    }
+
+    std::vector<Region> ExtentMap::getRegions() const {
+        std::vector<Region> regions;
+        regions.reserve(m_extents.size());
+
+        for (const auto &[address, data] : m_extents)
+            regions.push_back({ address, data.size() });
+
+        return regions;
+    }
+
+    void ExtentMap::forEachExtent(const std::function<void(u64, std::span<const u8>)> &callback) const {
+        for (const auto &[address, data] : m_extents)
+            callback(address, data);
+    }
+
+}
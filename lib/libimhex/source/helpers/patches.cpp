@@ -32,15 +32,11 @@ namespace hex {
             }
 
             void writeRaw(u64 offset, const void *buffer, size_t size) override {
-                for (u64 i = 0; i < size; i += 1)
-                    m_patches[offset] = static_cast<const u8*>(buffer)[i];
+                m_patches.write(offset, buffer, size);
             }
 
             [[nodiscard]] u64 getActualSize() const override {
-                if (m_patches.empty())
-                    return 0;
-                else
-                    return m_patches.rbegin()->first;
+                return m_patches.getEndAddress();
             }
 
             void resizeRaw(u64 newSize) override {
@@ -48,31 +44,11 @@ namespace hex {
             }
 
             void insertRaw(u64 offset, u64 size) override {
-                std::vector<std::pair<u64, u8>> patchesToMove;
-
-                for (auto &[address, value] : m_patches) {
-                    if (address > offset)
-                        patchesToMove.emplace_back(address, value);
-                }
-
-                for (const auto &[address, value] : patchesToMove)
-                    m_patches.erase(address);
-                for (const auto &[address, value] : patchesToMove)
-                    m_patches.insert({ address + size, value });
+                m_patches.insertGap(offset, size);
             }
 
             void removeRaw(u64 offset, u64 size) override {
-                std::vector<std::pair<u64, u8>> patchesToMove;
-
-                for (auto &[address, value] : m_patches) {
-                    if (address > offset)
-                        patchesToMove.emplace_back(address, value);
-                }
-
-                for (const auto &[address, value] : patchesToMove)
-                    m_patches.erase(address);
-                for (const auto &[address, value] : patchesToMove)
-                    m_patches.insert({ address - size, value });
+                m_patches.removeRange(offset, size);
             }
 
             [[nodiscard]] std::string getName() const override {
@@ -81,247 +57,240 @@ namespace hex {
 
             [[nodiscard]] std::string getTypeName() const override { return ""; }
 
-            const std::map<u64, u8>& getPatches() const {
-                return m_patches;
+            ExtentMap&& takePatches() {
+                return std::move(m_patches);
             }
         private:
-            std::map<u64, u8> m_patches;
+            ExtentMap m_patches;
         };
 
 
-        void pushStringBack(std::vector<u8> &buffer, const std::string &string) {
-            std::copy(string.begin(), string.end(), std::back_inserter(buffer));
-        }
-
-        template<typename T>
-        void pushBytesBack(std::vector<u8> &buffer, T bytes) {
-            buffer.resize(buffer.size() + sizeof(T));
-            std::memcpy((&buffer.back() - sizeof(T)) + 1, &bytes, sizeof(T));
-        }
+        struct IPSFormat {
+            std::string_view header, footer;
+            u8 addressSize;
+            u64 maxAddress;
+        };
 
-    }
+        constexpr IPSFormat IPS   = { "PATCH", "EOF",  3, 0x00FF'FFFF };
+        constexpr IPSFormat IPS32 = { "IPS32", "EEOF", 4, 0xFFFF'FFFF };
 
+        constexpr u16 MaxRecordSize = 0xFFFF;
 
+        // Address that, when written in big endian, is identical to the footer and would be interpreted as the end of the patch
+        constexpr u64 getFooterAddress(const IPSFormat &format) {
+            u64 address = 0;
+            for (u8 i = 0; i < format.addressSize; i += 1)
+                address = (address << 8) | u8(format.footer[format.footer.size() - format.addressSize + i]);
 
-    wolv::util::Expected<std::vector<u8>, IPSError> Patches::toIPSPatch() const {
-        std::vector<u8> result;
+            return address;
+        }
 
-        pushStringBack(result, "PATCH");
+        wolv::util::Expected<void, IPSError> writePatch(const IPSFormat &format, const ExtentMap &patches, const std::function<void(std::span<const u8>)> &writer) {
+            if (patches.getEndAddress() > format.maxAddress + 1)
+                return wolv::util::Unexpected(IPSError::AddressOutOfRange);
 
-        std::vector<u64> addresses;
-        std::vector<u8> values;
+            const auto footerAddress = getFooterAddress(format);
 
-        for (const auto &[address, value] : m_patches) {
-            addresses.push_back(address);
-            values.push_back(value);
-        }
+            writer({ reinterpret_cast<const u8*>(format.header.data()), format.header.size() });
 
-        std::optional<u64> startAddress;
-        std::vector<u8> bytes;
-        for (u32 i = 0; i < addresses.size(); i++) {
-            if (!startAddress.has_value())
-                startAddress = addresses[i];
+            std::vector<u8> recordHeader(format.addressSize + sizeof(u16));
+            patches.forEachExtent([&](u64 address, std::span<const u8> data) {
+                // Split extents that are too big for a single record
+                while (!data.empty()) {
+                    size_t recordSize = std::min<size_t>(data.size(), MaxRecordSize);
 
-            if (i != addresses.size() - 1 && addresses[i] == (addresses[i + 1] - 1)) {
-                bytes.push_back(values[i]);
-            } else {
-                bytes.push_back(values[i]);
+                    // Make sure the next record doesn't start at the address that looks like the footer
+                    if (address + recordSize == footerAddress && recordSize < data.size() && recordSize > 1)
+                        recordSize -= 1;
 
-                if (bytes.size() > 0xFFFF)
-                    return wolv::util::Unexpected(IPSError::PatchTooLarge);
-                if (startAddress > 0xFFFF'FFFF)
-                    return wolv::util::Unexpected(IPSError::AddressOutOfRange);
+                    for (u8 i = 0; i < format.addressSize; i += 1)
+                        recordHeader[i] = u8(address >> ((format.addressSize - 1 - i) * 8));
+                    recordHeader[format.addressSize + 0] = u8(recordSize >> 8);
+                    recordHeader[format.addressSize + 1] = u8(recordSize >> 0);
 
-                u32 address       = startAddress.value();
-                auto addressBytes = reinterpret_cast<u8 *>(&address);
+                    writer(recordHeader);
+                    writer(data.subspan(0, recordSize));
 
-                result.push_back(addressBytes[2]);
-                result.push_back(addressBytes[1]);
-                result.push_back(addressBytes[0]);
-                pushBytesBack<u16>(result, changeEndianess<u16>(bytes.size(), std::endian::big));
+                    address += recordSize;
+                    data = data.subspan(recordSize);
+                }
+            });
 
-                for (auto byte : bytes)
-                    result.push_back(byte);
+            writer({ reinterpret_cast<const u8*>(format.footer.data()), format.footer.size() });
 
-                bytes.clear();
-                startAddress = {};
-            }
+            return { };
         }
 
-        pushStringBack(result, "EOF");
+        wolv::util::Expected<Patches, IPSError> readPatch(const IPSFormat &format, std::span<const u8> ipsPatch) {
+            if (ipsPatch.size() < format.header.size() + format.footer.size())
+                return wolv::util::Unexpected(IPSError::InvalidPatchHeader);
 
-        return result;
-    }
+            if (std::memcmp(ipsPatch.data(), format.header.data(), format.header.size()) != 0)
+                return wolv::util::Unexpected(IPSError::InvalidPatchHeader);
 
-    wolv::util::Expected<std::vector<u8>, IPSError> Patches::toIPS32Patch() const {
-        std::vector<u8> result;
+            const auto readBigEndian = [&](size_t offset, size_t size) {
+                u64 value = 0;
+                for (size_t i = 0; i < size; i += 1)
+                    value = (value << 8) | ipsPatch[offset + i];
 
-        pushStringBack(result, "IPS32");
+                return value;
+            };
 
-        std::vector<u64> addresses;
-        std::vector<u8> values;
+            Patches result;
 
-        for (const auto &[address, value] : m_patches) {
-            addresses.push_back(address);
-            values.push_back(value);
-        }
+            size_t ipsOffset = format.header.size();
+            while (true) {
+                if (ipsOffset + format.footer.size() <= ipsPatch.size() && std::memcmp(ipsPatch.data() + ipsOffset, format.footer.data(), format.footer.size()) == 0)
+                    return result;
 
-        std::optional<u64> startAddress;
-        std::vector<u8> bytes;
-        for (u32 i = 0; i < addresses.size(); i++) {
-            if (!startAddress.has_value())
-                startAddress = addresses[i];
+                if (ipsOffset + format.addressSize + sizeof(u16) > ipsPatch.size())
+                    return wolv::util::Unexpected(IPSError::MissingEOF);
 
-            if (i != addresses.size() - 1 && addresses[i] == (addresses[i + 1] - 1)) {
-                bytes.push_back(values[i]);
-            } else {
-                bytes.push_back(values[i]);
+                const u64 address = readBigEndian(ipsOffset, format.addressSize);
+                const u16 size    = readBigEndian(ipsOffset + format.addressSize, sizeof(u16));
 
-                if (bytes.size() > 0xFFFF)
-                    return wolv::util::Unexpected(IPSError::PatchTooLarge);
-                if (startAddress > 0xFFFF'FFFF)
-                    return wolv::util::Unexpected(IPSError::AddressOutOfRange);
+                ipsOffset += format.addressSize + sizeof(u16);
 
-                u32 address       = startAddress.value();
-                auto addressBytes = reinterpret_cast<u8 *>(&address);
+                // Handle normal record
+                if (size > 0x0000) {
+                    if (ipsOffset + size > ipsPatch.size())
+                        return wolv::util::Unexpected(IPSError::InvalidPatchFormat);
 
-                result.push_back(addressBytes[3]);
-                result.push_back(addressBytes[2]);
-                result.push_back(addressBytes[1]);
-                result.push_back(addressBytes[0]);
-                pushBytesBack<u16>(result, changeEndianess<u16>(bytes.size(), std::endian::big));
+                    result.get().write(address, ipsPatch.data() + ipsOffset, size);
+                    ipsOffset += size;
+                }
+                // Handle RLE record
+                else {
+                    if (ipsOffset + sizeof(u16) + sizeof(u8) > ipsPatch.size())
+                        return wolv::util::Unexpected(IPSError::InvalidPatchFormat);
 
-                for (auto byte : bytes)
-                    result.push_back(byte);
+                    const u16 rleSize = readBigEndian(ipsOffset, sizeof(u16));
+                    const std::vector<u8> data(rleSize, ipsPatch[ipsOffset + sizeof(u16)]);
 
-                bytes.clear();
-                startAddress = {};
+                    result.get().write(address, data.data(), data.size());
+                    ipsOffset += sizeof(u16) + sizeof(u8);
+                }
             }
         }
 
-        pushStringBack(result, "EEOF");
+        // Extent stream layout: magic, version, followed by records of a little endian u64 address, a little endian u64 size and the data
+        constexpr std::string_view ExtentStreamMagic   = "IMHXPTCH";
+        constexpr u32              ExtentStreamVersion = 1;
 
-        return result;
-    }
+        template<typename T>
+        void appendLittleEndian(std::vector<u8> &buffer, T value) {
+            for (size_t i = 0; i < sizeof(T); i += 1)
+                buffer.push_back(u8(value >> (i * 8)));
+        }
 
-    wolv::util::Expected<Patches, IPSError> Patches::fromProvider(hex::prv::Provider* provider) {
-        PatchesGenerator generator;
+        template<typename T>
+        T readLittleEndian(std::span<const u8> buffer, size_t offset) {
+            T value = 0;
+            for (size_t i = 0; i < sizeof(T); i += 1)
+                value |= T(buffer[offset + i]) << (i * 8);
 
-        generator.getUndoStack().apply(provider->getUndoStack());
+            return value;
+        }
 
-        if (generator.getActualSize() > 0xFFFF'FFFF)
-            return wolv::util::Unexpected(IPSError::PatchTooLarge);
+        std::vector<u8> writePatchToBuffer(const IPSFormat &format, const ExtentMap &patches, wolv::util::Expected<void, IPSError> &status) {
+            std::vector<u8> result;
+            result.reserve(format.header.size() + patches.getSize() + patches.getExtentCount() * (format.addressSize + sizeof(u16)) + format.footer.size());
 
-        auto patches = generator.getPatches();
+            status = writePatch(format, patches, [&](std::span<const u8> data) {
+                result.insert(result.end(), data.begin(), data.end());
+            });
+
+            return result;
+        }
 
-        return Patches(std::move(patches));
     }
 
+    wolv::util::Expected<std::vector<u8>, IPSError> Patches::toIPSPatch() const {
+        wolv::util::Expected<void, IPSError> status;
+        auto result = writePatchToBuffer(IPS, m_patches, status);
+        if (!status.has_value())
+            return wolv::util::Unexpected(status.error());
 
-    wolv::util::Expected<Patches, IPSError> Patches::fromIPSPatch(const std::vector<u8> &ipsPatch) {
-        if (ipsPatch.size() < (5 + 3))
-            return wolv::util::Unexpected(IPSError::InvalidPatchHeader);
+        return result;
+    }
 
-        const char *header = "PATCH";
-        if (std::memcmp(ipsPatch.data(), header, 5) != 0)
-            return wolv::util::Unexpected(IPSError::InvalidPatchHeader);
+    wolv::util::Expected<std::vector<u8>, IPSError> Patches::toIPS32Patch() const {
+        wolv::util::Expected<void, IPSError> status;
+        auto result = writePatchToBuffer(IPS32, m_patches, status);
+        if (!status.has_value())
+            return wolv::util::Unexpected(status.error());
 
-        Patches result;
-        bool foundEOF = false;
+        return result;
+    }
 
-        u32 ipsOffset = 5;
-        while (ipsOffset < ipsPatch.size() - (5 + 3)) {
-            u32 offset = ipsPatch[ipsOffset + 2] | (ipsPatch[ipsOffset + 1] << 8) | (ipsPatch[ipsOffset + 0] << 16);
-            u16 size   = ipsPatch[ipsOffset + 4] | (ipsPatch[ipsOffset + 3] << 8);
+    wolv::util::Expected<void, IPSError> Patches::writeIPSPatch(const std::function<void(std::span<const u8>)> &writer) const {
+        return writePatch(IPS, m_patches, writer);
+    }
 
-            ipsOffset += 5;
+    wolv::util::Expected<void, IPSError> Patches::writeIPS32Patch(const std::function<void(std::span<const u8>)> &writer) const {
+        return writePatch(IPS32, m_patches, writer);
+    }
 
-            // Handle normal record
-            if (size > 0x0000) {
-                if (ipsOffset + size > ipsPatch.size() - 3)
-                    return wolv::util::Unexpected(IPSError::InvalidPatchFormat);
+    wolv::util::Expected<Patches, IPSError> Patches::fromProvider(hex::prv::Provider* provider) {
+        PatchesGenerator generator;
 
-                for (u16 i = 0; i < size; i++)
-                    result.get()[offset + i] = ipsPatch[ipsOffset + i];
-                ipsOffset += size;
-            }
-            // Handle RLE record
-            else {
-                if (ipsOffset + 3 > ipsPatch.size() - 3)
-                    return wolv::util::Unexpected(IPSError::InvalidPatchFormat);
+        generator.getUndoStack().apply(provider->getUndoStack());
+
+        // Whether the patches fit into a specific format is checked when they're written
+        return Patches(generator.takePatches());
+    }
 
-                u16 rleSize = ipsPatch[ipsOffset + 0] | (ipsPatch[ipsOffset + 1] << 8);
+    wolv::util::Expected<Patches, IPSError> Patches::fromIPSPatch(std::span<const u8> ipsPatch) {
+        return readPatch(IPS, ipsPatch);
+    }
 
-                ipsOffset += 2;
+    wolv::util::Expected<Patches, IPSError> Patches::fromIPS32Patch(std::span<const u8> ipsPatch) {
+        return readPatch(IPS32, ipsPatch);
+    }
 
-                for (u16 i = 0; i < rleSize; i++)
-                    result.get()[offset + i] = ipsPatch[ipsOffset + 0];
+    std::vector<u8> Patches::toExtentStream() const {
+        std::vector<u8> result;
+        result.reserve(ExtentStreamMagic.size() + sizeof(u32) + m_patches.getSize() + m_patches.getExtentCount() * 2 * sizeof(u64));
 
-                ipsOffset += 1;
-            }
+        result.insert(result.end(), ExtentStreamMagic.begin(), ExtentStreamMagic.end());
+        appendLittleEndian<u32>(result, ExtentStreamVersion);
 
-            const char *footer = "EOF";
-            if (std::memcmp(ipsPatch.data() + ipsOffset, footer, 3) == 0)
-                foundEOF = true;
-        }
+        m_patches.forEachExtent([&](u64 address, std::span<const u8> data) {
+            appendLittleEndian<u64>(result, address);
+            appendLittleEndian<u64>(result, data.size());
+            result.insert(result.end(), data.begin(), data.end());
+        });
 
-        if (foundEOF)
-            return result;
-        else
-            return wolv::util::Unexpected(IPSError::MissingEOF);
+        return result;
     }
 
-    wolv::util::Expected<Patches, IPSError> Patches::fromIPS32Patch(const std::vector<u8> &ipsPatch) {
-        if (ipsPatch.size() < (5 + 4))
+    wolv::util::Expected<Patches, IPSError> Patches::fromExtentStream(std::span<const u8> data) {
+        if (data.size() < ExtentStreamMagic.size() + sizeof(u32))
             return wolv::util::Unexpected(IPSError::InvalidPatchHeader);
-
-        const char *header = "IPS32";
-        if (std::memcmp(ipsPatch.data(), header, 5) != 0)
+        if (std::memcmp(data.data(), ExtentStreamMagic.data(), ExtentStreamMagic.size()) != 0)
+            return wolv::util::Unexpected(IPSError::InvalidPatchHeader);
+        if (readLittleEndian<u32>(data, ExtentStreamMagic.size()) != ExtentStreamVersion)
             return wolv::util::Unexpected(IPSError::InvalidPatchHeader);
 
         Patches result;
-        bool foundEEOF = false;
 
-        u32 ipsOffset = 5;
-        while (ipsOffset < ipsPatch.size() - (5 + 4)) {
-            u32 offset = ipsPatch[ipsOffset + 3] | (ipsPatch[ipsOffset + 2] << 8) | (ipsPatch[ipsOffset + 1] << 16) | (ipsPatch[ipsOffset + 0] << 24);
-            u16 size   = ipsPatch[ipsOffset + 5] | (ipsPatch[ipsOffset + 4] << 8);
+        size_t offset = ExtentStreamMagic.size() + sizeof(u32);
+        while (offset < data.size()) {
+            if (data.size() - offset < 2 * sizeof(u64))
+                return wolv::util::Unexpected(IPSError::InvalidPatchFormat);
 
-            ipsOffset += 6;
+            const auto address = readLittleEndian<u64>(data, offset);
+            const auto size    = readLittleEndian<u64>(data, offset + sizeof(u64));
+            offset += 2 * sizeof(u64);
 
-            // Handle normal record
-            if (size > 0x0000) {
-                if (ipsOffset + size > ipsPatch.size() - 3)
-                    return wolv::util::Unexpected(IPSError::InvalidPatchFormat);
+            if (size > data.size() - offset)
+                return wolv::util::Unexpected(IPSError::InvalidPatchFormat);
 
-                for (u16 i = 0; i < size; i++)
-                    result.get()[offset + i] = ipsPatch[ipsOffset + i];
-                ipsOffset += size;
-            }
-            // Handle RLE record
-            else {
-                if (ipsOffset + 3 > ipsPatch.size() - 3)
-                    return wolv::util::Unexpected(IPSError::InvalidPatchFormat);
-
-                u16 rleSize = ipsPatch[ipsOffset + 0] | (ipsPatch[ipsOffset + 1] << 8);
-
-                ipsOffset += 2;
-
-                for (u16 i = 0; i < rleSize; i++)
-                    result.get()[offset + i] = ipsPatch[ipsOffset + 0];
-
-                ipsOffset += 1;
-            }
-
-            const char *footer = "EEOF";
-            if (std::memcmp(ipsPatch.data() + ipsOffset, footer, 4) == 0)
-                foundEEOF = true;
+            result.get().write(address, data.data() + offset, size);
+            offset += size;
         }
 
-        if (foundEEOF)
-            return result;
-        else
-            return wolv::util::Unexpected(IPSError::MissingEOF);
+        return result;
     }
 
-}
\ No newline at end of file
+}
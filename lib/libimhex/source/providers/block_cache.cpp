@@ -0,0 +1,309 @@
+#include <hex/providers/block_cache.hpp>
+
+#include <wolv/utils/guards.hpp>
+
+#include <algorithm>
+#include <cstring>
+
+namespace hex::prv {
+
+    namespace {
+
+        // Number of back-to-back sequential reads after which read-ahead kicks in
+        constexpr static u32 SequentialReadThreshold = 2;
+
+    }
+
+    BlockCache::BlockCache(size_t blockSize, size_t maxBlocks) : m_blockSize(std::max<size_t>(blockSize, 1)), m_maxBlocks(std::max<size_t>(maxBlocks, 1)) {
+
+    }
+
+    void BlockCache::read(u64 address, void *buffer, size_t size, const ReadFunction &readFunction) {
+        if (size == 0 || buffer == nullptr)
+            return;
+
+        std::unique_lock lock(m_mutex);
+
+        auto bytes = static_cast<u8*>(buffer);
+        const auto blockSize  = m_blockSize;
+        const auto endAddress = address + size;
+        const auto firstBlock = address / blockSize;
+        const auto lastBlock  = (endAddress - 1) / blockSize;
+
+        // Reads continuing where the previous one left off are considered sequential
+        if (firstBlock == m_nextSequentialBlock || firstBlock + 1 == m_nextSequentialBlock)
+            m_sequentialReads += 1;
+        else
+            m_sequentialReads = 0;
+        m_nextSequentialBlock = lastBlock + 1;
+
+        const auto copyBlock = [&](u64 blockIndex, const u8 *data, size_t dataSize) {
+            const auto blockAddress = blockIndex * blockSize;
+            const auto copyStart    = std::max<u64>(address, blockAddress);
+            const auto copyEnd      = std::min<u64>(endAddress, blockAddress + dataSize);
+
+            if (copyStart < copyEnd)
+                std::memcpy(bytes + (copyStart - address), data + (copyStart - blockAddress), copyEnd - copyStart);
+        };
+
+        for (u64 blockIndex = firstBlock; blockIndex <= lastBlock;) {
+            // The block size was changed while the lock was released, read the rest of the range without the cache
+            if (m_blockSize != blockSize) {
+                lock.unlock();
+
+                const auto readAddress = std::max<u64>(address, blockIndex * blockSize);
+                std::vector<u8> remainder(endAddress - readAddress);
+                if (readFunction(readAddress, remainder.data(), remainder.size()))
+                    std::memcpy(bytes + (readAddress - address), remainder.data(), remainder.size());
+
+                return;
+            }
+
+            if (auto block = this->lookup(blockIndex); block != nullptr) {
+                m_statistics.hits += 1;
+                copyBlock(blockIndex, block->data.data(), block->data.size());
+                blockIndex += 1;
+
+                continue;
+            }
+
+            // Another thread is already fetching this block, wait for it instead of requesting it a second time
+            if (m_inFlightBlocks.contains(blockIndex)) {
+                m_fetchFinished.wait(lock, [&] { return !m_inFlightBlocks.contains(blockIndex); });
+                continue;
+            }
+
+            const auto isMissing = [this](u64 index) {
+                return !this->contains(index) && !m_inFlightBlocks.contains(index);
+            };
+
+            // Fetch all consecutive missing blocks with a single request
+            auto missingEnd = blockIndex + 1;
+            while (missingEnd <= lastBlock && isMissing(missingEnd))
+                missingEnd += 1;
+
+            m_statistics.misses += missingEnd - blockIndex;
+
+            auto fetchEnd = missingEnd;
+            if (missingEnd > lastBlock && m_sequentialReads >= SequentialReadThreshold) {
+                const auto readAheadBlocks = std::min<size_t>(m_readAheadBlocks, m_maxBlocks / 2);
+                while (fetchEnd < missingEnd + readAheadBlocks && fetchEnd * blockSize < m_endAddress && isMissing(fetchEnd))
+                    fetchEnd += 1;
+
+                m_statistics.readAheadBlocks += fetchEnd - missingEnd;
+            }
+
+            // Release the lock while the data is being read so hits and misses on other blocks don't have to wait for it
+            for (u64 fetchIndex = blockIndex; fetchIndex < fetchEnd; fetchIndex += 1)
+                m_inFlightBlocks.insert(fetchIndex);
+
+            const auto generation      = m_generation;
+            const auto fetchEndAddress = m_endAddress;
+
+            std::vector<Block> blocks;
+            {
+                lock.unlock();
+                ON_SCOPE_EXIT {
+                    lock.lock();
+
+                    for (u64 fetchIndex = blockIndex; fetchIndex < fetchEnd; fetchIndex += 1)
+                        m_inFlightBlocks.erase(fetchIndex);
+                    m_fetchFinished.notify_all();
+                };
+
+                fetch(blockIndex, fetchEnd, blockSize, fetchEndAddress, readFunction, blocks);
+            }
+
+            for (auto &block : blocks) {
+                copyBlock(block.index, block.data.data(), block.data.size());
+
+                // Don't cache data that might have been overwritten or invalidated while it was being read
+                if (m_generation == generation)
+                    this->insert(std::move(block));
+            }
+
+            blockIndex = missingEnd;
+        }
+    }
+
+    void BlockCache::update(u64 address, const void *buffer, size_t size) {
+        if (size == 0 || buffer == nullptr)
+            return;
+
+        std::scoped_lock lock(m_mutex);
+        m_generation += 1;
+
+        auto bytes = static_cast<const u8*>(buffer);
+        const auto endAddress = address + size;
+
+        for (u64 blockIndex = address / m_blockSize; blockIndex <= (endAddress - 1) / m_blockSize; blockIndex += 1) {
+            auto it = m_blocks.find(blockIndex);
+            if (it == m_blocks.end())
+                continue;
+
+            auto &block = *it->second;
+            const auto blockAddress = blockIndex * m_blockSize;
+            const auto copyStart    = std::max<u64>(address, blockAddress);
+            const auto copyEnd      = std::min<u64>(endAddress, blockAddress + block.data.size());
+
+            if (copyStart < copyEnd)
+                std::memcpy(block.data.data() + (copyStart - blockAddress), bytes + (copyStart - address), copyEnd - copyStart);
+        }
+    }
+
+    void BlockCache::invalidate() {
+        std::scoped_lock lock(m_mutex);
+        m_generation += 1;
+
+        m_blocks.clear();
+        m_lruList.clear();
+    }
+
+    void BlockCache::invalidate(u64 address, size_t size) {
+        if (size == 0)
+            return;
+
+        std::scoped_lock lock(m_mutex);
+        m_generation += 1;
+
+        const auto lastBlock = (address + size - 1) / m_blockSize;
+        for (u64 blockIndex = address / m_blockSize; blockIndex <= lastBlock; blockIndex += 1) {
+            if (auto it = m_blocks.find(blockIndex); it != m_blocks.end()) {
+                m_lruList.erase(it->second);
+                m_blocks.erase(it);
+            }
+        }
+    }
+
+    void BlockCache::setBlockSize(size_t blockSize) {
+        std::scoped_lock lock(m_mutex);
+
+        m_blockSize = std::max<size_t>(blockSize, 1);
+        m_generation += 1;
+        m_blocks.clear();
+        m_lruList.clear();
+    }
+
+    size_t BlockCache::getBlockSize() const {
+        std::scoped_lock lock(m_mutex);
+
+        return m_blockSize;
+    }
+
+    void BlockCache::setMaxBlocks(size_t maxBlocks) {
+        std::scoped_lock lock(m_mutex);
+
+        m_maxBlocks = std::max<size_t>(maxBlocks, 1);
+        while (m_blocks.size() > m_maxBlocks)
+            this->evict();
+    }
+
+    void BlockCache::setReadAheadBlocks(size_t readAheadBlocks) {
+        std::scoped_lock lock(m_mutex);
+
+        m_readAheadBlocks = readAheadBlocks;
+    }
+
+    void BlockCache::setEndAddress(u64 endAddress) {
+        std::scoped_lock lock(m_mutex);
+
+        m_endAddress = endAddress;
+    }
+
+    void BlockCache::setMaxAge(std::chrono::milliseconds maxAge) {
+        std::scoped_lock lock(m_mutex);
+
+        m_maxAge = maxAge;
+    }
+
+    std::vector<u64> BlockCache::getCachedBlocks() const {
+        std::scoped_lock lock(m_mutex);
+
+        std::vector<u64> result;
+        result.reserve(m_lruList.size());
+        for (const auto &block : m_lruList)
+            result.push_back(block.index * m_blockSize);
+
+        return result;
+    }
+
+    BlockCache::Statistics BlockCache::getStatistics() const {
+        std::scoped_lock lock(m_mutex);
+
+        return m_statistics;
+    }
+
+    void BlockCache::resetStatistics() {
+        std::scoped_lock lock(m_mutex);
+
+        m_statistics = { };
+    }
+
+    const BlockCache::Block* BlockCache::lookup(u64 blockIndex) {
+        auto it = m_blocks.find(blockIndex);
+        if (it == m_blocks.end())
+            return nullptr;
+
+        if (m_maxAge != std::chrono::milliseconds::zero() && std::chrono::steady_clock::now() - it->second->fetchTime > m_maxAge) {
+            m_lruList.erase(it->second);
+            m_blocks.erase(it);
+
+            return nullptr;
+        }
+
+        // Move the block to the front of the LRU list
+        m_lruList.splice(m_lruList.begin(), m_lruList, it->second);
+
+        return &*it->second;
+    }
+
+    bool BlockCache::contains(u64 blockIndex) const {
+        return m_blocks.contains(blockIndex);
+    }
+
+    void BlockCache::fetch(u64 firstBlock, u64 endBlock, size_t blockSize, u64 endAddress, const ReadFunction &readFunction, std::vector<Block> &result) {
+        const auto fetchAddress = firstBlock * blockSize;
+        if (fetchAddress >= endAddress)
+            return;
+
+        const auto fetchSize = std::min<u64>((endBlock - firstBlock) * blockSize, endAddress - fetchAddress);
+
+        std::vector<u8> buffer(fetchSize);
+        if (readFunction(fetchAddress, buffer.data(), buffer.size())) {
+            const auto fetchTime = std::chrono::steady_clock::now();
+            for (u64 offset = 0; offset < buffer.size(); offset += blockSize) {
+                const auto blockIndex = firstBlock + offset / blockSize;
+                const auto dataSize   = std::min<u64>(blockSize, buffer.size() - offset);
+
+                result.push_back({ blockIndex, fetchTime, std::vector<u8>(buffer.begin() + offset, buffer.begin() + offset + dataSize) });
+            }
+        } else if (endBlock - firstBlock > 1) {
+            // Part of the range may not be readable, try again block by block so the readable blocks still get cached
+            for (u64 blockIndex = firstBlock; blockIndex < endBlock; blockIndex += 1)
+                fetch(blockIndex, blockIndex + 1, blockSize, endAddress, readFunction, result);
+        }
+    }
+
+    void BlockCache::insert(Block &&block) {
+        if (auto it = m_blocks.find(block.index); it != m_blocks.end()) {
+            m_lruList.erase(it->second);
+            m_blocks.erase(it);
+        }
+
+        while (m_blocks.size() >= m_maxBlocks)
+            this->evict();
+
+        const auto blockIndex = block.index;
+        m_lruList.push_front(std::move(block));
+        m_blocks[blockIndex] = m_lruList.begin();
+    }
+
+    void BlockCache::evict() {
+        if (m_lruList.empty())
+            return;
+
+        m_blocks.erase(m_lruList.back().index);
+        m_lruList.pop_back();
+    }
+
+}
@@ -0,0 +1,229 @@
+#include <hex/providers/buffered_reader.hpp>
+
+#include <hex/api/task_manager.hpp>
+
+#include <wolv/utils/guards.hpp>
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+
+namespace hex::prv {
+
+    struct ProviderPrefetcher::Window {
+        enum class State {
+            Pending,
+            Reading,
+            Ready,
+            Failed,
+            Claimed
+        };
+
+        u64 address;
+        size_t size;
+        std::vector<u8> data;
+
+        // Handed over to whoever claims the window and dropped as soon as it's cancelled. Queued tasks may only run long
+        // after the reader and its provider are gone, they must not keep the snapshot alive until then
+        Snapshot snapshot;
+
+        State state = State::Pending;
+        std::mutex mutex;
+        std::condition_variable stateChanged;
+    };
+
+    ProviderPrefetcher::ProviderPrefetcher(Provider *provider, size_t depth) : m_provider(provider), m_depth(depth) {
+
+    }
+
+    ProviderPrefetcher::ProviderPrefetcher(Snapshot snapshot, size_t depth) : m_provider(snapshot.getProvider()), m_snapshot(std::move(snapshot)), m_depth(depth) {
+
+    }
+
+    ProviderPrefetcher::~ProviderPrefetcher() {
+        // Workers must be done with the provider before the reader goes away
+        this->cancelWindows();
+        this->setSequential(false);
+    }
+
+    void ProviderPrefetcher::read(u64 address, void *buffer, size_t size) {
+        if (size == 0)
+            return;
+
+        const Region request = { address, size };
+        const bool forward  = m_previousRead.has_value() && address == m_previousRead->getEndAddress() + 1;
+        const bool backward = m_previousRead.has_value() && request.getEndAddress() + 1 == m_previousRead->getStartAddress();
+        m_previousRead = request;
+
+        if (auto window = this->takeWindow(address, size); window != nullptr) {
+            std::memcpy(buffer, window->data.data() + (address - window->address), size);
+            m_spareBuffer = std::move(window->data);
+        } else {
+            this->cancelWindows();
+            readData(m_provider, m_snapshot, address, buffer, size);
+        }
+
+        this->setSequential(forward || backward);
+
+        if (m_depth == 0)
+            return;
+
+        if (forward || backward)
+            this->fillWindows(forward, address, size);
+        else
+            this->cancelWindows();
+    }
+
+    void ProviderPrefetcher::setSequential(bool sequential) {
+        if (m_sequential == sequential || m_provider == nullptr)
+            return;
+
+        m_sequential = sequential;
+        if (sequential)
+            m_provider->beginSequentialAccess();
+        else
+            m_provider->endSequentialAccess();
+    }
+
+    void ProviderPrefetcher::setDepth(size_t depth) {
+        m_depth = depth;
+
+        if (m_depth == 0)
+            this->cancelWindows();
+    }
+
+    std::shared_ptr<ProviderPrefetcher::Window> ProviderPrefetcher::takeWindow(u64 address, size_t size) {
+        auto it = std::find_if(m_windows.begin(), m_windows.end(), [&](const auto &window) {
+            return address >= window->address && address + size <= window->address + window->size;
+        });
+
+        if (it == m_windows.end())
+            return nullptr;
+
+        auto window = *it;
+
+        // Windows before the matching one have been skipped over and won't be needed anymore
+        std::for_each(m_windows.begin(), it, cancelWindow);
+        m_windows.erase(m_windows.begin(), it + 1);
+
+        using enum Window::State;
+
+        std::unique_lock lock(window->mutex);
+        switch (window->state) {
+            case Pending:
+                // No worker picked the window up yet. Read it here instead of waiting, the pool might be busy running the very task that's using this reader
+                window->state = Claimed;
+                window->snapshot = { };
+                lock.unlock();
+
+                readData(m_provider, m_snapshot, window->address, window->data.data(), window->size);
+                return window;
+            case Reading:
+                window->stateChanged.wait(lock, [&] { return window->state != Reading; });
+                return window->state == Ready ? window : nullptr;
+            case Ready:
+                return window;
+            default:
+                return nullptr;
+        }
+    }
+
+    void ProviderPrefetcher::schedule(u64 address, size_t size) {
+        auto window = std::make_shared<Window>();
+        window->address = address;
+        window->size    = size;
+        window->data    = std::move(m_spareBuffer);
+        window->data.resize(size);
+        window->snapshot = m_snapshot;
+
+        TaskManager::createBackgroundTask("Prefetching data", [window, provider = m_provider](auto &) {
+            Snapshot snapshot;
+            {
+                std::scoped_lock lock(window->mutex);
+                if (window->state != Window::State::Pending)
+                    return;
+
+                window->state = Window::State::Reading;
+                snapshot = std::move(window->snapshot);
+            }
+
+            bool success = false;
+            ON_SCOPE_EXIT {
+                // Release the snapshot before the window is done, the reader and the provider may go away right after
+                snapshot = { };
+
+                {
+                    std::scoped_lock lock(window->mutex);
+                    window->state = success ? Window::State::Ready : Window::State::Failed;
+                }
+
+                window->stateChanged.notify_all();
+            };
+
+            readData(provider, snapshot, window->address, window->data.data(), window->size);
+            success = true;
+        });
+
+        m_windows.push_back(std::move(window));
+    }
+
+    void ProviderPrefetcher::fillWindows(bool forward, u64 address, size_t size) {
+        const auto startAddress = m_provider->getBaseAddress();
+        const auto actualSize   = m_provider->getActualSize();
+        if (actualSize == 0)
+            return;
+
+        const auto lastAddress = startAddress + actualSize - 1;
+
+        // Continue after the last window that's already queued up
+        u64 cursor;
+        if (m_windows.empty())
+            cursor = forward ? address + size : address;
+        else
+            cursor = forward ? m_windows.back()->address + m_windows.back()->size : m_windows.back()->address;
+
+        while (m_windows.size() < m_depth) {
+            if (forward) {
+                if (cursor > lastAddress || cursor < startAddress)
+                    break;
+
+                const auto windowSize = std::min<u64>(size, lastAddress - cursor + 1);
+                this->schedule(cursor, windowSize);
+                cursor += windowSize;
+            } else {
+                if (cursor <= startAddress || cursor > lastAddress + 1)
+                    break;
+
+                const auto windowStart = cursor - startAddress < size ? startAddress : cursor - size;
+                this->schedule(windowStart, cursor - windowStart);
+                cursor = windowStart;
+            }
+        }
+    }
+
+    void ProviderPrefetcher::readData(Provider *provider, const Snapshot &snapshot, u64 address, void *buffer, size_t size) {
+        // Reads from a stale snapshot only produce zeros, the readers' users check the snapshot once they're done
+        if (snapshot.isValid())
+            snapshot.read(address, buffer, size);
+        else
+            provider->read(address, buffer, size);
+    }
+
+    void ProviderPrefetcher::cancelWindow(const std::shared_ptr<Window> &window) {
+        std::unique_lock lock(window->mutex);
+
+        if (window->state == Window::State::Pending) {
+            window->state = Window::State::Claimed;
+            window->snapshot = { };
+        } else {
+            window->stateChanged.wait(lock, [&] { return window->state != Window::State::Reading; });
+        }
+    }
+
+    void ProviderPrefetcher::cancelWindows() {
+        std::for_each(m_windows.begin(), m_windows.end(), cancelWindow);
+        m_windows.clear();
+    }
+
+}
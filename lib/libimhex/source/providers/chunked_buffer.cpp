@@ -0,0 +1,300 @@
+#include <hex/providers/chunked_buffer.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <unordered_set>
+
+namespace hex::prv {
+
+    struct ChunkedBuffer::Node {
+        Piece piece;
+        u32 priority;
+        u64 subtreeSize;
+        u64 subtreeCount;
+
+        NodePtr left, right;
+    };
+
+    namespace {
+
+        u64 sizeOf(const auto &node) {
+            return node == nullptr ? 0 : node->subtreeSize;
+        }
+
+        u64 countOf(const auto &node) {
+            return node == nullptr ? 0 : node->subtreeCount;
+        }
+
+        void update(auto &node) {
+            node->subtreeSize  = node->piece.size + sizeOf(node->left) + sizeOf(node->right);
+            node->subtreeCount = 1 + countOf(node->left) + countOf(node->right);
+        }
+
+        template<typename NodeType, typename Callback>
+        void visitOverlapping(NodeType *node, u64 subtreeStart, u64 offset, u64 endOffset, const Callback &callback) {
+            if (node == nullptr)
+                return;
+
+            const auto pieceStart = subtreeStart + sizeOf(node->left);
+            const auto pieceEnd   = pieceStart + node->piece.size;
+
+            if (offset < pieceStart)
+                visitOverlapping(node->left.get(), subtreeStart, offset, endOffset, callback);
+
+            if (offset < pieceEnd && endOffset > pieceStart)
+                callback(pieceStart, node->piece);
+
+            if (endOffset > pieceEnd)
+                visitOverlapping(node->right.get(), pieceEnd, offset, endOffset, callback);
+        }
+
+    }
+
+    ChunkedBuffer::ChunkedBuffer() = default;
+    ChunkedBuffer::~ChunkedBuffer() = default;
+    ChunkedBuffer::ChunkedBuffer(ChunkedBuffer &&other) noexcept = default;
+    ChunkedBuffer& ChunkedBuffer::operator=(ChunkedBuffer &&other) noexcept = default;
+
+    u64 ChunkedBuffer::getSize() const {
+        return sizeOf(m_root);
+    }
+
+    size_t ChunkedBuffer::getPieceCount() const {
+        return countOf(m_root);
+    }
+
+    u64 ChunkedBuffer::getStorageSize() const {
+        std::unordered_set<const std::vector<u8>*> chunks;
+        u64 result = 0;
+
+        this->forEach(0, this->getSize(), [&](u64, const Piece &piece) {
+            if (piece.chunk != nullptr && chunks.insert(piece.chunk.get()).second)
+                result += piece.chunk->size();
+        });
+
+        return result;
+    }
+
+    ChunkedBuffer::NodePtr ChunkedBuffer::createNode(Piece piece) {
+        // Xorshift is plenty for treap priorities and keeps the buffer deterministic
+        m_seed ^= m_seed << 13;
+        m_seed ^= m_seed >> 17;
+        m_seed ^= m_seed << 5;
+
+        auto node = std::make_unique<Node>();
+        node->piece    = std::move(piece);
+        node->priority = m_seed;
+        update(node);
+
+        return node;
+    }
+
+    std::pair<ChunkedBuffer::NodePtr, ChunkedBuffer::NodePtr> ChunkedBuffer::split(NodePtr &&node, u64 position) {
+        if (node == nullptr)
+            return { nullptr, nullptr };
+
+        const auto leftSize = sizeOf(node->left);
+        if (position <= leftSize) {
+            auto [left, right] = this->split(std::move(node->left), position);
+            node->left = std::move(right);
+            update(node);
+
+            return { std::move(left), std::move(node) };
+        } else if (position >= leftSize + node->piece.size) {
+            auto [left, right] = this->split(std::move(node->right), position - leftSize - node->piece.size);
+            node->right = std::move(left);
+            update(node);
+
+            return { std::move(node), std::move(right) };
+        } else {
+            // The split position lies inside of this node's piece. Both halves keep sharing the same chunk
+            const auto innerOffset = position - leftSize;
+
+            auto &piece = node->piece;
+            auto tail = this->createNode({ piece.chunk, piece.chunk == nullptr ? 0 : piece.offset + innerOffset, piece.size - innerOffset });
+            piece.size = innerOffset;
+
+            auto right = merge(std::move(tail), std::move(node->right));
+            update(node);
+
+            return { std::move(node), std::move(right) };
+        }
+    }
+
+    ChunkedBuffer::NodePtr ChunkedBuffer::merge(NodePtr &&left, NodePtr &&right) {
+        if (left == nullptr)
+            return std::move(right);
+        if (right == nullptr)
+            return std::move(left);
+
+        if (left->priority > right->priority) {
+            left->right = merge(std::move(left->right), std::move(right));
+            update(left);
+
+            return std::move(left);
+        } else {
+            right->left = merge(std::move(left), std::move(right->left));
+            update(right);
+
+            return std::move(right);
+        }
+    }
+
+    void ChunkedBuffer::forEach(u64 offset, u64 size, const std::function<void(u64, Piece &)> &callback) {
+        if (size > 0)
+            visitOverlapping(m_root.get(), 0, offset, offset + size, callback);
+    }
+
+    void ChunkedBuffer::forEach(u64 offset, u64 size, const std::function<void(u64, const Piece &)> &callback) const {
+        if (size > 0)
+            visitOverlapping(static_cast<const Node*>(m_root.get()), 0, offset, offset + size, callback);
+    }
+
+    void ChunkedBuffer::read(u64 offset, void *buffer, size_t size) const {
+        auto bytes = static_cast<u8*>(buffer);
+        const auto endOffset = offset + size;
+
+        this->forEach(offset, size, [&](u64 pieceStart, const Piece &piece) {
+            const auto overlapStart = std::max(offset, pieceStart);
+            const auto overlapEnd   = std::min(endOffset, pieceStart + piece.size);
+            auto destination = bytes + (overlapStart - offset);
+
+            if (piece.chunk == nullptr)
+                std::memset(destination, 0x00, overlapEnd - overlapStart);
+            else
+                std::memcpy(destination, piece.chunk->data() + piece.offset + (overlapStart - pieceStart), overlapEnd - overlapStart);
+        });
+    }
+
+    void ChunkedBuffer::write(u64 offset, const void *buffer, size_t size) {
+        auto bytes = static_cast<const u8*>(buffer);
+        const auto endOffset = offset + size;
+
+        // Ranges without storage get chunks allocated once we're done walking the tree
+        std::vector<std::pair<u64, u64>> unbackedRanges;
+
+        this->forEach(offset, size, [&](u64 pieceStart, Piece &piece) {
+            const auto overlapStart = std::max(offset, pieceStart);
+            const auto overlapEnd   = std::min(endOffset, pieceStart + piece.size);
+
+            if (piece.chunk == nullptr) {
+                unbackedRanges.emplace_back(pieceStart, piece.size);
+                return;
+            }
+
+            // Chunks shared with other pieces are copied before they get modified
+            if (piece.chunk.use_count() > 1) {
+                const auto begin = piece.chunk->begin() + piece.offset;
+                piece.chunk  = std::make_shared<std::vector<u8>>(begin, begin + piece.size);
+                piece.offset = 0;
+            }
+
+            std::memcpy(piece.chunk->data() + piece.offset + (overlapStart - pieceStart), bytes + (overlapStart - offset), overlapEnd - overlapStart);
+        });
+
+        for (const auto &[pieceStart, pieceSize] : unbackedRanges) {
+            // Only allocate the chunk sized windows that are actually written to, the rest of the range stays without storage
+            const auto windowStart = std::max(pieceStart, std::max(offset, pieceStart) / ChunkSize * ChunkSize);
+            const auto windowEnd   = std::min(pieceStart + pieceSize, (std::min(endOffset, pieceStart + pieceSize) + ChunkSize - 1) / ChunkSize * ChunkSize);
+
+            auto [left, rest]    = this->split(std::move(m_root), windowStart);
+            auto [zeros, right]  = this->split(std::move(rest), windowEnd - windowStart);
+
+            NodePtr window;
+            for (u64 chunkStart = windowStart; chunkStart < windowEnd; chunkStart = (chunkStart / ChunkSize + 1) * ChunkSize) {
+                const auto chunkEnd = std::min(windowEnd, (chunkStart / ChunkSize + 1) * ChunkSize);
+                auto chunk = std::make_shared<std::vector<u8>>(chunkEnd - chunkStart);
+
+                const auto copyStart = std::max(offset, chunkStart);
+                const auto copyEnd   = std::min(endOffset, chunkEnd);
+                if (copyStart < copyEnd)
+                    std::memcpy(chunk->data() + (copyStart - chunkStart), bytes + (copyStart - offset), copyEnd - copyStart);
+
+                window = merge(std::move(window), this->createNode({ std::move(chunk), 0, chunkEnd - chunkStart }));
+            }
+
+            m_root = merge(merge(std::move(left), std::move(window)), std::move(right));
+        }
+    }
+
+    void ChunkedBuffer::insert(u64 offset, u64 size) {
+        if (size == 0)
+            return;
+
+        offset = std::min(offset, this->getSize());
+
+        auto [left, right] = this->split(std::move(m_root), offset);
+        m_root = merge(merge(std::move(left), this->createNode({ nullptr, 0, size })), std::move(right));
+    }
+
+    void ChunkedBuffer::remove(u64 offset, u64 size) {
+        const auto totalSize = this->getSize();
+        if (size == 0 || offset >= totalSize)
+            return;
+
+        size = std::min(size, totalSize - offset);
+
+        auto [left, rest]     = this->split(std::move(m_root), offset);
+        auto [removed, right] = this->split(std::move(rest), size);
+
+        m_root = merge(std::move(left), std::move(right));
+    }
+
+    void ChunkedBuffer::resize(u64 newSize) {
+        const auto oldSize = this->getSize();
+
+        if (newSize > oldSize)
+            this->insert(oldSize, newSize - oldSize);
+        else if (newSize < oldSize)
+            this->remove(newSize, oldSize - newSize);
+    }
+
+    void ChunkedBuffer::clear() {
+        m_root.reset();
+    }
+
+    void ChunkedBuffer::append(std::vector<u8> data) {
+        if (data.empty())
+            return;
+
+        if (data.size() <= ChunkSize) {
+            const auto size = data.size();
+            m_root = merge(std::move(m_root), this->createNode({ std::make_shared<std::vector<u8>>(std::move(data)), 0, size }));
+            return;
+        }
+
+        for (u64 chunkStart = 0; chunkStart < data.size(); chunkStart += ChunkSize) {
+            const auto chunkSize = std::min<u64>(ChunkSize, data.size() - chunkStart);
+            auto chunk = std::make_shared<std::vector<u8>>(data.begin() + chunkStart, data.begin() + chunkStart + chunkSize);
+
+            m_root = merge(std::move(m_root), this->createNode({ std::move(chunk), 0, chunkSize }));
+        }
+    }
+
+    std::optional<std::span<const u8>> ChunkedBuffer::getSpan(u64 offset, size_t size) const {
+        if (size == 0 || offset + size > this->getSize())
+            return std::nullopt;
+
+        const Node *node = m_root.get();
+        u64 subtreeStart = 0;
+        while (node != nullptr) {
+            const auto pieceStart = subtreeStart + sizeOf(node->left);
+            const auto pieceEnd   = pieceStart + node->piece.size;
+
+            if (offset < pieceStart) {
+                node = node->left.get();
+            } else if (offset >= pieceEnd) {
+                node = node->right.get();
+                subtreeStart = pieceEnd;
+            } else {
+                if (node->piece.chunk == nullptr || offset + size > pieceEnd)
+                    return std::nullopt;
+
+                return std::span<const u8>(node->piece.chunk->data() + node->piece.offset + (offset - pieceStart), size);
+            }
+        }
+
+        return std::nullopt;
+    }
+
+}
@@ -20,6 +20,13 @@ namespace hex::prv {
         std::memcpy(buffer, &m_data.front() + offset, size);
     }
 
+    std::optional<std::span<const u8>> MemoryProvider::getRawSpan(u64 offset, size_t size) {
+        if ((offset + size) > this->getActualSize() || size == 0)
+            return std::nullopt;
+
+        return std::span(m_data).subspan(offset, size);
+    }
+
     void MemoryProvider::writeRaw(u64 offset, const void *buffer, size_t size) {
         if ((offset + size) > this->getActualSize() || buffer == nullptr || size == 0)
             return;
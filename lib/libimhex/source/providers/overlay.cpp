@@ -0,0 +1,26 @@
+#include <hex/providers/overlay.hpp>
+#include <hex/providers/provider.hpp>
+
+namespace hex::prv {
+
+    void Overlay::setAddress(u64 address) {
+        if (m_provider != nullptr)
+            m_provider->unindexOverlay(this);
+
+        m_address = address;
+
+        if (m_provider != nullptr)
+            m_provider->indexOverlay(this);
+    }
+
+    void Overlay::setData(std::vector<u8> data) {
+        if (m_provider != nullptr)
+            m_provider->unindexOverlay(this);
+
+        m_data = std::move(data);
+
+        if (m_provider != nullptr)
+            m_provider->indexOverlay(this);
+    }
+
+}
@@ -0,0 +1,253 @@
+#include <hex/providers/piece_table.hpp>
+
+#include <algorithm>
+#include <cstring>
+
+namespace hex::prv {
+
+    struct PieceTable::Node {
+        Piece piece;
+        u32 priority;
+        u64 subtreeSize;
+        u64 subtreeCount;
+
+        NodePtr left, right;
+    };
+
+    namespace {
+
+        u64 sizeOf(const auto &node) {
+            return node == nullptr ? 0 : node->subtreeSize;
+        }
+
+        u64 countOf(const auto &node) {
+            return node == nullptr ? 0 : node->subtreeCount;
+        }
+
+        void update(auto &node) {
+            node->subtreeSize  = node->piece.size + sizeOf(node->left) + sizeOf(node->right);
+            node->subtreeCount = 1 + countOf(node->left) + countOf(node->right);
+        }
+
+    }
+
+    PieceTable::PieceTable() = default;
+    PieceTable::PieceTable(u64 originalSize) {
+        this->reset(originalSize);
+    }
+
+    PieceTable::~PieceTable() = default;
+    PieceTable::PieceTable(PieceTable &&other) noexcept = default;
+    PieceTable& PieceTable::operator=(PieceTable &&other) noexcept = default;
+
+    void PieceTable::reset(u64 originalSize) {
+        m_root.reset();
+        m_buffer.clear();
+        m_buffer.shrink_to_fit();
+        m_originalSize = originalSize;
+
+        if (originalSize > 0)
+            m_root = this->createNode({ Source::Original, 0, originalSize });
+    }
+
+    u64 PieceTable::getSize() const {
+        return sizeOf(m_root);
+    }
+
+    bool PieceTable::isModified() const {
+        if (m_root == nullptr)
+            return m_originalSize != 0;
+
+        const auto &piece = m_root->piece;
+        return m_root->subtreeCount != 1 || piece.source != Source::Original || piece.offset != 0 || piece.size != m_originalSize;
+    }
+
+    size_t PieceTable::getPieceCount() const {
+        return countOf(m_root);
+    }
+
+    PieceTable::NodePtr PieceTable::createNode(const Piece &piece) {
+        // Xorshift is plenty for treap priorities and keeps the table deterministic
+        m_seed ^= m_seed << 13;
+        m_seed ^= m_seed >> 17;
+        m_seed ^= m_seed << 5;
+
+        auto node = std::make_unique<Node>();
+        node->piece    = piece;
+        node->priority = m_seed;
+        update(node);
+
+        return node;
+    }
+
+    std::pair<PieceTable::NodePtr, PieceTable::NodePtr> PieceTable::split(NodePtr &&node, u64 position) {
+        if (node == nullptr)
+            return { nullptr, nullptr };
+
+        const auto leftSize = sizeOf(node->left);
+        if (position <= leftSize) {
+            auto [left, right] = this->split(std::move(node->left), position);
+            node->left = std::move(right);
+            update(node);
+
+            return { std::move(left), std::move(node) };
+        } else if (position >= leftSize + node->piece.size) {
+            auto [left, right] = this->split(std::move(node->right), position - leftSize - node->piece.size);
+            node->right = std::move(left);
+            update(node);
+
+            return { std::move(node), std::move(right) };
+        } else {
+            // The split position lies inside of this node's piece, cut it in two
+            const auto innerOffset = position - leftSize;
+
+            auto &piece = node->piece;
+            auto tail = this->createNode({ piece.source, piece.source == Source::Zero ? 0 : piece.offset + innerOffset, piece.size - innerOffset });
+            piece.size = innerOffset;
+
+            auto right = merge(std::move(tail), std::move(node->right));
+            update(node);
+
+            return { std::move(node), std::move(right) };
+        }
+    }
+
+    PieceTable::NodePtr PieceTable::merge(NodePtr &&left, NodePtr &&right) {
+        if (left == nullptr)
+            return std::move(right);
+        if (right == nullptr)
+            return std::move(left);
+
+        if (left->priority > right->priority) {
+            left->right = merge(std::move(left->right), std::move(right));
+            update(left);
+
+            return std::move(left);
+        } else {
+            right->left = merge(std::move(left), std::move(right->left));
+            update(right);
+
+            return std::move(right);
+        }
+    }
+
+    void PieceTable::insert(u64 offset, u64 size) {
+        if (size == 0)
+            return;
+
+        offset = std::min(offset, this->getSize());
+
+        auto [left, right] = this->split(std::move(m_root), offset);
+        m_root = merge(merge(std::move(left), this->createNode({ Source::Zero, 0, size })), std::move(right));
+    }
+
+    void PieceTable::remove(u64 offset, u64 size) {
+        const auto totalSize = this->getSize();
+        if (size == 0 || offset >= totalSize)
+            return;
+
+        size = std::min(size, totalSize - offset);
+
+        auto [left, rest]     = this->split(std::move(m_root), offset);
+        auto [removed, right] = this->split(std::move(rest), size);
+
+        m_root = merge(std::move(left), std::move(right));
+    }
+
+    void PieceTable::resize(u64 newSize) {
+        const auto oldSize = this->getSize();
+
+        if (newSize > oldSize)
+            this->insert(oldSize, newSize - oldSize);
+        else if (newSize < oldSize)
+            this->remove(newSize, oldSize - newSize);
+    }
+
+    void PieceTable::forEach(u64 offset, u64 size, const std::function<void(u64, const Piece &)> &callback) const {
+        if (size == 0)
+            return;
+
+        const auto endOffset = offset + size;
+
+        auto visit = [&](auto &&self, const Node *node, u64 subtreeStart) -> void {
+            if (node == nullptr)
+                return;
+
+            const auto pieceStart = subtreeStart + sizeOf(node->left);
+            const auto pieceEnd   = pieceStart + node->piece.size;
+
+            if (offset < pieceStart)
+                self(self, node->left.get(), subtreeStart);
+
+            const auto overlapStart = std::max(offset, pieceStart);
+            const auto overlapEnd   = std::min(endOffset, pieceEnd);
+            if (overlapStart < overlapEnd) {
+                const auto &piece = node->piece;
+                const auto innerOffset = overlapStart - pieceStart;
+
+                callback(overlapStart, Piece { piece.source, piece.source == Source::Zero ? 0 : piece.offset + innerOffset, overlapEnd - overlapStart });
+            }
+
+            if (endOffset > pieceEnd)
+                self(self, node->right.get(), pieceEnd);
+        };
+
+        visit(visit, m_root.get(), 0);
+    }
+
+    void PieceTable::read(u64 offset, void *buffer, size_t size, const ReadCallback &readOriginal) const {
+        auto bytes = static_cast<u8*>(buffer);
+
+        this->forEach(offset, size, [&](u64 logicalOffset, const Piece &piece) {
+            auto destination = bytes + (logicalOffset - offset);
+
+            switch (piece.source) {
+                case Source::Original:
+                    readOriginal(piece.offset, destination, piece.size);
+                    break;
+                case Source::Buffer:
+                    std::memcpy(destination, m_buffer.data() + piece.offset, piece.size);
+                    break;
+                case Source::Zero:
+                    std::memset(destination, 0x00, piece.size);
+                    break;
+            }
+        });
+    }
+
+    void PieceTable::write(u64 offset, const void *buffer, size_t size, const WriteCallback &writeOriginal) {
+        auto bytes = static_cast<const u8*>(buffer);
+
+        // Pieces that haven't been written to yet don't have any storage, collect them so they can be
+        // replaced by newly allocated buffer pieces once we're done walking the tree
+        std::vector<std::pair<u64, u64>> unbackedRanges;
+
+        this->forEach(offset, size, [&](u64 logicalOffset, const Piece &piece) {
+            auto source = bytes + (logicalOffset - offset);
+
+            switch (piece.source) {
+                case Source::Original:
+                    writeOriginal(piece.offset, source, piece.size);
+                    break;
+                case Source::Buffer:
+                    std::memcpy(m_buffer.data() + piece.offset, source, piece.size);
+                    break;
+                case Source::Zero:
+                    unbackedRanges.emplace_back(logicalOffset, piece.size);
+                    break;
+            }
+        });
+
+        for (const auto &[logicalOffset, rangeSize] : unbackedRanges) {
+            const auto bufferOffset = m_buffer.size();
+            auto source = bytes + (logicalOffset - offset);
+            m_buffer.insert(m_buffer.end(), source, source + rangeSize);
+
+            auto [left, rest]     = this->split(std::move(m_root), logicalOffset);
+            auto [zeroes, right]  = this->split(std::move(rest), rangeSize);
+
+            m_root = merge(merge(std::move(left), this->createNode({ Source::Buffer, bufferOffset, rangeSize })), std::move(right));
+        }
+    }
+
+}
@@ -0,0 +1,184 @@
+#include <hex/providers/process_memory.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+#if defined(OS_WINDOWS)
+    #include <windows.h>
+#elif defined(OS_LINUX)
+    #include <sys/uio.h>
+    #include <climits>
+#endif
+
+namespace hex::prv {
+
+    #if defined(OS_WINDOWS) || defined(OS_LINUX)
+
+        bool readProcessMemory(NativeProcess process, std::span<const Region> mappedRanges, std::span<const Provider::ReadRequest> requests, bool *hitHole) {
+            struct Transfer {
+                u8 *buffer;
+                u64 address;
+                size_t size;
+            };
+
+            // Split the requests into transfers that only cover mapped memory. Unmapped holes read as zeros
+            std::vector<Transfer> transfers;
+            for (const auto &request : requests) {
+                auto bytes = static_cast<u8 *>(request.buffer);
+
+                // Without any known regions, just try to read everything that was requested
+                if (mappedRanges.empty()) {
+                    transfers.push_back({ bytes, request.address, request.size });
+                    continue;
+                }
+
+                const u64 endAddress = request.address + request.size;
+                u64 address = request.address;
+
+                auto it = std::ranges::upper_bound(mappedRanges, address, { }, &Region::address);
+                if (it != mappedRanges.begin() && std::prev(it)->getEndAddress() >= address)
+                    --it;
+
+                while (address < endAddress) {
+                    if (it == mappedRanges.end() || it->getStartAddress() >= endAddress) {
+                        std::memset(bytes + (address - request.address), 0x00, endAddress - address);
+                        if (hitHole != nullptr)
+                            *hitHole = true;
+                        break;
+                    }
+
+                    if (it->getStartAddress() > address) {
+                        std::memset(bytes + (address - request.address), 0x00, it->getStartAddress() - address);
+                        address = it->getStartAddress();
+                        if (hitHole != nullptr)
+                            *hitHole = true;
+                    }
+
+                    const auto transferEnd = std::min<u64>(endAddress, it->getStartAddress() + it->getSize());
+                    transfers.push_back({ bytes + (address - request.address), address, size_t(transferEnd - address) });
+
+                    address = transferEnd;
+                    ++it;
+                }
+            }
+
+            bool success = true;
+
+            #if defined(OS_WINDOWS)
+                for (const auto &transfer : transfers) {
+                    SIZE_T bytesRead = 0;
+                    if (ReadProcessMemory(HANDLE(process), reinterpret_cast<LPCVOID>(transfer.address), transfer.buffer, transfer.size, &bytesRead) == FALSE || bytesRead != transfer.size) {
+                        std::memset(transfer.buffer + bytesRead, 0x00, transfer.size - bytesRead);
+                        success = false;
+                    }
+                }
+            #elif defined(OS_LINUX)
+                std::vector<iovec> localVectors, remoteVectors;
+                localVectors.reserve(transfers.size());
+                remoteVectors.reserve(transfers.size());
+                for (const auto &transfer : transfers) {
+                    localVectors.push_back({ .iov_base = transfer.buffer, .iov_len = transfer.size });
+                    remoteVectors.push_back({ .iov_base = reinterpret_cast<void*>(transfer.address), .iov_len = transfer.size });
+                }
+
+                // Move as many transfers as possible with a single syscall
+                for (size_t index = 0; index < localVectors.size();) {
+                    const auto count    = std::min<size_t>(localVectors.size() - index, IOV_MAX);
+                    const auto batchEnd = index + count;
+
+                    const auto result = process_vm_readv(process, &localVectors[index], count, &remoteVectors[index], count, 0);
+                    size_t bytesRead = result < 0 ? 0 : size_t(result);
+
+                    while (index < batchEnd && bytesRead >= localVectors[index].iov_len) {
+                        bytesRead -= localVectors[index].iov_len;
+                        index += 1;
+                    }
+
+                    // The transfer stopped at a vector that couldn't be read. Clear what's left of it and continue after it
+                    if (index < batchEnd) {
+                        const auto &vector = localVectors[index];
+                        std::memset(static_cast<u8 *>(vector.iov_base) + bytesRead, 0x00, vector.iov_len - bytesRead);
+
+                        success = false;
+                        index += 1;
+                    }
+                }
+            #endif
+
+            return success;
+        }
+
+    #endif
+
+    SparseMemoryCapture::SparseMemoryCapture(const std::vector<Region> &regions, size_t workSize, size_t pageSize, ReadFunction readFunction)
+        : m_workSize(workSize), m_pageSize(pageSize), m_readFunction(std::move(readFunction)) {
+
+        for (const auto &region : regions) {
+            for (u64 offset = 0; offset < region.getSize(); offset += m_workSize)
+                m_workItems.push_back({ region.getStartAddress() + offset, std::min<u64>(m_workSize, region.getSize() - offset) });
+
+            m_totalSize += region.getSize();
+        }
+    }
+
+    void SparseMemoryCapture::work(const std::function<void()> &progressCallback) {
+        std::vector<u8> buffer;
+
+        while (true) {
+            // Announce the worker before checking for cancellation. Either cancel() sees it and waits for it, or it sees the cancellation
+            m_activeWorkers += 1;
+            if (m_cancelled) {
+                this->finishWork();
+                break;
+            }
+
+            const auto index = m_nextWorkItem.fetch_add(1);
+            if (index >= m_workItems.size()) {
+                this->finishWork();
+                break;
+            }
+
+            const auto &workItem = m_workItems[index];
+            buffer.resize(workItem.getSize());
+
+            const Provider::ReadRequest request = { workItem.getStartAddress(), workItem.getSize(), buffer.data() };
+            m_readFunction({ &request, 1 });
+
+            // Only keep runs of pages that contain data, most of a process' memory is usually zero
+            auto chunks = SparseMemoryProvider::getNonZeroRuns(workItem.getStartAddress(), buffer, m_pageSize);
+
+            {
+                std::scoped_lock lock(m_mutex);
+                for (auto &[address, data] : chunks)
+                    m_chunks.emplace(address, std::move(data));
+            }
+
+            m_bytesProcessed += workItem.getSize();
+            this->finishWork();
+
+            if (progressCallback)
+                progressCallback();
+        }
+    }
+
+    void SparseMemoryCapture::finishWork() {
+        {
+            std::scoped_lock lock(m_mutex);
+            m_activeWorkers -= 1;
+        }
+
+        m_workerFinished.notify_all();
+    }
+
+    void SparseMemoryCapture::waitForWorkers(const std::function<void()> &tick) {
+        std::unique_lock lock(m_mutex);
+        while (m_activeWorkers > 0) {
+            m_workerFinished.wait_for(lock, std::chrono::milliseconds(100));
+
+            if (tick)
+                tick();
+        }
+    }
+
+}
@@ -3,6 +3,7 @@
 #include <hex.hpp>
 #include <hex/api/event_manager.hpp>
 
+#include <algorithm>
 #include <cmath>
 #include <cstring>
 #include <optional>
@@ -29,6 +30,7 @@ namespace hex::prv {
     }
 
     Provider::~Provider() {
+        m_overlayIndex.clear();
         m_overlays.clear();
 
         if (auto selection = ImHexApi::HexEditor::getSelection(); selection.has_value() && selection->provider == this)
@@ -36,17 +38,135 @@ namespace hex::prv {
     }
 
     void Provider::read(u64 offset, void *buffer, size_t size, bool overlays) {
+        std::shared_lock lock(m_dataMutex);
+
         this->readRaw(offset - this->getBaseAddress(), buffer, size);
 
         if (overlays)
             this->applyOverlays(offset, buffer, size);
     }
 
+    void Provider::readv(std::span<const ReadRequest> requests, bool overlays) {
+        std::vector<const ReadRequest*> sortedRequests;
+        sortedRequests.reserve(requests.size());
+        for (const auto &request : requests) {
+            if (request.size > 0 && request.buffer != nullptr)
+                sortedRequests.push_back(&request);
+        }
+
+        if (sortedRequests.empty())
+            return;
+
+        std::sort(sortedRequests.begin(), sortedRequests.end(), [](const auto &left, const auto &right) {
+            return left->address < right->address;
+        });
+
+        // Merge adjacent and overlapping requests into larger ranges
+        struct MergedRange {
+            u64 address;
+            u64 size;
+            size_t firstRequest, lastRequest;
+            u64 scratchOffset;
+        };
+
+        std::vector<MergedRange> ranges;
+        u64 scratchSize = 0;
+        for (size_t i = 0; i < sortedRequests.size(); i += 1) {
+            const auto &request = *sortedRequests[i];
+
+            if (!ranges.empty() && request.address <= ranges.back().address + ranges.back().size) {
+                auto &range = ranges.back();
+                range.size = std::max<u64>(range.size, request.address + request.size - range.address);
+                range.lastRequest = i;
+            } else {
+                ranges.push_back({ request.address, request.size, i, i, 0 });
+            }
+        }
+
+        // Ranges made up of a single request are read straight into the request's buffer,
+        // all others are read into a shared scratch buffer and distributed afterwards
+        for (auto &range : ranges) {
+            if (range.firstRequest != range.lastRequest) {
+                range.scratchOffset = scratchSize;
+                scratchSize += range.size;
+            }
+        }
+
+        std::vector<u8> scratchBuffer(scratchSize);
+        const auto getRangeBuffer = [&](const MergedRange &range) -> u8* {
+            if (range.firstRequest == range.lastRequest)
+                return static_cast<u8*>(sortedRequests[range.firstRequest]->buffer);
+            else
+                return scratchBuffer.data() + range.scratchOffset;
+        };
+
+        std::vector<ReadRequest> rawRequests;
+        rawRequests.reserve(ranges.size());
+        for (const auto &range : ranges)
+            rawRequests.push_back({ range.address - this->getBaseAddress(), range.size, getRangeBuffer(range) });
+
+        std::shared_lock lock(m_dataMutex);
+        this->readRawv(rawRequests);
+
+        for (const auto &range : ranges) {
+            auto rangeBuffer = getRangeBuffer(range);
+
+            if (overlays)
+                this->applyOverlays(range.address, rangeBuffer, range.size);
+
+            if (range.firstRequest != range.lastRequest) {
+                for (size_t i = range.firstRequest; i <= range.lastRequest; i += 1) {
+                    const auto &request = *sortedRequests[i];
+                    std::memcpy(request.buffer, rangeBuffer + (request.address - range.address), request.size);
+                }
+            }
+        }
+    }
+
+    void Provider::readRawv(std::span<const ReadRequest> requests) {
+        for (const auto &request : requests)
+            this->readRaw(request.address, request.buffer, request.size);
+    }
+
+    DataSpan Provider::readSpan(u64 offset, size_t size, std::vector<u8> &fallbackBuffer) {
+        if (size == 0)
+            return { };
+
+        {
+            std::shared_lock lock(m_dataMutex);
+
+            // Hand the lock over to the returned view, the span is only valid as long as nobody can write to the provider
+            if (!this->hasOverlays(offset, size)) {
+                if (auto span = this->getRawSpan(offset - this->getBaseAddress(), size); span.has_value() && span->size() == size)
+                    return { *span, std::move(lock) };
+            }
+        }
+
+        fallbackBuffer.resize(size);
+        this->read(offset, fallbackBuffer.data(), size);
+
+        return { fallbackBuffer };
+    }
+
+    std::optional<std::span<const u8>> Provider::getRawSpan(u64 offset, size_t size) {
+        hex::unused(offset, size);
+
+        return std::nullopt;
+    }
+
     void Provider::write(u64 offset, const void *buffer, size_t size) {
         EventProviderDataModified::post(this, offset, size, static_cast<const u8*>(buffer));
         this->markDirty();
     }
 
+    void Provider::write(const WriteBatch &batch) {
+        if (batch.empty())
+            return;
+
+        EventProviderDataBatchModified::post(this, batch);
+        this->markDirty();
+    }
+
     void Provider::save() {
         EventProviderSaved::post(this);
     }
@@ -91,28 +211,240 @@ namespace hex::prv {
         this->markDirty();
     }
 
+    void Provider::applyWrite(u64 offset, const void *buffer, size_t size) {
+        const WriteRequest request = { offset, size, buffer };
+        this->applyWrites({ &request, 1 });
+    }
+
+    void Provider::applyWrites(std::span<const WriteRequest> requests) {
+        std::unique_lock lock(m_dataMutex);
+
+        const auto generation = m_generation + 1;
+        for (const auto &request : requests) {
+            // Keep the data that's about to be overwritten around for all snapshots that were taken before this write
+            if (!m_snapshotGenerations.empty() && request.size > 0) {
+                Preimage preimage = { generation, request.address, std::vector<u8>(request.size) };
+                this->readRaw(request.address, preimage.data.data(), preimage.data.size());
+
+                m_preimages.emplace_back(std::move(preimage));
+            }
+
+            this->writeRaw(request.address, request.buffer, request.size);
+
+            m_journal.push_back({ generation, request.address, request.size });
+        }
+
+        m_generation = generation;
+
+        while (m_journal.size() > MaxJournalEntries) {
+            m_journalStartGeneration = m_journal.front().generation;
+            m_journal.pop_front();
+        }
+    }
+
+    void Provider::applyResize(u64 newSize) {
+        std::unique_lock lock(m_dataMutex);
+
+        this->resizeRaw(newSize);
+        m_structureGeneration = ++m_generation;
+    }
+
+    void Provider::applyInsert(u64 offset, u64 size) {
+        std::unique_lock lock(m_dataMutex);
+
+        this->insertRaw(offset, size);
+        m_structureGeneration = ++m_generation;
+    }
+
+    void Provider::applyRemove(u64 offset, u64 size) {
+        std::unique_lock lock(m_dataMutex);
+
+        this->removeRaw(offset, size);
+        m_structureGeneration = ++m_generation;
+    }
+
+    std::optional<std::vector<Region>> Provider::getModifiedRegions(u64 generation) const {
+        std::shared_lock lock(m_dataMutex);
+
+        // Insertions and removals shift data around, there's no way to describe what changed with regions anymore
+        if (generation < m_structureGeneration || generation < m_journalStartGeneration)
+            return std::nullopt;
+
+        std::vector<Region> regions;
+        for (auto it = m_journal.rbegin(); it != m_journal.rend() && it->generation > generation; ++it) {
+            if (it->size > 0)
+                regions.push_back({ this->getBaseAddress() + it->offset, it->size });
+        }
+
+        std::sort(regions.begin(), regions.end(), [](const Region &left, const Region &right) {
+            return left.getStartAddress() < right.getStartAddress();
+        });
+
+        // Merge overlapping and adjacent regions
+        std::vector<Region> result;
+        for (const auto &region : regions) {
+            if (!result.empty() && region.getStartAddress() <= result.back().getEndAddress() + 1)
+                result.back().size = std::max(result.back().getEndAddress(), region.getEndAddress()) - result.back().getStartAddress() + 1;
+            else
+                result.push_back(region);
+        }
+
+        return result;
+    }
+
+    Snapshot Provider::createSnapshot() {
+        std::unique_lock lock(m_dataMutex);
+
+        m_snapshotGenerations.insert(m_generation);
+
+        return Snapshot(std::make_shared<const Snapshot::State>(this, m_generation));
+    }
+
+    void Provider::beginSequentialAccess() {
+        std::scoped_lock lock(m_sequentialAccessMutex);
+
+        m_sequentialAccessCount += 1;
+        if (m_sequentialAccessCount == 1)
+            this->setSequentialAccessHint(true);
+    }
+
+    void Provider::endSequentialAccess() {
+        std::scoped_lock lock(m_sequentialAccessMutex);
+
+        if (m_sequentialAccessCount == 0)
+            return;
+
+        m_sequentialAccessCount -= 1;
+        if (m_sequentialAccessCount == 0)
+            this->setSequentialAccessHint(false);
+    }
+
+    bool Provider::readSnapshot(u64 generation, u64 offset, void *buffer, size_t size, bool overlays) {
+        std::shared_lock lock(m_dataMutex);
+
+        // Inserted or removed data shifted everything around, the preimages can't restore the old layout
+        if (m_structureGeneration > generation) {
+            std::memset(buffer, 0x00, size);
+            return false;
+        }
+
+        const auto rawOffset = offset - this->getBaseAddress();
+        this->readRaw(rawOffset, buffer, size);
+
+        // Undo all writes that happened after the snapshot was taken. Going from newest to oldest leaves
+        // the data from before the first of these writes in the buffer
+        for (auto it = m_preimages.rbegin(); it != m_preimages.rend() && it->generation > generation; ++it) {
+            const auto overlapMin = std::max<u64>(rawOffset, it->offset);
+            const auto overlapMax = std::min<u64>(rawOffset + size, it->offset + it->data.size());
+
+            if (overlapMin < overlapMax)
+                std::memcpy(static_cast<u8 *>(buffer) + (overlapMin - rawOffset), it->data.data() + (overlapMin - it->offset), overlapMax - overlapMin);
+        }
+
+        if (overlays)
+            this->applyOverlays(offset, buffer, size);
+
+        return true;
+    }
+
+    DataSpan Provider::readSnapshotSpan(u64 generation, u64 offset, size_t size, std::vector<u8> &fallbackBuffer, bool overlays) {
+        if (size == 0)
+            return { };
+
+        {
+            std::shared_lock lock(m_dataMutex);
+            if (m_structureGeneration > generation)
+                return { };
+
+            // The backing store only matches the snapshot as long as no write since it was taken touched the range
+            const auto rawOffset = offset - this->getBaseAddress();
+            bool modified = false;
+            for (auto it = m_preimages.rbegin(); it != m_preimages.rend() && it->generation > generation; ++it) {
+                if (it->offset < rawOffset + size && rawOffset < it->offset + it->data.size()) {
+                    modified = true;
+                    break;
+                }
+            }
+
+            if (!modified && !(overlays && this->hasOverlays(offset, size))) {
+                if (auto span = this->getRawSpan(rawOffset, size); span.has_value() && span->size() == size)
+                    return { *span, std::move(lock) };
+            }
+        }
+
+        fallbackBuffer.resize(size);
+        if (!this->readSnapshot(generation, offset, fallbackBuffer.data(), size, overlays))
+            return { };
+
+        return { fallbackBuffer };
+    }
+
+    void Provider::releaseSnapshot(u64 generation) {
+        std::unique_lock lock(m_dataMutex);
+
+        if (auto it = m_snapshotGenerations.find(generation); it != m_snapshotGenerations.end())
+            m_snapshotGenerations.erase(it);
+
+        // Drop all preimages that no remaining snapshot needs anymore
+        const auto oldestGeneration = m_snapshotGenerations.empty() ? m_generation.load() : *m_snapshotGenerations.begin();
+        while (!m_preimages.empty() && m_preimages.front().generation <= oldestGeneration)
+            m_preimages.pop_front();
+    }
+
     void Provider::applyOverlays(u64 offset, void *buffer, size_t size) const {
-        for (auto &overlay : m_overlays) {
-            auto overlayOffset = overlay->getAddress();
-            auto overlaySize   = overlay->getSize();
-
-            i128 overlapMin = std::max(offset, overlayOffset);
-            i128 overlapMax = std::min(offset + size, overlayOffset + overlaySize);
-            if (overlapMax > overlapMin)
-                std::memcpy(static_cast<u8 *>(buffer) + std::max<i128>(0, overlapMin - offset), overlay->getData().data() + std::max<i128>(0, overlapMin - overlayOffset), overlapMax - overlapMin);
+        if (m_overlayIndex.empty())
+            return;
+
+        // Overlays created later take precedence over older ones, apply them in the order they were created in
+        std::vector<const Overlay*> overlays;
+        m_overlayIndex.forEachOverlapping(offset, offset + size, [&](u64, u64, u64, const Overlay *overlay) {
+            overlays.push_back(overlay);
+        });
+
+        if (overlays.empty())
+            return;
+
+        std::sort(overlays.begin(), overlays.end(), [](const Overlay *left, const Overlay *right) {
+            return left->m_order < right->m_order;
+        });
+
+        for (const auto overlay : overlays) {
+            const auto overlayOffset = overlay->getAddress();
+
+            const auto overlapMin = std::max<u64>(offset, overlayOffset);
+            const auto overlapMax = std::min<u64>(offset + size, overlayOffset + overlay->getSize());
+            std::memcpy(static_cast<u8 *>(buffer) + (overlapMin - offset), overlay->getData().data() + (overlapMin - overlayOffset), overlapMax - overlapMin);
         }
     }
 
+    bool Provider::hasOverlays(u64 offset, size_t size) const {
+        return m_overlayIndex.overlaps(offset, offset + size);
+    }
+
     Overlay *Provider::newOverlay() {
-        return m_overlays.emplace_back(std::make_unique<Overlay>()).get();
+        auto overlay = m_overlays.emplace_back(std::make_unique<Overlay>()).get();
+        overlay->m_provider = this;
+        overlay->m_order    = m_overlayCounter++;
+
+        return overlay;
     }
 
     void Provider::deleteOverlay(Overlay *overlay) {
+        this->unindexOverlay(overlay);
+
         m_overlays.remove_if([overlay](const auto &item) {
             return item.get() == overlay;
         });
     }
 
+    void Provider::indexOverlay(Overlay *overlay) {
+        m_overlayIndex.insert(overlay->getAddress(), overlay->getAddress() + overlay->getSize(), overlay->m_order, overlay);
+    }
+
+    void Provider::unindexOverlay(Overlay *overlay) {
+        m_overlayIndex.erase(overlay->getAddress(), overlay->m_order);
+    }
+
     const std::list<std::unique_ptr<Overlay>> &Provider::getOverlays() const {
         return m_overlays;
     }
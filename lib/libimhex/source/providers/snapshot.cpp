@@ -0,0 +1,43 @@
+#include <hex/providers/snapshot.hpp>
+
+#include <hex/providers/provider.hpp>
+
+namespace hex::prv {
+
+    Snapshot::State::~State() {
+        Snapshot::release(this->provider, this->generation);
+    }
+
+    void Snapshot::release(Provider *provider, u64 generation) {
+        provider->releaseSnapshot(generation);
+    }
+
+    bool Snapshot::read(u64 address, void *buffer, size_t size, bool overlays) const {
+        if (m_state == nullptr)
+            return false;
+        if (size == 0)
+            return true;
+
+        return m_state->provider->readSnapshot(m_state->generation, address, buffer, size, overlays);
+    }
+
+    DataSpan Snapshot::readSpan(u64 address, size_t size, std::vector<u8> &fallbackBuffer, bool overlays) const {
+        if (m_state == nullptr || size == 0)
+            return { };
+
+        return m_state->provider->readSnapshotSpan(m_state->generation, address, size, fallbackBuffer, overlays);
+    }
+
+    Provider* Snapshot::getProvider() const {
+        return m_state == nullptr ? nullptr : m_state->provider;
+    }
+
+    u64 Snapshot::getGeneration() const {
+        return m_state == nullptr ? 0 : m_state->generation;
+    }
+
+    bool Snapshot::isStale() const {
+        return m_state != nullptr && m_state->provider->m_structureGeneration > m_state->generation;
+    }
+
+}
@@ -0,0 +1,110 @@
+#include <hex/providers/sparse_memory_provider.hpp>
+
+#include <hex/helpers/utils.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <optional>
+
+namespace hex::prv {
+
+    bool SparseMemoryProvider::open() {
+        return !m_regions.empty();
+    }
+
+    void SparseMemoryProvider::readRaw(u64 offset, void *buffer, size_t size) {
+        if (buffer == nullptr || size == 0)
+            return;
+
+        auto bytes = static_cast<u8 *>(buffer);
+        std::memset(bytes, 0x00, size);
+
+        const u64 endAddress = offset + size;
+
+        auto it = m_chunks.upper_bound(offset);
+        if (it != m_chunks.begin())
+            --it;
+
+        for (; it != m_chunks.end() && it->first < endAddress; ++it) {
+            const auto &[chunkAddress, data] = *it;
+
+            const auto copyStart = std::max<u64>(offset, chunkAddress);
+            const auto copyEnd   = std::min<u64>(endAddress, chunkAddress + data.size());
+            if (copyStart >= copyEnd)
+                continue;
+
+            std::memcpy(bytes + (copyStart - offset), data.data() + (copyStart - chunkAddress), copyEnd - copyStart);
+        }
+    }
+
+    void SparseMemoryProvider::writeRaw(u64 offset, const void *buffer, size_t size) {
+        hex::unused(offset, buffer, size);
+    }
+
+    std::optional<std::span<const u8>> SparseMemoryProvider::getRawSpan(u64 offset, size_t size) {
+        if (size == 0)
+            return std::nullopt;
+
+        auto it = m_chunks.upper_bound(offset);
+        if (it == m_chunks.begin())
+            return std::nullopt;
+        --it;
+
+        const auto &[chunkAddress, data] = *it;
+        if (offset + size > chunkAddress + data.size())
+            return std::nullopt;
+
+        return std::span(data).subspan(offset - chunkAddress, size);
+    }
+
+    u64 SparseMemoryProvider::getActualSize() const {
+        if (m_regions.empty())
+            return 0;
+
+        return m_regions.back().getEndAddress() + 1;
+    }
+
+    std::pair<Region, bool> SparseMemoryProvider::getRegionValidity(u64 address) const {
+        auto it = std::ranges::upper_bound(m_regions, address, { }, &Region::address);
+        if (it != m_regions.begin() && std::prev(it)->getEndAddress() >= address)
+            return { *std::prev(it), true };
+
+        const u64 holeStart = it == m_regions.begin() ? 0 : std::prev(it)->getEndAddress() + 1;
+        if (it == m_regions.end())
+            return { Region::Invalid(), false };
+
+        return { Region { holeStart, it->getStartAddress() - holeStart }, false };
+    }
+
+    void SparseMemoryProvider::setData(std::vector<Region> regions, Chunks chunks) {
+        m_regions = std::move(regions);
+        m_chunks  = std::move(chunks);
+    }
+
+    std::vector<std::pair<u64, std::vector<u8>>> SparseMemoryProvider::getNonZeroRuns(u64 address, std::span<const u8> data, size_t pageSize) {
+        std::vector<std::pair<u64, std::vector<u8>>> result;
+        if (pageSize == 0)
+            return result;
+
+        std::optional<u64> runStart;
+        for (u64 offset = 0; offset < data.size(); offset += pageSize) {
+            const auto page = data.subspan(offset, std::min<u64>(pageSize, data.size() - offset));
+
+            // A page is all zeros if its first byte is zero and every byte matches the one before it
+            const bool isZero = page[0] == 0x00 && std::memcmp(page.data(), page.data() + 1, page.size() - 1) == 0;
+
+            if (!isZero && !runStart.has_value()) {
+                runStart = offset;
+            } else if (isZero && runStart.has_value()) {
+                result.emplace_back(address + *runStart, std::vector<u8>(data.begin() + *runStart, data.begin() + offset));
+                runStart.reset();
+            }
+        }
+
+        if (runStart.has_value())
+            result.emplace_back(address + *runStart, std::vector<u8>(data.begin() + *runStart, data.end()));
+
+        return result;
+    }
+
+}
@@ -0,0 +1,266 @@
+#include <hex/providers/undo_redo/modification_data.hpp>
+
+#include <hex/helpers/fmt.hpp>
+#include <hex/helpers/logger.hpp>
+
+#include <wolv/io/file.hpp>
+#include <wolv/utils/string.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <random>
+
+namespace hex::prv::undo {
+
+    namespace impl {
+
+        /**
+         * @brief Append-only temporary file that holds the data of spilled operations
+         * @note The file is deleted once the last operation referencing it is gone
+         */
+        class SpillFile {
+        public:
+            explicit SpillFile(const std::fs::path &path) : m_path(path), m_file(path, wolv::io::File::Mode::Create) { }
+
+            ~SpillFile() {
+                m_file.close();
+
+                std::error_code errorCode;
+                std::fs::remove(m_path, errorCode);
+            }
+
+            SpillFile(const SpillFile &) = delete;
+            SpillFile& operator=(const SpillFile &) = delete;
+
+            [[nodiscard]] bool isValid() const { return m_file.isValid(); }
+
+            std::optional<u64> append(std::span<const u8> first, std::span<const u8> second) {
+                std::scoped_lock lock(m_mutex);
+
+                const auto offset = m_size;
+                m_file.seek(offset);
+                for (const auto &data : { first, second }) {
+                    if (!data.empty())
+                        m_file.writeBuffer(data.data(), data.size());
+                }
+
+                if (std::ferror(m_file.getHandle()) != 0)
+                    return std::nullopt;
+
+                m_size += first.size() + second.size();
+
+                return offset;
+            }
+
+            void read(u64 offset, std::span<u8> buffer) {
+                std::scoped_lock lock(m_mutex);
+
+                if (buffer.empty())
+                    return;
+
+                m_file.seek(offset);
+                m_file.readBuffer(buffer.data(), buffer.size());
+            }
+
+            /**
+             * @brief Gets the spill file new data should be appended to, creating it if necessary
+             */
+            static std::shared_ptr<SpillFile> get() {
+                static std::mutex mutex;
+                static std::weak_ptr<SpillFile> currentFile;
+
+                std::scoped_lock lock(mutex);
+                if (auto file = currentFile.lock(); file != nullptr)
+                    return file;
+
+                std::error_code errorCode;
+                auto directory = std::fs::temp_directory_path(errorCode);
+                if (errorCode)
+                    return nullptr;
+
+                auto file = std::make_shared<SpillFile>(directory / hex::format("imhex-undo-{:016X}.tmp", std::random_device()() | (u64(std::random_device()()) << 32)));
+                if (!file->isValid()) {
+                    log::warn("Failed to create undo spill file in {}", wolv::util::toUTF8String(directory));
+                    return nullptr;
+                }
+
+                currentFile = file;
+
+                return file;
+            }
+
+        private:
+            std::fs::path m_path;
+            wolv::io::File m_file;
+            u64 m_size = 0;
+            std::mutex m_mutex;
+        };
+
+    }
+
+    namespace {
+
+        constexpr size_t MaxLiteralLength = 0x80;
+        constexpr size_t MinRepeatLength  = 3;
+        constexpr size_t MaxRepeatLength  = 0x7F + MinRepeatLength;
+
+        // Simple run-length encoding. A control byte with the highest bit cleared is followed by (n + 1) literal bytes,
+        // one with the highest bit set is followed by a single byte that is repeated ((n & 0x7F) + 3) times
+        std::vector<u8> encode(std::span<const u8> data) {
+            std::vector<u8> result;
+            result.reserve(data.size() / 8);
+
+            size_t i = 0;
+            while (i < data.size()) {
+                size_t runEnd = i + 1;
+                while (runEnd < data.size() && data[runEnd] == data[i] && runEnd - i < MaxRepeatLength)
+                    runEnd += 1;
+
+                if (runEnd - i >= MinRepeatLength) {
+                    result.push_back(0x80 | u8((runEnd - i) - MinRepeatLength));
+                    result.push_back(data[i]);
+                    i = runEnd;
+                    continue;
+                }
+
+                // Collect literal bytes until the next repeating run starts
+                const auto literalStart = i;
+                while (i < data.size() && i - literalStart < MaxLiteralLength) {
+                    if (i + 2 < data.size() && data[i] == data[i + 1] && data[i] == data[i + 2])
+                        break;
+                    i += 1;
+                }
+
+                result.push_back(u8((i - literalStart) - 1));
+                result.insert(result.end(), data.begin() + literalStart, data.begin() + i);
+            }
+
+            result.shrink_to_fit();
+
+            return result;
+        }
+
+        std::vector<u8> decode(std::span<const u8> data, size_t size) {
+            std::vector<u8> result;
+            result.reserve(size);
+
+            size_t i = 0;
+            while (i < data.size()) {
+                const auto control = data[i];
+                i += 1;
+
+                if ((control & 0x80) == 0x00) {
+                    const size_t length = std::min<size_t>(control + 1, data.size() - i);
+                    result.insert(result.end(), data.begin() + i, data.begin() + i + length);
+                    i += length;
+                } else if (i < data.size()) {
+                    result.insert(result.end(), (control & 0x7F) + MinRepeatLength, data[i]);
+                    i += 1;
+                }
+            }
+
+            result.resize(size);
+
+            return result;
+        }
+
+        void xorInto(std::vector<u8> &target, std::span<const u8> other) {
+            for (size_t i = 0; i < std::min(target.size(), other.size()); i += 1)
+                target[i] ^= other[i];
+        }
+
+    }
+
+    ModificationData::ModificationData(std::vector<u8> oldData, std::vector<u8> newData) : m_size(newData.size()), m_first(std::move(oldData)), m_second(std::move(newData)) {
+        m_first.resize(m_size);
+    }
+
+    ModificationData::ModificationData(std::vector<u8> oldData) : m_size(oldData.size()), m_hasNewData(false), m_first(std::move(oldData)) {
+
+    }
+
+    std::vector<u8> ModificationData::getOldData() const {
+        if (m_state == State::Plain)
+            return m_first;
+
+        std::vector<u8> result;
+        this->visitEncoded([&](std::span<const u8> encodedData, std::span<const u8> encodedDelta) {
+            result = decode(encodedDelta, m_size);
+            xorInto(result, decode(encodedData, m_size));
+        });
+
+        return result;
+    }
+
+    std::vector<u8> ModificationData::getNewData() const {
+        if (!m_hasNewData)
+            return { };
+        if (m_state == State::Plain)
+            return m_second;
+
+        std::vector<u8> result;
+        this->visitEncoded([&](std::span<const u8> encodedData, std::span<const u8>) {
+            result = decode(encodedData, m_size);
+        });
+
+        return result;
+    }
+
+    size_t ModificationData::getMemoryUsage() const {
+        return m_first.capacity() + m_second.capacity();
+    }
+
+    void ModificationData::compress() {
+        if (m_state != State::Plain)
+            return;
+
+        auto delta = std::move(m_first);
+        xorInto(delta, m_second);
+
+        m_first  = encode(m_second);
+        m_second = encode(delta);
+        m_state  = State::Compressed;
+    }
+
+    bool ModificationData::spill() {
+        this->compress();
+
+        if (m_state == State::Spilled)
+            return true;
+
+        auto spillFile = impl::SpillFile::get();
+        if (spillFile == nullptr)
+            return false;
+
+        auto offset = spillFile->append(m_first, m_second);
+        if (!offset.has_value())
+            return false;
+
+        m_spillFile   = std::move(spillFile);
+        m_spillOffset = *offset;
+        m_firstSize   = m_first.size();
+        m_secondSize  = m_second.size();
+
+        m_first  = std::vector<u8>();
+        m_second = std::vector<u8>();
+        m_state  = State::Spilled;
+
+        return true;
+    }
+
+    void ModificationData::visitEncoded(const std::function<void(std::span<const u8>, std::span<const u8>)> &callback) const {
+        if (m_state == State::Compressed) {
+            callback(m_first, m_second);
+        } else if (m_state == State::Spilled) {
+            std::vector<u8> encodedData(m_firstSize), encodedDelta(m_secondSize);
+            m_spillFile->read(m_spillOffset, encodedData);
+            m_spillFile->read(m_spillOffset + m_firstSize, encodedDelta);
+
+            callback(encodedData, encodedDelta);
+        }
+    }
+
+}
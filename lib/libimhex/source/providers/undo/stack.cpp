@@ -3,16 +3,39 @@
 
 #include <hex/providers/provider.hpp>
 
-#include <wolv/utils/guards.hpp>
-
+#include <algorithm>
 #include <atomic>
 
 namespace hex::prv::undo {
 
     namespace {
 
-        std::atomic<bool> s_locked;
-        std::mutex s_mutex;
+        std::atomic<size_t> s_memoryLimit = Stack::DefaultMemoryLimit;
+
+        // Stacks whose operations are currently being executed by this thread. Operations that are added to one of them
+        // while it's executing its own operations are a result of that execution and must not end up on the stack again
+        thread_local std::vector<const Stack*> s_executingStacks;
+
+        bool isExecuting(const Stack *stack) {
+            return std::ranges::find(s_executingStacks, stack) != s_executingStacks.end();
+        }
+
+        class ExecutionGuard {
+        public:
+            explicit ExecutionGuard(const Stack *stack) : m_stack(stack) {
+                s_executingStacks.push_back(m_stack);
+            }
+
+            ~ExecutionGuard() {
+                s_executingStacks.erase(std::ranges::find(s_executingStacks, m_stack));
+            }
+
+            ExecutionGuard(const ExecutionGuard &) = delete;
+            ExecutionGuard& operator=(const ExecutionGuard &) = delete;
+
+        private:
+            const Stack *m_stack;
+        };
 
     }
 
@@ -22,41 +45,41 @@ namespace hex::prv::undo {
 
 
     void Stack::undo(u32 count) {
-        std::scoped_lock lock(s_mutex);
-
-        s_locked = true;
-        ON_SCOPE_EXIT { s_locked = false; };
-
-        // If there are no operations, we can't undo anything.
-        if (m_undoStack.empty())
+        if (isExecuting(this))
             return;
 
+        ExecutionGuard executionGuard(this);
+        std::unique_lock lock(m_mutex);
+
         for (u32 i = 0; i < count; i += 1) {
             // If we reached the start of the list, we can't undo anymore.
-            if (!this->canUndo()) {
+            if (m_undoStack.empty()) {
                 return;
             }
 
             // Move last element from the undo stack to the redo stack
+            this->unindexLastOperation();
             m_redoStack.emplace_back(std::move(m_undoStack.back()));
             m_redoStack.back()->undo(m_provider);
             m_undoStack.pop_back();
+            m_revision += 1;
+
+            m_compressedCount = std::min(m_compressedCount, m_undoStack.size());
+            m_spilledCount    = std::min(m_spilledCount, m_undoStack.size());
+            m_unchangedCount  = std::min<size_t>(m_unchangedCount, m_undoStack.size());
         }
     }
 
     void Stack::redo(u32 count) {
-        std::scoped_lock lock(s_mutex);
-
-        s_locked = true;
-        ON_SCOPE_EXIT { s_locked = false; };
-
-        // If there are no operations, we can't redo anything.
-        if (m_redoStack.empty())
+        if (isExecuting(this))
             return;
 
+        ExecutionGuard executionGuard(this);
+        std::unique_lock lock(m_mutex);
+
         for (u32 i = 0; i < count; i += 1) {
             // If we reached the end of the list, we can't redo anymore.
-            if (!this->canRedo()) {
+            if (m_redoStack.empty()) {
                 return;
             }
 
@@ -64,64 +87,204 @@ namespace hex::prv::undo {
             m_undoStack.emplace_back(std::move(m_redoStack.back()));
             m_undoStack.back()->redo(m_provider);
             m_redoStack.pop_back();
+            this->indexLastOperation();
+            m_revision += 1;
         }
     }
 
     void Stack::groupOperations(u32 count, const UnlocalizedString &unlocalizedName) {
-        if (count <= 1)
+        if (count <= 1 || isExecuting(this))
             return;
 
+        ExecutionGuard executionGuard(this);
+        std::unique_lock lock(m_mutex);
+
         auto operation = std::make_unique<OperationGroup>(unlocalizedName);
 
-        i64 startIndex = std::max<i64>(0, m_undoStack.size() - count);
+        const size_t startIndex = m_undoStack.size() - std::min<size_t>(m_undoStack.size(), count);
 
-        // Move operations from our stack to the group in the same order they were added
-        for (u32 i = 0; i < count; i += 1) {
-            i64 index = startIndex + i;
+        // The group gets indexed and accounted for again as a whole once it's added
+        while (m_indexedRegions.size() > startIndex)
+            this->unindexLastOperation();
 
+        for (size_t i = startIndex; i < m_undoStack.size(); i += 1)
+            m_memoryUsage -= m_undoStack[i]->getMemoryUsage();
+
+        m_compressedCount = std::min(m_compressedCount, startIndex);
+        m_spilledCount    = std::min(m_spilledCount, startIndex);
+        m_unchangedCount  = std::min<size_t>(m_unchangedCount, startIndex);
+
+        // Move operations from our stack to the group in the same order they were added
+        for (size_t index = startIndex; index < m_undoStack.size(); index += 1)
             operation->addOperation(std::move(m_undoStack[index]));
-        }
 
         // Remove the empty operations from the stack
         m_undoStack.resize(startIndex);
-        this->add(std::move(operation));
+        this->addOperation(std::move(operation));
     }
 
     void Stack::apply(const Stack &otherStack) {
-        for (const auto &operation : otherStack.m_undoStack) {
-            this->add(operation->clone());
+        std::vector<std::unique_ptr<Operation>> operations;
+        {
+            std::shared_lock lock(otherStack.m_mutex);
+
+            operations.reserve(otherStack.m_undoStack.size());
+            for (const auto &operation : otherStack.m_undoStack) {
+                if (operation->modifiesData())
+                    operations.emplace_back(operation->clone());
+            }
         }
-    }
-
 
+        for (auto &operation : operations)
+            this->add(std::move(operation));
+    }
 
     bool Stack::add(std::unique_ptr<Operation> &&operation) {
-        // If we're already inside of an undo/redo operation, ignore new operations being added
-        if (s_locked)
+        // If we're already inside of an undo/redo operation of this stack, ignore new operations being added
+        if (isExecuting(this))
             return false;
 
-        s_locked = true;
-        ON_SCOPE_EXIT { s_locked = false; };
+        ExecutionGuard executionGuard(this);
+        std::unique_lock lock(m_mutex);
 
-        std::scoped_lock lock(s_mutex);
+        return this->addOperation(std::move(operation));
+    }
 
+    bool Stack::addOperation(std::unique_ptr<Operation> &&operation) {
         // Clear the redo stack
-        m_redoStack.clear();
+        this->clearRedoStack();
 
         // Insert the new operation at the end of the list
         m_undoStack.emplace_back(std::move(operation));
 
         // Do the operation
         this->getLastOperation()->redo(m_provider);
+        this->indexLastOperation();
+        m_revision += 1;
+
+        m_memoryUsage += this->getLastOperation()->getMemoryUsage();
+        this->enforceMemoryLimit();
 
         return true;
     }
 
+    void Stack::reset() {
+        std::unique_lock lock(m_mutex);
+
+        m_undoStack.clear();
+        m_redoStack.clear();
+
+        m_highlightIndex.clear();
+        m_indexedRegions.clear();
+        m_revision += 1;
+
+        m_memoryUsage = 0;
+        m_compressedCount = 0;
+        m_spilledCount = 0;
+        m_unchangedCount = 0;
+    }
+
+    void Stack::setMark() {
+        m_unchangedCount = m_undoStack.size();
+    }
+
+    size_t Stack::getUnchangedCount() const {
+        return m_unchangedCount;
+    }
+
+    size_t Stack::getMemoryLimit() {
+        return s_memoryLimit;
+    }
+
+    void Stack::setMemoryLimit(size_t limit) {
+        s_memoryLimit = limit;
+    }
+
+    void Stack::clearRedoStack() {
+        for (const auto &operation : m_redoStack)
+            m_memoryUsage -= operation->getMemoryUsage();
+
+        m_redoStack.clear();
+    }
+
+    void Stack::enforceMemoryLimit() {
+        if (m_memoryUsage <= s_memoryLimit)
+            return;
+
+        const auto coldCount = m_undoStack.size() > HotOperationCount ? m_undoStack.size() - HotOperationCount : 0;
+
+        // Start out by compressing the oldest operations, these are the least likely to be needed again
+        while (m_memoryUsage > s_memoryLimit && m_compressedCount < coldCount) {
+            auto &operation = m_undoStack[m_compressedCount];
+
+            const auto previousUsage = operation->getMemoryUsage();
+            operation->compress();
+            m_memoryUsage -= previousUsage - operation->getMemoryUsage();
+
+            m_compressedCount += 1;
+        }
+
+        // If that's not enough, move their data to disk
+        while (m_memoryUsage > s_memoryLimit && m_spilledCount < coldCount) {
+            auto &operation = m_undoStack[m_spilledCount];
+
+            const auto previousUsage = operation->getMemoryUsage();
+            operation->spill();
+            m_memoryUsage -= previousUsage - operation->getMemoryUsage();
+
+            m_spilledCount += 1;
+        }
+    }
+
+    std::optional<std::vector<Region>> Stack::getHighlightedRegions(const Region &region) const {
+        // Don't wait for long running operations, callers are usually drawing the UI
+        std::shared_lock lock(m_mutex, std::try_to_lock);
+        if (!lock.owns_lock())
+            return std::nullopt;
+
+        std::vector<Region> result;
+        m_highlightIndex.forEachOverlapping(region.getStartAddress(), region.getStartAddress() + region.getSize(), [&](u64 start, u64 end, u64, Operation *) {
+            result.push_back({ start, end - start });
+        });
+
+        return result;
+    }
+
+    void Stack::indexLastOperation() {
+        auto &keys = m_indexedRegions.emplace_back();
+
+        const auto operation = this->getLastOperation();
+        if (!operation->shouldHighlight())
+            return;
+
+        for (const auto &region : operation->getRegions()) {
+            if (region.getSize() == 0)
+                continue;
+
+            const auto id = m_nextRegionId;
+            m_nextRegionId += 1;
+
+            m_highlightIndex.insert(region.getStartAddress(), region.getStartAddress() + region.getSize(), id, operation);
+            keys.emplace_back(region.getStartAddress(), id);
+        }
+    }
+
+    void Stack::unindexLastOperation() {
+        for (const auto &[start, id] : m_indexedRegions.back())
+            m_highlightIndex.erase(start, id);
+
+        m_indexedRegions.pop_back();
+    }
+
     bool Stack::canUndo() const {
+        std::shared_lock lock(m_mutex);
+
         return !m_undoStack.empty();
     }
 
     bool Stack::canRedo() const {
+        std::shared_lock lock(m_mutex);
+
         return !m_redoStack.empty();
     }
 
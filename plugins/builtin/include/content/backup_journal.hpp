@@ -0,0 +1,22 @@
+#pragma once
+
+#include <wolv/io/fs.hpp>
+
+namespace hex::plugin::builtin::backup {
+
+    /**
+     * @brief Backs up the currently open project
+     * @note The first backup and every compaction store a full project snapshot. All backups in between only append the
+     * data modifications made since the previous backup to a journal file next to the snapshot, which is a lot cheaper
+     * than storing the entire project every time
+     */
+    void createAutoBackup();
+
+    /**
+     * @brief Loads an auto backup snapshot and replays the modifications recorded in its journal on top of it
+     * @param path Path of the snapshot project file
+     * @return true if the snapshot was loaded successfully
+     */
+    bool loadAutoBackup(const std::fs::path &path);
+
+}
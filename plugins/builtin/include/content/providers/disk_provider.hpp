@@ -2,7 +2,9 @@
 #if !defined(OS_WEB)
 
 #include <hex/providers/provider.hpp>
+#include <hex/providers/block_cache.hpp>
 
+#include <mutex>
 #include <set>
 #include <string>
 #include <vector>
@@ -46,7 +48,11 @@ namespace hex::plugin::builtin {
         std::variant<std::string, i128> queryInformation(const std::string &category, const std::string &argument) override;
 
     protected:
+        void setSequentialAccessHint(bool sequential) override;
+
         void reloadDrives();
+        bool readSectors(u64 offset, void *buffer, size_t size);
+        bool writeSectors(u64 offset, const void *buffer, size_t size);
 
         struct DriveInfo {
             std::string path;
@@ -61,6 +67,7 @@ namespace hex::plugin::builtin {
         std::fs::path m_path;
         std::string m_friendlyName;
         bool m_elevated = false;
+        bool m_directIo = false;
 
 #if defined(OS_WINDOWS)
         void *m_diskHandle = reinterpret_cast<void*>(-1);
@@ -72,8 +79,20 @@ namespace hex::plugin::builtin {
         size_t m_diskSize   = 0;
         size_t m_sectorSize = 0;
 
-        u64 m_sectorBufferAddress = 0;
-        std::vector<u8> m_sectorBuffer;
+        constexpr static size_t CacheBlockSize = 0x10000;
+        prv::BlockCache m_cache;
+
+        constexpr static size_t DefaultReadAheadBlocks    = 16;
+        constexpr static size_t SequentialReadAheadBlocks = 256;
+        constexpr static size_t MaxWriteSize              = 0x10'0000;
+
+#if !defined(OS_WINDOWS)
+        // Direct I/O requires the memory of every transfer to be aligned, so unaligned requests go through this buffer
+        constexpr static size_t DirectIoAlignment = 0x1000;
+        std::mutex m_directIoMutex;
+        std::vector<u8> m_directIoBuffer;
+        u8 *getDirectIoBuffer(size_t size);
+#endif
 
         bool m_readable = false;
         bool m_writable = false;
@@ -1,9 +1,11 @@
 #pragma once
 
 #include <hex/providers/provider.hpp>
+#include <hex/providers/piece_table.hpp>
 
 #include <wolv/io/file.hpp>
 
+#include <map>
 #include <mutex>
 #include <string_view>
 
@@ -26,6 +28,7 @@ namespace hex::plugin::builtin {
 
         void readRaw(u64 offset, void *buffer, size_t size) override;
         void writeRaw(u64 offset, const void *buffer, size_t size) override;
+        [[nodiscard]] std::optional<std::span<const u8>> getRawSpan(u64 offset, size_t size) override;
 
         [[nodiscard]] u64 getActualSize() const override;
 
@@ -57,11 +60,23 @@ namespace hex::plugin::builtin {
 
     private:
         void convertToMemoryFile();
+        bool writeToFile(const std::fs::path &path);
+
+        void readOriginal(u64 offset, void *buffer, size_t size);
+        void writeOriginal(u64 offset, const void *buffer, size_t size);
+        bool flushDirtyPages();
 
     protected:
         std::fs::path m_path;
         wolv::io::File m_file;
         size_t m_fileSize = 0;
+        prv::PieceTable m_pieceTable;
+
+        // In copy-on-write mode, the mapping is never written to. Modified pages are kept in memory instead
+        // and only written back to the file when saving
+        constexpr static u64 DirtyPageSize = 0x1000;
+        bool m_copyOnWrite = true;
+        std::map<u64, std::vector<u8>> m_dirtyPages;
 
         std::optional<struct stat> m_fileStats;
 
@@ -1,16 +1,39 @@
 #pragma once
 
 #include <hex/providers/provider.hpp>
+#include <hex/providers/block_cache.hpp>
 
 #include <wolv/net/socket_client.hpp>
 
-#include <array>
+#include <chrono>
+#include <condition_variable>
 #include <mutex>
+#include <string>
 #include <string_view>
 #include <thread>
 
 namespace hex::plugin::builtin {
 
+    namespace gdb {
+
+        /**
+         * @brief Connection to a GDB server together with the capabilities negotiated with it
+         */
+        struct Connection {
+            wolv::net::SocketClient socket;
+
+            // Data received from the server that hasn't been parsed into packets yet
+            std::string receiveBuffer;
+
+            // Whether the server supports binary memory reads using the 'x' packet
+            bool binaryReads = false;
+
+            // Largest amount of memory that's requested with a single packet
+            size_t maxReadSize = 0x200;
+        };
+
+    }
+
     class GDBProvider : public hex::prv::Provider {
     public:
         GDBProvider();
@@ -50,26 +73,30 @@ namespace hex::plugin::builtin {
         std::variant<std::string, i128> queryInformation(const std::string &category, const std::string &argument) override;
 
     protected:
-        wolv::net::SocketClient m_socket;
+        void refreshCache();
+
+    protected:
+        gdb::Connection m_connection;
 
         std::string m_ipAddress;
         int m_port = 0;
 
         u64 m_size = 0;
 
-        constexpr static size_t CacheLineSize = 0x10;
-
-        struct CacheLine {
-            u64 address;
+        constexpr static size_t CacheBlockSize = 0x200;
+        prv::BlockCache m_cache = prv::BlockCache(CacheBlockSize, 512);
 
-            std::array<u8, CacheLineSize> data;
-        };
-
-        std::list<CacheLine> m_cache;
-        std::atomic<bool> m_resetCache = false;
+        // Blocks that are refreshed at most per round, most recently used ones first
+        constexpr static size_t MaxRefreshBlocks = 64;
+        constexpr static auto MinRefreshInterval = std::chrono::milliseconds(50);
+        constexpr static auto MaxRefreshInterval = std::chrono::milliseconds(1000);
 
         std::thread m_cacheUpdateThread;
-        std::mutex m_cacheLock;
+        std::mutex m_socketLock;
+
+        std::mutex m_refreshMutex;
+        std::condition_variable m_refreshCondition;
+        bool m_stopRefresh = false;
     };
 
 }
\ No newline at end of file
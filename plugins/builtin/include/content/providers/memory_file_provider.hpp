@@ -1,6 +1,7 @@
 #pragma once
 
 #include <hex/providers/provider.hpp>
+#include <hex/providers/chunked_buffer.hpp>
 
 namespace hex::plugin::builtin {
 
@@ -21,7 +22,8 @@ namespace hex::plugin::builtin {
 
         void readRaw(u64 offset, void *buffer, size_t size) override;
         void writeRaw(u64 offset, const void *buffer, size_t size) override;
-        [[nodiscard]] u64 getActualSize() const override { return m_data.size(); }
+        [[nodiscard]] std::optional<std::span<const u8>> getRawSpan(u64 offset, size_t size) override;
+        [[nodiscard]] u64 getActualSize() const override { return m_data.getSize(); }
 
         void resizeRaw(u64 newSize) override;
         void insertRaw(u64 offset, u64 size) override;
@@ -45,11 +47,17 @@ namespace hex::plugin::builtin {
 
         void setReadOnly(bool readOnly) { m_readOnly = readOnly; }
 
+        /**
+         * @brief Replaces the provider's data without going through the undo stack
+         * @note The new data needs to have the same size as the current one
+         */
+        void setData(prv::ChunkedBuffer data) { m_data = std::move(data); }
+
     private:
         void renameFile();
 
     private:
-        std::vector<u8> m_data;
+        prv::ChunkedBuffer m_data;
         std::string m_name;
         bool m_readOnly = false;
     };
@@ -3,14 +3,22 @@
 #if defined(OS_WINDOWS) || defined (OS_LINUX)
 
 #include <hex/providers/provider.hpp>
+#include <hex/providers/block_cache.hpp>
+#include <hex/providers/process_memory.hpp>
 #include <hex/api/localization_manager.hpp>
 
 #include <hex/ui/imgui_imhex_extensions.h>
 #include <hex/ui/widgets.hpp>
 #include <hex/helpers/utils.hpp>
 
-#include <set>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <span>
 #include <thread>
+#include <vector>
 
 #include <nlohmann/json.hpp>
 
@@ -41,6 +49,7 @@ namespace hex::plugin::builtin {
         [[nodiscard]] bool isDumpable() const override { return false; }
 
         void readRaw(u64 address, void *buffer, size_t size) override;
+        void readRawv(std::span<const ReadRequest> requests) override;
         void writeRaw(u64 address, const void *buffer, size_t size) override;
         [[nodiscard]] u64 getActualSize() const override { return 0xFFFF'FFFF'FFFF;  }
 
@@ -62,6 +71,8 @@ namespace hex::plugin::builtin {
         bool drawLoadInterface() override;
         void drawInterface() override;
 
+        std::vector<MenuEntry> getMenuEntries() override;
+
         void loadSettings(const nlohmann::json &) override {}
         [[nodiscard]] nlohmann::json storeSettings(nlohmann::json) const override { return { }; }
 
@@ -75,6 +86,19 @@ namespace hex::plugin::builtin {
     private:
         void reloadProcessModules();
 
+        /**
+         * @brief Schedules a reload of the process' memory regions on the main thread if the current ones are old enough
+         * @param readMiss true if a read hit memory that isn't mapped according to the current regions or failed
+         */
+        void requestRegionReload(bool readMiss);
+
+        /**
+         * @brief Copies all readable memory of the process into a new ProcessSnapshotProvider
+         * @note The memory is read on multiple task manager workers in parallel
+         */
+        void snapshotProcess();
+        bool readProcessMemory(std::span<const ReadRequest> requests);
+
     private:
         struct Process {
             u32 id;
@@ -85,16 +109,31 @@ namespace hex::plugin::builtin {
         struct MemoryRegion {
             Region region;
             std::string name;
+            bool readable = true;
 
             constexpr bool operator<(const MemoryRegion &other) const {
-                return this->region.getStartAddress() < other.region.getStartAddress();
+                if (this->region.getStartAddress() != other.region.getStartAddress())
+                    return this->region.getStartAddress() < other.region.getStartAddress();
+                else
+                    return this->region.getSize() < other.region.getSize();
             }
         };
 
         std::vector<Process> m_processes;
         const Process *m_selectedProcess = nullptr;
 
-        std::set<MemoryRegion> m_memoryRegions;
+        // Regions of the process sorted by address and the merged address ranges of all readable regions
+        mutable std::shared_mutex m_regionMutex;
+        std::vector<MemoryRegion> m_memoryRegions;
+        std::vector<Region> m_mappedRanges;
+
+        // Mappings change while the process runs. Reloading them parses the entire list of regions again, so it's only done
+        // once they're older than RegionMaxAge, or older than RegionMinAge if a read hit memory that isn't known to be mapped
+        constexpr static auto RegionMinAge = std::chrono::milliseconds(500);
+        constexpr static auto RegionMaxAge = std::chrono::seconds(2);
+        std::atomic<std::chrono::steady_clock::rep> m_regionReloadTime = 0;
+        std::atomic<bool> m_regionReloadPending = false;
+
         ui::SearchableWidget<Process> m_processSearchWidget = ui::SearchableWidget<Process>([](const std::string &search, const Process &process) {
             return hex::containsIgnoreCase(process.name, search);
         });
@@ -109,6 +148,22 @@ namespace hex::plugin::builtin {
 #endif
 
         bool m_enumerationFailed = false;
+
+        // The process keeps running while we're looking at it, so cached pages are only kept around for a short while
+        constexpr static size_t CachePageSize = 0x1000;
+        constexpr static auto CacheMaxAge = std::chrono::milliseconds(250);
+        prv::BlockCache m_cache = prv::BlockCache(CachePageSize, 1024);
+
+        // Reads at least this large bypass the cache. They're usually scans that would only evict everything else
+        constexpr static size_t DirectReadSize = 0x10'0000;
+
+        // Snapshots are taken in pieces of this size, so large regions get split up between workers as well
+        constexpr static size_t SnapshotWorkSize = 0x100'0000;
+        constexpr static size_t SnapshotPageSize = 0x1000;
+
+        // Snapshots that are still being taken, close() stops them and waits for their workers
+        std::mutex m_snapshotCaptureMutex;
+        std::vector<std::weak_ptr<prv::SparseMemoryCapture>> m_snapshotCaptures;
     };
 
 }
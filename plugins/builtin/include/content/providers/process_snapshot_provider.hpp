@@ -0,0 +1,45 @@
+#pragma once
+
+#include <hex/providers/sparse_memory_provider.hpp>
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace hex::plugin::builtin {
+
+    /**
+     * @brief Frozen copy of the readable memory of a process
+     * @note All data is kept at its original virtual address. Pages that only contain zeros aren't stored and
+     * read back as zeros, just like the unmapped holes between the captured regions
+     */
+    class ProcessSnapshotProvider : public hex::prv::SparseMemoryProvider {
+    public:
+        ProcessSnapshotProvider() = default;
+        ~ProcessSnapshotProvider() override = default;
+
+        [[nodiscard]] bool isDumpable() const override { return false; }
+
+        [[nodiscard]] std::string getName() const override;
+        [[nodiscard]] std::vector<Description> getDataDescription() const override;
+
+        [[nodiscard]] std::string getTypeName() const override {
+            return "hex.builtin.provider.process_snapshot";
+        }
+
+        void loadSettings(const nlohmann::json &settings) override;
+        [[nodiscard]] nlohmann::json storeSettings(nlohmann::json settings) const override;
+
+        /**
+         * @brief Sets the captured memory
+         * @param processName Name of the process the memory was captured from
+         * @param regions Address ranges that were captured, sorted by address and not overlapping
+         * @param chunks Data of all captured pages that contain non-zero bytes, keyed by their address
+         */
+        void setData(std::string processName, std::vector<Region> regions, std::map<u64, std::vector<u8>> chunks);
+
+    private:
+        std::string m_processName;
+    };
+
+}
@@ -38,6 +38,7 @@ namespace hex::plugin::builtin::undo {
         }
 
         bool shouldHighlight() const override { return false; }
+        bool modifiesData() const override { return false; }
 
     private:
         ImHexApi::Bookmarks::Entry m_entry;
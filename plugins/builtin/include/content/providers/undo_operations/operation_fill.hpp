@@ -0,0 +1,164 @@
+#pragma once
+
+#include <hex/helpers/crypto.hpp>
+#include <hex/providers/undo_redo/operations/operation.hpp>
+#include <hex/providers/undo_redo/modification_data.hpp>
+
+#include <hex/api/localization_manager.hpp>
+#include <hex/helpers/fmt.hpp>
+#include <hex/helpers/utils.hpp>
+
+#include <functional>
+#include <utility>
+
+namespace hex::plugin::builtin::undo {
+
+    class OperationFill : public prv::undo::Operation {
+    public:
+        constexpr static size_t ChunkSize = 0x10'0000;
+        constexpr static size_t ChunksPerWrite = 16;
+
+        /**
+         * @brief Called after every processed chunk with the number of bytes processed so far and the total number of bytes that need to be processed.
+         * Returning false stops the fill. The operation then only covers the bytes that were filled up to that point
+         */
+        using ProgressCallback = std::function<bool(u64 processed, u64 total)>;
+
+        /**
+         * @param offset Start of the filled range, relative to the start of the provider's data
+         * @param size Size of the filled range
+         * @param pattern Bytes that get repeated over the entire range
+         * @param progressCallback Optional callback that receives the progress of the first execution. Later redos don't report any progress
+         * @note The data that gets overwritten is captured when the operation is executed for the first time. That happens while the
+         * undo stack is locked, so no other modification can sneak in between capturing the data and overwriting it
+         */
+        OperationFill(u64 offset, u64 size, std::vector<u8> pattern, ProgressCallback progressCallback = { }) :
+            m_offset(offset),
+            m_size(size),
+            m_pattern(std::move(pattern)),
+            m_progressCallback(std::move(progressCallback)) { }
+
+        /**
+         * @brief Gets the size of the chunks the range gets processed in. Always a multiple of the pattern size so every chunk starts with the start of the pattern
+         */
+        [[nodiscard]] static size_t getChunkSize(size_t patternSize) {
+            if (patternSize == 0 || patternSize >= ChunkSize)
+                return patternSize;
+
+            return (ChunkSize / patternSize) * patternSize;
+        }
+
+        void undo(prv::Provider *provider) override {
+            u64 chunkOffset = m_offset;
+            for (const auto &chunk : m_previousData) {
+                const auto data = chunk.getOldData();
+                provider->applyWrite(chunkOffset, data.data(), data.size());
+
+                chunkOffset += data.size();
+            }
+        }
+
+        void redo(prv::Provider *provider) override {
+            if (m_pattern.empty() || m_size == 0)
+                return;
+
+            const auto chunkSize = getChunkSize(m_pattern.size());
+
+            // The callback belongs to whoever executed the operation first and may not outlive them, so it's only used once
+            const auto progressCallback = std::exchange(m_progressCallback, { });
+            const bool capturePreviousData = m_previousData.empty();
+            const u64 totalProgress = capturePreviousData ? m_size * 2 : m_size;
+            u64 progress = 0;
+
+            // Keep a compressed copy of the data that's about to be overwritten so the fill can be undone later on
+            if (capturePreviousData) {
+                m_previousData.reserve((m_size + chunkSize - 1) / chunkSize);
+                for (u64 offset = 0; offset < m_size; offset += chunkSize) {
+                    std::vector<u8> previousChunk(std::min<u64>(chunkSize, m_size - offset));
+                    provider->read(provider->getBaseAddress() + m_offset + offset, previousChunk.data(), previousChunk.size(), false);
+
+                    progress += previousChunk.size();
+                    m_previousData.emplace_back(std::move(previousChunk)).compress();
+
+                    if (progressCallback && !progressCallback(progress, totalProgress)) {
+                        // Nothing has been written yet
+                        m_previousData.clear();
+                        m_size = 0;
+                        return;
+                    }
+                }
+            }
+
+            std::vector<u8> chunk(std::min<u64>(chunkSize, m_size));
+            for (size_t i = 0; i < chunk.size(); i += m_pattern.size())
+                std::copy_n(m_pattern.begin(), std::min(m_pattern.size(), chunk.size() - i), chunk.begin() + i);
+
+            // Every request writes the same repeated pattern. The requests are applied in batches of multiple chunks so progress can be
+            // reported in between without paying for a separate write for every single chunk
+            std::vector<prv::Provider::WriteRequest> requests;
+            requests.reserve(ChunksPerWrite);
+            for (u64 offset = 0; offset < m_size; offset += chunkSize) {
+                requests.push_back({ m_offset + offset, size_t(std::min<u64>(chunkSize, m_size - offset)), chunk.data() });
+
+                if (requests.size() == ChunksPerWrite || offset + chunkSize >= m_size) {
+                    provider->applyWrites(requests);
+
+                    for (const auto &request : requests)
+                        progress += request.size;
+                    requests.clear();
+
+                    if (progressCallback && !progressCallback(progress, totalProgress)) {
+                        // Shrink the operation down to the chunks that have been filled already so undoing it restores exactly those
+                        m_size = std::min<u64>(offset + chunkSize, m_size);
+                        m_previousData.erase(m_previousData.begin() + ((m_size + chunkSize - 1) / chunkSize), m_previousData.end());
+                        return;
+                    }
+                }
+            }
+        }
+
+        [[nodiscard]] std::string format() const override {
+            return hex::format("{} ({})", "hex.builtin.undo_operation.fill"_lang, hex::toByteString(m_size));
+        }
+
+        std::vector<std::string> formatContent() const override {
+            return {
+                hex::format("{} {} 0x{:08X} - 0x{:08X}", hex::crypt::encode16(m_pattern), ICON_VS_ARROW_RIGHT, m_offset, m_offset + m_size - 1),
+            };
+        }
+
+        std::unique_ptr<Operation> clone() const override {
+            return std::make_unique<OperationFill>(*this);
+        }
+
+        [[nodiscard]] Region getRegion() const override {
+            return { m_offset, m_size };
+        }
+
+        [[nodiscard]] size_t getMemoryUsage() const override {
+            size_t result = m_pattern.size();
+            for (const auto &chunk : m_previousData)
+                result += chunk.getMemoryUsage();
+
+            return result;
+        }
+
+        void compress() override {
+            for (auto &chunk : m_previousData)
+                chunk.compress();
+        }
+
+        void spill() override {
+            for (auto &chunk : m_previousData)
+                chunk.spill();
+        }
+
+    private:
+        u64 m_offset;
+        u64 m_size;
+        std::vector<u8> m_pattern;
+        std::vector<prv::undo::ModificationData> m_previousData;
+        ProgressCallback m_progressCallback;
+    };
+
+}
@@ -13,11 +13,11 @@ namespace hex::plugin::builtin::undo {
             m_offset(offset), m_size(size) { }
 
         void undo(prv::Provider *provider) override {
-            provider->removeRaw(m_offset, m_size);
+            provider->applyRemove(m_offset, m_size);
         }
 
         void redo(prv::Provider *provider) override {
-            provider->insertRaw(m_offset, m_size);
+            provider->applyInsert(m_offset, m_size);
         }
 
         [[nodiscard]] std::string format() const override {
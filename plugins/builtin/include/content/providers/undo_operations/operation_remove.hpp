@@ -13,16 +13,16 @@ namespace hex::plugin::builtin::undo {
             m_offset(offset), m_size(size) { }
 
         void undo(prv::Provider *provider) override {
-            provider->insertRaw(m_offset, m_size);
+            provider->applyInsert(m_offset, m_size);
 
-            provider->writeRaw(m_offset, m_removedData.data(), m_removedData.size());
+            provider->applyWrite(m_offset, m_removedData.data(), m_removedData.size());
         }
 
         void redo(prv::Provider *provider) override {
             m_removedData.resize(m_size);
             provider->readRaw(m_offset, m_removedData.data(), m_removedData.size());
 
-            provider->removeRaw(m_offset, m_size);
+            provider->applyRemove(m_offset, m_size);
         }
 
         [[nodiscard]] std::string format() const override {
@@ -2,6 +2,7 @@
 
 #include <hex/helpers/crypto.hpp>
 #include <hex/providers/undo_redo/operations/operation.hpp>
+#include <hex/providers/undo_redo/modification_data.hpp>
 
 #include <hex/helpers/fmt.hpp>
 #include <hex/helpers/utils.hpp>
@@ -12,24 +13,25 @@ namespace hex::plugin::builtin::undo {
     public:
         OperationWrite(u64 offset, u64 size, const u8 *oldData, const u8 *newData) :
             m_offset(offset),
-            m_oldData(oldData, oldData + size),
-            m_newData(newData, newData + size) { }
+            m_data({ oldData, oldData + size }, { newData, newData + size }) { }
 
         void undo(prv::Provider *provider) override {
-            provider->writeRaw(m_offset, m_oldData.data(), m_oldData.size());
+            const auto oldData = m_data.getOldData();
+            provider->applyWrite(m_offset, oldData.data(), oldData.size());
         }
 
         void redo(prv::Provider *provider) override {
-            provider->writeRaw(m_offset, m_newData.data(), m_newData.size());
+            const auto newData = m_data.getNewData();
+            provider->applyWrite(m_offset, newData.data(), newData.size());
         }
 
         [[nodiscard]] std::string format() const override {
-            return hex::format("hex.builtin.undo_operation.write"_lang, hex::toByteString(m_newData.size()), m_offset);
+            return hex::format("hex.builtin.undo_operation.write"_lang, hex::toByteString(m_data.getSize()), m_offset);
         }
 
         std::vector<std::string> formatContent() const override {
             return {
-                hex::format("{} {} {}", hex::crypt::encode16(m_oldData), ICON_VS_ARROW_RIGHT, hex::crypt::encode16(m_newData)),
+                hex::format("{} {} {}", hex::crypt::encode16(m_data.getOldData()), ICON_VS_ARROW_RIGHT, hex::crypt::encode16(m_data.getNewData())),
             };
         }
 
@@ -38,12 +40,24 @@ namespace hex::plugin::builtin::undo {
         }
 
         [[nodiscard]] Region getRegion() const override {
-            return { m_offset, m_oldData.size() };
+            return { m_offset, m_data.getSize() };
+        }
+
+        [[nodiscard]] size_t getMemoryUsage() const override {
+            return m_data.getMemoryUsage();
+        }
+
+        void compress() override {
+            m_data.compress();
+        }
+
+        void spill() override {
+            m_data.spill();
         }
 
     private:
         u64 m_offset;
-        std::vector<u8> m_oldData, m_newData;
+        prv::undo::ModificationData m_data;
     };
 
 }
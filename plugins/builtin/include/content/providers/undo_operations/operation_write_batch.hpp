@@ -0,0 +1,106 @@
+#pragma once
+
+#include <hex/providers/undo_redo/operations/operation.hpp>
+#include <hex/providers/undo_redo/modification_data.hpp>
+
+#include <hex/api/localization_manager.hpp>
+#include <hex/helpers/fmt.hpp>
+#include <hex/helpers/utils.hpp>
+
+namespace hex::plugin::builtin::undo {
+
+    class OperationWriteBatch : public prv::undo::Operation {
+    public:
+        struct Run {
+            u64 offset;
+            u64 size;
+        };
+
+        /**
+         * @param runs Written ranges, relative to the start of the provider's data
+         * @param oldData Data of all runs before the write, stored back to back in the same order as the runs
+         * @param newData Data of all runs after the write, stored back to back in the same order as the runs
+         */
+        OperationWriteBatch(UnlocalizedString unlocalizedName, std::vector<Run> runs, std::vector<u8> oldData, std::vector<u8> newData) :
+            m_unlocalizedName(std::move(unlocalizedName)),
+            m_runs(std::move(runs)),
+            m_data(std::move(oldData), std::move(newData)) { }
+
+        void undo(prv::Provider *provider) override {
+            this->apply(provider, m_data.getOldData());
+        }
+
+        void redo(prv::Provider *provider) override {
+            this->apply(provider, m_data.getNewData());
+        }
+
+        [[nodiscard]] std::string format() const override {
+            return hex::format("{} ({})", Lang(m_unlocalizedName), hex::toByteString(m_data.getSize()));
+        }
+
+        std::vector<std::string> formatContent() const override {
+            constexpr static size_t MaxEntries = 10;
+
+            std::vector<std::string> result;
+            for (size_t i = 0; i < std::min(m_runs.size(), MaxEntries); i += 1)
+                result.emplace_back(hex::format("hex.builtin.undo_operation.write"_lang, hex::toByteString(m_runs[i].size), m_runs[i].offset));
+
+            if (m_runs.size() > MaxEntries)
+                result.emplace_back(hex::format("[{}x] ...", m_runs.size() - MaxEntries));
+
+            return result;
+        }
+
+        std::unique_ptr<Operation> clone() const override {
+            return std::make_unique<OperationWriteBatch>(*this);
+        }
+
+        [[nodiscard]] Region getRegion() const override {
+            if (m_runs.empty())
+                return Region::Invalid();
+
+            return { m_runs.front().offset, (m_runs.back().offset + m_runs.back().size) - m_runs.front().offset };
+        }
+
+        [[nodiscard]] std::vector<Region> getRegions() const override {
+            std::vector<Region> result;
+            result.reserve(m_runs.size());
+            for (const auto &run : m_runs)
+                result.push_back({ run.offset, run.size });
+
+            return result;
+        }
+
+        [[nodiscard]] size_t getMemoryUsage() const override {
+            return m_data.getMemoryUsage();
+        }
+
+        void compress() override {
+            m_data.compress();
+        }
+
+        void spill() override {
+            m_data.spill();
+        }
+
+    private:
+        void apply(prv::Provider *provider, const std::vector<u8> &data) const {
+            std::vector<prv::Provider::WriteRequest> requests;
+            requests.reserve(m_runs.size());
+
+            u64 dataOffset = 0;
+            for (const auto &run : m_runs) {
+                requests.push_back({ run.offset, run.size, data.data() + dataOffset });
+                dataOffset += run.size;
+            }
+
+            provider->applyWrites(requests);
+        }
+
+    private:
+        UnlocalizedString m_unlocalizedName;
+        std::vector<Run> m_runs;
+        prv::undo::ModificationData m_data;
+    };
+
+}
@@ -5,8 +5,10 @@
 #include <hex/api/task_manager.hpp>
 #include <hex/ui/view.hpp>
 #include <hex/helpers/binary_pattern.hpp>
+#include <hex/helpers/candidate_set.hpp>
 #include <ui/widgets.hpp>
 
+#include <optional>
 #include <vector>
 
 #include <wolv/container/interval_tree.hpp>
@@ -98,22 +100,32 @@ namespace hex::plugin::builtin {
 
         } m_searchSettings, m_decodeSettings;
 
+        enum class NextScanFilter : int {
+            Equals = 0, Changed = 1, Unchanged = 2, Increased = 3, Decreased = 4
+        } m_nextScanFilter = NextScanFilter::Equals;
+
         using OccurrenceTree = wolv::container::IntervalTree<Occurrence>;
 
         PerProvider<std::vector<Occurrence>> m_foundOccurrences, m_sortedOccurrences;
+        PerProvider<u64> m_foundGeneration;
+        PerProvider<std::optional<u64>> m_failedUpdateGeneration;
+        PerProvider<SearchSettings> m_foundSettings;
         PerProvider<OccurrenceTree> m_occurrenceTree;
         PerProvider<std::string> m_currFilter;
+        PerProvider<CandidateSet> m_candidates;
 
-        TaskHolder m_searchTask, m_filterTask;
+        TaskHolder m_searchTask, m_filterTask, m_updateTask;
         bool m_settingsValid = false;
         std::string m_replaceBuffer;
 
     private:
-        static std::vector<Occurrence> searchStrings(Task &task, prv::Provider *provider, Region searchRegion, const SearchSettings::Strings &settings);
-        static std::vector<Occurrence> searchSequence(Task &task, prv::Provider *provider, Region searchRegion, const SearchSettings::Sequence &settings);
-        static std::vector<Occurrence> searchRegex(Task &task, prv::Provider *provider, Region searchRegion, const SearchSettings::Regex &settings);
-        static std::vector<Occurrence> searchBinaryPattern(Task &task, prv::Provider *provider, Region searchRegion, const SearchSettings::BinaryPattern &settings);
-        static std::vector<Occurrence> searchValue(Task &task, prv::Provider *provider, Region searchRegion, const SearchSettings::Value &settings);
+        static std::vector<Occurrence> searchStrings(Task &task, const prv::Snapshot &snapshot, Region searchRegion, const SearchSettings::Strings &settings);
+        static std::vector<Occurrence> searchSequence(Task &task, const prv::Snapshot &snapshot, Region searchRegion, const SearchSettings::Sequence &settings);
+        static std::vector<Occurrence> searchRegex(Task &task, const prv::Snapshot &snapshot, Region searchRegion, const SearchSettings::Regex &settings);
+        static std::vector<Occurrence> searchBinaryPattern(Task &task, const prv::Snapshot &snapshot, Region searchRegion, const SearchSettings::BinaryPattern &settings);
+        static CandidateSet scanValues(Task &task, prv::Provider *provider, const prv::Snapshot &snapshot, Region searchRegion, const SearchSettings::Value &settings);
+        static CandidateSet narrowCandidates(Task &task, prv::Provider *provider, const CandidateSet &candidates, const SearchSettings::Value &settings, NextScanFilter filter);
+        static std::vector<Occurrence> getCandidateOccurrences(const CandidateSet &candidates, const SearchSettings::Value &settings);
 
         void drawContextMenu(Occurrence &target, const std::string &value);
 
@@ -121,7 +133,12 @@ namespace hex::plugin::builtin {
         static std::tuple<bool, std::variant<u64, i64, float, double>, size_t> parseNumericValueInput(const std::string &input, SearchSettings::Value::Type type);
 
         void runSearch();
+        void runNextScan();
+        bool tryUpdateOccurrences(prv::Provider *provider);
+        bool updateOccurrences(prv::Provider *provider);
         std::string decodeValue(prv::Provider *provider, const Occurrence &occurrence, size_t maxBytes = 0xFFFF'FFFF) const;
+        std::vector<std::string> decodeValues(prv::Provider *provider, std::span<const Occurrence> occurrences, size_t maxBytes = 0xFFFF'FFFF) const;
+        std::string formatValue(std::span<const u8> bytes, const Occurrence &occurrence, size_t maxBytes) const;
     };
 
 }
\ No newline at end of file
@@ -33,6 +33,7 @@ namespace hex::plugin::builtin {
 
         Region m_analysisRegion = { 0, 0 };
         Region m_analyzedRegion = { 0, 0 };
+        u64 m_analyzedGeneration = 0;
 
         std::string m_dataDescription;
         std::string m_dataMimeType;
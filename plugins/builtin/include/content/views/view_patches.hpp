@@ -4,6 +4,8 @@
 
 #include <hex/ui/view.hpp>
 
+#include <vector>
+
 namespace hex::plugin::builtin {
 
     class ViewPatches : public View::Window {
@@ -15,8 +17,17 @@ namespace hex::plugin::builtin {
         void drawAlwaysVisibleContent() override;
 
     private:
+        struct HighlightCache {
+            u64 revision = 0;
+            Region block = Region::Invalid();
+            std::vector<Region> regions;
+        };
+
+        constexpr static u64 HighlightBlockSize = 0x100;
+
         u64 m_selectedPatch = 0x00;
-        PerProvider<u32> m_numOperations;
+        PerProvider<u64> m_undoStackRevision;
+        PerProvider<HighlightCache> m_highlightCache;
     };
 
 }
\ No newline at end of file
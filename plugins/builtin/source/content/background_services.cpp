@@ -7,11 +7,12 @@
 #include <wolv/net/socket_server.hpp>
 
 #include <hex/helpers/fmt.hpp>
-#include <fmt/chrono.h>
 #include <hex/helpers/logger.hpp>
 
 #include <nlohmann/json.hpp>
 
+#include <content/backup_journal.hpp>
+
 namespace hex::plugin::builtin {
 
     static bool networkInterfaceServiceEnabled = false;
@@ -70,13 +71,7 @@ namespace hex::plugin::builtin {
                 lastBackupTime = now;
 
                 if (ImHexApi::Provider::isValid() && ImHexApi::Provider::isDirty()) {
-                    for (const auto &path : fs::getDefaultPaths(fs::ImHexPath::Backups)) {
-                        const auto fileName = hex::format("auto_backup.{:%y%m%d_%H%M%S}.hexproj", fmt::gmtime(std::chrono::system_clock::now()));
-                        if (ProjectFile::store(path / fileName, false))
-                            break;
-                    }
-
-                    log::info("Backed up project");
+                    backup::createAutoBackup();
                 }
             }
 
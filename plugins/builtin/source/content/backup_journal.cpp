@@ -0,0 +1,427 @@
+#include <content/backup_journal.hpp>
+
+#include <hex/api/imhex_api.hpp>
+#include <hex/api/project_file_manager.hpp>
+#include <hex/providers/provider.hpp>
+#include <hex/providers/write_batch.hpp>
+#include <hex/providers/undo_redo/stack.hpp>
+
+#include <hex/helpers/fmt.hpp>
+#include <hex/helpers/fs.hpp>
+#include <hex/helpers/logger.hpp>
+#include <fmt/chrono.h>
+
+#include <wolv/io/file.hpp>
+#include <wolv/utils/string.hpp>
+
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+namespace hex::plugin::builtin::backup {
+
+    namespace {
+
+        // Journal layout: magic, version, followed by records. The records of one backup are terminated by a commit
+        // record, records after the last commit record were cut off while being written and get ignored
+        constexpr std::string_view JournalMagic   = "IMHXJRNL";
+        constexpr u32              JournalVersion = 1;
+        constexpr auto             JournalExtension = ".journal";
+
+        // Store a new snapshot once the journal gets too big to be replayed quickly or after a number of backups,
+        // so changes to project state other than the provider data end up in the backup as well
+        constexpr u64 MaxJournalSize    = 64 * 1024 * 1024;
+        constexpr u32 MaxJournalBackups = 10;
+
+        // Number of snapshots of earlier states of this session that are kept around next to the current one
+        constexpr size_t MaxOlderSnapshots = 4;
+
+        enum class RecordType : u8 {
+            Write   = 0x00,
+            Insert  = 0x01,
+            Remove  = 0x02,
+            Commit  = 0xFF
+        };
+
+        struct Record {
+            RecordType type;
+            u32 providerIndex;
+            u64 offset, size;
+            std::vector<u8> data;
+        };
+
+        /**
+         * @brief Provider without any data that records all modifications applied to it by undo operations
+         * @note Operations like fills describe a lot of data in very little memory. Only up to maxDataSize bytes of written data get recorded,
+         * anything past that only marks the recorder as exceeded so a snapshot can be stored instead
+         */
+        class ModificationRecorder : public prv::Provider {
+        public:
+            ModificationRecorder(u32 providerIndex, u64 maxDataSize) : m_providerIndex(providerIndex), m_maxDataSize(maxDataSize) { }
+            ~ModificationRecorder() override = default;
+
+            [[nodiscard]] bool isAvailable() const override { return true; }
+            [[nodiscard]] bool isReadable()  const override { return true; }
+            [[nodiscard]] bool isWritable()  const override { return true; }
+            [[nodiscard]] bool isResizable() const override { return true; }
+            [[nodiscard]] bool isSavable()   const override { return false; }
+            [[nodiscard]] bool isSavableAsRecent() const override { return false; }
+
+            [[nodiscard]] bool open() override { return true; }
+            void close() override { }
+
+            void readRaw(u64 offset, void *buffer, size_t size) override {
+                hex::unused(offset, buffer, size);
+            }
+
+            void writeRaw(u64 offset, const void *buffer, size_t size) override {
+                if (m_exceeded || size > m_maxDataSize - m_dataSize) {
+                    m_exceeded = true;
+                    return;
+                }
+
+                const auto bytes = static_cast<const u8*>(buffer);
+                m_records.push_back({ RecordType::Write, m_providerIndex, offset, size, { bytes, bytes + size } });
+                m_dataSize += size;
+            }
+
+            void insertRaw(u64 offset, u64 size) override {
+                m_records.push_back({ RecordType::Insert, m_providerIndex, offset, size, { } });
+            }
+
+            void removeRaw(u64 offset, u64 size) override {
+                m_records.push_back({ RecordType::Remove, m_providerIndex, offset, size, { } });
+            }
+
+            [[nodiscard]] u64 getActualSize() const override { return 0; }
+
+            [[nodiscard]] std::string getName() const override { return ""; }
+            [[nodiscard]] std::string getTypeName() const override { return ""; }
+
+            std::vector<Record>&& takeRecords() {
+                return std::move(m_records);
+            }
+
+            [[nodiscard]] u64 getDataSize() const { return m_dataSize; }
+            [[nodiscard]] bool hasExceededLimit() const { return m_exceeded; }
+
+        private:
+            u32 m_providerIndex;
+            std::vector<Record> m_records;
+
+            u64 m_maxDataSize;
+            u64 m_dataSize = 0;
+            bool m_exceeded = false;
+        };
+
+        // State of the current session's backup. Only accessed by the auto backup service
+        std::fs::path s_snapshotPath;
+        std::vector<std::fs::path> s_olderSnapshotPaths;
+        std::unique_ptr<wolv::io::File> s_journal;
+        std::vector<u64> s_providerIds;
+        std::vector<size_t> s_journaledCounts;
+        u32 s_journalBackupCount = 0;
+        bool s_compactionRequired = true;
+
+        template<typename T>
+        void appendLittleEndian(std::vector<u8> &buffer, T value) {
+            for (size_t i = 0; i < sizeof(T); i += 1)
+                buffer.push_back(u8(value >> (i * 8)));
+        }
+
+        template<typename T>
+        T readLittleEndian(std::span<const u8> buffer, size_t offset) {
+            T value = 0;
+            for (size_t i = 0; i < sizeof(T); i += 1)
+                value |= T(buffer[offset + i]) << (i * 8);
+
+            return value;
+        }
+
+        std::fs::path getJournalPath(const std::fs::path &snapshotPath) {
+            auto path = snapshotPath;
+            path += JournalExtension;
+
+            return path;
+        }
+
+        void removeSnapshot(const std::fs::path &snapshotPath) {
+            if (snapshotPath.empty())
+                return;
+
+            std::error_code errorCode;
+            std::fs::remove(snapshotPath, errorCode);
+            std::fs::remove(getJournalPath(snapshotPath), errorCode);
+        }
+
+        /**
+         * @brief Stores the entire project and starts a new, empty journal for it
+         */
+        bool storeSnapshot(const std::vector<prv::Provider*> &providers) {
+            std::vector<size_t> counts;
+            for (const auto &provider : providers) {
+                auto &stack = provider->getUndoStack();
+                auto lock = stack.tryLockShared();
+
+                counts.push_back(lock.owns_lock() ? stack.getAppliedOperations().size() : std::numeric_limits<size_t>::max());
+            }
+
+            const auto fileName = hex::format("auto_backup.{:%y%m%d_%H%M%S}.hexproj", fmt::gmtime(std::chrono::system_clock::now()));
+
+            std::fs::path snapshotPath;
+            for (const auto &path : fs::getDefaultPaths(fs::ImHexPath::Backups)) {
+                if (ProjectFile::store(path / fileName, false)) {
+                    snapshotPath = path / fileName;
+                    break;
+                }
+            }
+
+            if (snapshotPath.empty())
+                return false;
+
+            // Keep a few of the previous snapshots of this session around so older states can still be restored.
+            // Their journals stay valid since nothing gets appended to them anymore
+            s_journal.reset();
+            if (!s_snapshotPath.empty() && snapshotPath != s_snapshotPath) {
+                s_olderSnapshotPaths.push_back(s_snapshotPath);
+                while (s_olderSnapshotPaths.size() > MaxOlderSnapshots) {
+                    removeSnapshot(s_olderSnapshotPaths.front());
+                    s_olderSnapshotPaths.erase(s_olderSnapshotPaths.begin());
+                }
+            }
+
+            s_snapshotPath = snapshotPath;
+            s_journal = std::make_unique<wolv::io::File>(getJournalPath(snapshotPath), wolv::io::File::Mode::Create);
+            if (s_journal->isValid()) {
+                std::vector<u8> header(JournalMagic.begin(), JournalMagic.end());
+                appendLittleEndian<u32>(header, JournalVersion);
+
+                s_journal->writeVector(header);
+                s_journal->flush();
+            }
+
+            s_providerIds.clear();
+            s_journaledCounts.clear();
+            s_journalBackupCount = 0;
+            s_compactionRequired = false;
+
+            for (size_t i = 0; i < providers.size(); i += 1) {
+                auto &stack = providers[i]->getUndoStack();
+                auto lock = stack.tryLockShared();
+
+                // If operations got added while the project was being stored, it's unknown if they made it into the snapshot
+                const auto count = lock.owns_lock() ? stack.getAppliedOperations().size() : 0;
+                if (!lock.owns_lock() || count != counts[i])
+                    s_compactionRequired = true;
+                else
+                    stack.setMark();
+
+                s_providerIds.push_back(providers[i]->getID());
+                s_journaledCounts.push_back(count);
+            }
+
+            return true;
+        }
+
+        /**
+         * @brief Appends all data modifications made since the last backup to the journal
+         * @return false if the journal can't be used anymore and a new snapshot needs to be created
+         */
+        bool appendToJournal(const std::vector<prv::Provider*> &providers) {
+            std::vector<Record> records;
+            std::vector<size_t> counts(providers.size());
+
+            // Don't record more data than the journal may still grow by, it would get compacted into a snapshot right afterwards anyway
+            const auto journalSize = s_journal->getSize();
+            u64 remainingDataSize = journalSize < MaxJournalSize ? MaxJournalSize - journalSize : 0;
+
+            for (size_t i = 0; i < providers.size(); i += 1) {
+                auto &stack = providers[i]->getUndoStack();
+                std::vector<std::unique_ptr<prv::undo::Operation>> operations;
+
+                {
+                    auto lock = stack.tryLockShared();
+                    if (!lock.owns_lock())
+                        return false;
+
+                    // Operations that were already journaled got undone, there's no way to express that in the journal
+                    if (stack.getUnchangedCount() < s_journaledCounts[i])
+                        return false;
+
+                    const auto &appliedOperations = stack.getAppliedOperations();
+                    for (size_t index = s_journaledCounts[i]; index < appliedOperations.size(); index += 1) {
+                        if (appliedOperations[index]->modifiesData())
+                            operations.emplace_back(appliedOperations[index]->clone());
+                    }
+
+                    counts[i] = appliedOperations.size();
+                    stack.setMark();
+                }
+
+                // Replay the new operations without any data underneath to find out what they modified
+                ModificationRecorder recorder(u32(i), remainingDataSize);
+                for (auto &operation : operations) {
+                    operation->redo(&recorder);
+
+                    if (recorder.hasExceededLimit())
+                        return false;
+                }
+
+                remainingDataSize -= recorder.getDataSize();
+
+                auto providerRecords = recorder.takeRecords();
+                records.insert(records.end(), std::make_move_iterator(providerRecords.begin()), std::make_move_iterator(providerRecords.end()));
+            }
+
+            std::vector<u8> buffer;
+            for (const auto &record : records) {
+                buffer.push_back(u8(record.type));
+                appendLittleEndian<u32>(buffer, record.providerIndex);
+                appendLittleEndian<u64>(buffer, record.offset);
+                appendLittleEndian<u64>(buffer, record.size);
+                buffer.insert(buffer.end(), record.data.begin(), record.data.end());
+            }
+            buffer.push_back(u8(RecordType::Commit));
+
+            s_journal->seek(s_journal->getSize());
+            s_journal->writeVector(buffer);
+            s_journal->flush();
+
+            s_journaledCounts = std::move(counts);
+            s_journalBackupCount += 1;
+
+            return true;
+        }
+
+        /**
+         * @brief Parses a journal file
+         * @return All records up to the last commit record
+         */
+        std::vector<Record> readJournal(const std::fs::path &journalPath) {
+            wolv::io::File file(journalPath, wolv::io::File::Mode::Read);
+            if (!file.isValid())
+                return { };
+
+            const auto data = file.readVector();
+            const auto headerSize = JournalMagic.size() + sizeof(u32);
+            if (data.size() < headerSize || std::memcmp(data.data(), JournalMagic.data(), JournalMagic.size()) != 0 || readLittleEndian<u32>(data, JournalMagic.size()) != JournalVersion) {
+                log::warn("Invalid backup journal {}", wolv::util::toUTF8String(journalPath));
+                return { };
+            }
+
+            constexpr static auto RecordHeaderSize = sizeof(u8) + sizeof(u32) + sizeof(u64) * 2;
+
+            std::vector<Record> result;
+            size_t committedCount = 0;
+            for (size_t offset = headerSize; offset < data.size();) {
+                const auto type = RecordType(data[offset]);
+                if (type == RecordType::Commit) {
+                    committedCount = result.size();
+                    offset += sizeof(u8);
+                    continue;
+                }
+
+                if (data.size() - offset < RecordHeaderSize)
+                    break;
+
+                Record record = { type, readLittleEndian<u32>(data, offset + 1), readLittleEndian<u64>(data, offset + 5), readLittleEndian<u64>(data, offset + 13), { } };
+                offset += RecordHeaderSize;
+
+                if (type == RecordType::Write) {
+                    if (record.size > data.size() - offset)
+                        break;
+
+                    record.data.assign(data.begin() + offset, data.begin() + offset + record.size);
+                    offset += record.size;
+                }
+
+                result.emplace_back(std::move(record));
+            }
+
+            result.resize(committedCount);
+
+            return result;
+        }
+
+    }
+
+    void createAutoBackup() {
+        const auto providers = ImHexApi::Provider::getProviders();
+
+        std::vector<u64> providerIds;
+        for (const auto &provider : providers)
+            providerIds.push_back(provider->getID());
+
+        const bool compact =
+            s_compactionRequired ||
+            s_journal == nullptr || !s_journal->isValid() ||
+            providerIds != s_providerIds ||
+            s_journalBackupCount >= MaxJournalBackups ||
+            s_journal->getSize() >= MaxJournalSize;
+
+        if (!compact && appendToJournal(providers)) {
+            log::info("Backed up project modifications");
+            return;
+        }
+
+        if (storeSnapshot(providers))
+            log::info("Backed up project");
+    }
+
+    bool loadAutoBackup(const std::fs::path &path) {
+        if (!ProjectFile::load(path))
+            return false;
+
+        const auto records = readJournal(getJournalPath(path));
+        if (records.empty())
+            return true;
+
+        const auto &providers = ImHexApi::Provider::getProviders();
+
+        // Collect consecutive writes into batches so they end up as a single operation, but keep them in order with insertions and removals
+        std::vector<std::unique_ptr<prv::WriteBatch>> batches(providers.size());
+        const auto flush = [&](u32 providerIndex) {
+            if (auto &batch = batches[providerIndex]; batch != nullptr) {
+                providers[providerIndex]->write(*batch);
+                batch.reset();
+            }
+        };
+
+        for (const auto &record : records) {
+            if (record.providerIndex >= providers.size())
+                continue;
+
+            auto provider = providers[record.providerIndex];
+            const auto address = provider->getBaseAddress() + record.offset;
+
+            switch (record.type) {
+                case RecordType::Write: {
+                    auto &batch = batches[record.providerIndex];
+                    if (batch == nullptr)
+                        batch = std::make_unique<prv::WriteBatch>("hex.builtin.undo_operation.patches");
+
+                    batch->write(address, record.data.data(), record.data.size());
+                    break;
+                }
+                case RecordType::Insert:
+                    flush(record.providerIndex);
+                    provider->insert(address, record.size);
+                    break;
+                case RecordType::Remove:
+                    flush(record.providerIndex);
+                    provider->remove(address, record.size);
+                    break;
+                default:
+                    break;
+            }
+        }
+
+        for (u32 i = 0; i < batches.size(); i += 1)
+            flush(i);
+
+        return true;
+    }
+
+}
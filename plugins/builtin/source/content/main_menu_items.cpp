@@ -83,18 +83,19 @@ namespace hex::plugin::builtin {
                         return;
                     }
 
-                    task.setMaxValue(patch->get().size());
+                    task.setMaxValue(patch->get().getExtentCount());
 
                     auto provider = ImHexApi::Provider::get();
 
+                    prv::WriteBatch batch("hex.builtin.undo_operation.patches");
                     u64 count = 0;
-                    for (auto &[address, value] : patch->get()) {
-                        provider->write(address, &value, sizeof(value));
+                    patch->get().forEachExtent([&](u64 address, std::span<const u8> data) {
+                        batch.write(address, data.data(), data.size());
                         count += 1;
                         task.update(count);
-                    }
+                    });
 
-                    provider->getUndoStack().groupOperations(count, "hex.builtin.undo_operation.patches");
+                    provider->write(batch);
                 });
             });
         }
@@ -109,18 +110,19 @@ namespace hex::plugin::builtin {
                         return;
                     }
 
-                    task.setMaxValue(patch->get().size());
+                    task.setMaxValue(patch->get().getExtentCount());
 
                     auto provider = ImHexApi::Provider::get();
 
+                    prv::WriteBatch batch("hex.builtin.undo_operation.patches");
                     u64 count = 0;
-                    for (auto &[address, value] : patch->get()) {
-                        provider->write(address, &value, sizeof(value));
+                    patch->get().forEachExtent([&](u64 address, std::span<const u8> data) {
+                        batch.write(address, data.data(), data.size());
                         count += 1;
                         task.update(count);
-                    }
+                    });
 
-                    provider->getUndoStack().groupOperations(count, "hex.builtin.undo_operation.patches");
+                    provider->write(batch);
                 });
             });
         }
@@ -138,25 +140,26 @@ namespace hex::plugin::builtin {
 
                     const auto baseAddress = provider->getBaseAddress();
 
-                    std::map<u64, u8> patches;
-                    for (u64 i = 0; i < patchData.size(); i++) {
-                        u8 value = 0;
-                        provider->read(baseAddress + i, &value, 1);
+                    task.setMaxValue(patchData.size());
 
-                        if (value != patchData[i])
-                            patches[baseAddress + i] = patchData[i];
-                    }
+                    // Compare the file to the provider's data in chunks and only collect the bytes that differ
+                    constexpr static size_t ChunkSize = 0x10'0000;
+                    std::vector<u8> buffer(ChunkSize);
 
-                    task.setMaxValue(patches.size());
+                    prv::WriteBatch batch("hex.builtin.undo_operation.patches");
+                    for (u64 offset = 0; offset < patchData.size(); offset += ChunkSize) {
+                        const auto size = std::min<u64>(ChunkSize, patchData.size() - offset);
+                        provider->read(baseAddress + offset, buffer.data(), size);
 
-                    u64 count = 0;
-                    for (auto &[address, value] : patches) {
-                        provider->write(address, &value, sizeof(value));
-                        count += 1;
-                        task.update(count);
+                        for (u64 i = 0; i < size; i += 1) {
+                            if (buffer[i] != patchData[offset + i])
+                                batch.write(baseAddress + offset + i, &patchData[offset + i], 1);
+                        }
+
+                        task.update(offset);
                     }
 
-                    provider->getUndoStack().groupOperations(count, "hex.builtin.undo_operation.patches");
+                    provider->write(batch);
                 });
             });
         }
@@ -261,26 +264,35 @@ namespace hex::plugin::builtin {
             if (!patches->get().contains(0x00454F45) && patches->get().contains(0x00454F46)) {
                 u8 value = 0;
                 provider->read(0x00454F45, &value, sizeof(u8));
-                patches->get().at(0x00454F45) = value;
+                patches->get().write(0x00454F45, &value, sizeof(u8));
             }
 
-            TaskManager::createTask("hex.ui.common.processing", TaskManager::NoProgress, [patches](auto &) {
-                auto data = patches->toIPSPatch();
-
-                TaskManager::doLater([data] {
-                    fs::openFileBrowser(fs::DialogMode::Save, {}, [&data](const auto &path) {
-                        auto file = wolv::io::File(path, wolv::io::File::Mode::Create);
-                        if (!file.isValid()) {
+            fs::openFileBrowser(fs::DialogMode::Save, {}, [patches](const auto &path) {
+                TaskManager::createTask("hex.ui.common.processing", TaskManager::NoProgress, [patches, path](auto &) {
+                    auto file = wolv::io::File(path, wolv::io::File::Mode::Create);
+                    if (!file.isValid()) {
+                        TaskManager::doLater([] {
                             ui::ToastError::open("hex.builtin.menu.file.export.ips.popup.export_error"_lang);
-                            return;
-                        }
+                        });
+                        return;
+                    }
 
-                        if (data.has_value()) {
-                            file.writeVector(data.value());
-                        } else {
-                            handleIPSError(data.error());
-                        }
+                    // Stream the patch straight into the file instead of building all of it in memory first
+                    auto result = patches->writeIPSPatch([&file](std::span<const u8> data) {
+                        file.writeBuffer(data.data(), data.size());
+                    });
 
+                    if (!result.has_value()) {
+                        file.close();
+
+                        std::error_code error;
+                        std::fs::remove(path, error);
+
+                        handleIPSError(result.error());
+                        return;
+                    }
+
+                    TaskManager::doLater([] {
                         AchievementManager::unlockAchievement("hex.builtin.achievement.hex_editor", "hex.builtin.achievement.hex_editor.create_patch.name");
                     });
                 });
@@ -300,26 +312,35 @@ namespace hex::plugin::builtin {
             if (!patches->get().contains(0x45454F45) && patches->get().contains(0x45454F46)) {
                 u8 value = 0;
                 provider->read(0x45454F45, &value, sizeof(u8));
-                patches->get().at(0x45454F45) = value;
+                patches->get().write(0x45454F45, &value, sizeof(u8));
             }
 
-            TaskManager::createTask("hex.ui.common.processing", TaskManager::NoProgress, [patches](auto &) {
-                auto data = patches->toIPS32Patch();
-
-                TaskManager::doLater([data] {
-                    fs::openFileBrowser(fs::DialogMode::Save, {}, [&data](const auto &path) {
-                        auto file = wolv::io::File(path, wolv::io::File::Mode::Create);
-                        if (!file.isValid()) {
+            fs::openFileBrowser(fs::DialogMode::Save, {}, [patches](const auto &path) {
+                TaskManager::createTask("hex.ui.common.processing", TaskManager::NoProgress, [patches, path](auto &) {
+                    auto file = wolv::io::File(path, wolv::io::File::Mode::Create);
+                    if (!file.isValid()) {
+                        TaskManager::doLater([] {
                             ui::ToastError::open("hex.builtin.menu.file.export.ips.popup.export_error"_lang);
-                            return;
-                        }
+                        });
+                        return;
+                    }
 
-                        if (data.has_value()) {
-                            file.writeVector(data.value());
-                        } else {
-                            handleIPSError(data.error());
-                        }
+                    // Stream the patch straight into the file instead of building all of it in memory first
+                    auto result = patches->writeIPS32Patch([&file](std::span<const u8> data) {
+                        file.writeBuffer(data.data(), data.size());
+                    });
+
+                    if (!result.has_value()) {
+                        file.close();
+
+                        std::error_code error;
+                        std::fs::remove(path, error);
+
+                        handleIPSError(result.error());
+                        return;
+                    }
 
+                    TaskManager::doLater([] {
                         AchievementManager::unlockAchievement("hex.builtin.achievement.hex_editor", "hex.builtin.achievement.hex_editor.create_patch.name");
                     });
                 });
@@ -9,6 +9,7 @@
 #include "content/providers/memory_file_provider.hpp"
 #include "content/providers/view_provider.hpp"
 #include <content/providers/process_memory_provider.hpp>
+#include <content/providers/process_snapshot_provider.hpp>
 #include <content/providers/base64_provider.hpp>
 #include <popups/popup_notification.hpp>
 #include "content/helpers/notification.hpp"
@@ -36,6 +37,7 @@ namespace hex::plugin::builtin {
         ContentRegistry::Provider::add<Base64Provider>();
         ContentRegistry::Provider::add<MemoryFileProvider>(false);
         ContentRegistry::Provider::add<ViewProvider>(false);
+        ContentRegistry::Provider::add<ProcessSnapshotProvider>(false);
 
         #if defined(OS_WINDOWS) ||defined (OS_LINUX)
             ContentRegistry::Provider::add<ProcessMemoryProvider>();
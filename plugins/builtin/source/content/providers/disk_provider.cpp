@@ -42,7 +42,8 @@
 #endif
 
 #if defined(OS_LINUX)
-#define lseek lseek64
+#define pread pread64
+#define pwrite pwrite64
 #endif
 
 namespace hex::plugin::builtin {
@@ -175,7 +176,6 @@ namespace hex::plugin::builtin {
                         nullptr)) {
                     m_diskSize   = diskGeometry.DiskSize.QuadPart;
                     m_sectorSize = diskGeometry.Geometry.BytesPerSector;
-                    m_sectorBuffer.resize(m_sectorSize);
                 }
             }
 
@@ -192,14 +192,36 @@ namespace hex::plugin::builtin {
 
         const auto &path = m_path.native();
 
-        m_diskHandle = ::open(path.c_str(), O_RDWR);
+        int flags = 0;
+        #if defined(OS_LINUX)
+            if (m_directIo)
+                flags |= O_DIRECT;
+        #endif
+
+        m_diskHandle = ::open(path.c_str(), O_RDWR | flags);
         if (m_diskHandle == -1) {
             this->setErrorMessage(hex::format("hex.builtin.provider.disk.error.read_rw"_lang, path, ::strerror(errno)));
             log::warn(this->getErrorMessage());
-            m_diskHandle = ::open(path.c_str(), O_RDONLY);
+            m_diskHandle = ::open(path.c_str(), O_RDONLY | flags);
             m_writable   = false;
         }
 
+        // Not every device and file system supports direct I/O, fall back to regular buffered access in that case
+        if (m_diskHandle == -1 && flags != 0) {
+            log::warn("Failed to open disk {} for direct I/O: {}", path, ::strerror(errno));
+            m_directIo   = false;
+            m_writable   = true;
+            this->setErrorMessage("");
+
+            m_diskHandle = ::open(path.c_str(), O_RDWR);
+            if (m_diskHandle == -1) {
+                this->setErrorMessage(hex::format("hex.builtin.provider.disk.error.read_rw"_lang, path, ::strerror(errno)));
+                log::warn(this->getErrorMessage());
+                m_diskHandle = ::open(path.c_str(), O_RDONLY);
+                m_writable   = false;
+            }
+        }
+
         if (m_diskHandle == -1) {
             this->setErrorMessage(hex::format("hex.builtin.provider.disk.error.read_ro"_lang, path, ::strerror(errno)));
             log::warn(this->getErrorMessage());
@@ -212,10 +234,22 @@ namespace hex::plugin::builtin {
         m_diskSize = diskSize;
         blkdev_get_sector_size(m_diskHandle, reinterpret_cast<int *>(&m_sectorSize));
 
-        m_sectorBuffer.resize(m_sectorSize);
+        #if defined(OS_MACOS)
+            if (m_directIo)
+                ::fcntl(m_diskHandle, F_NOCACHE, 1);
+        #endif
 
 #endif
 
+        if (m_sectorSize == 0)
+            m_sectorSize = 512;
+
+        // Cache whole groups of sectors so scrolling and searching doesn't need a syscall for every sector
+        m_cache.setBlockSize(std::max<size_t>(CacheBlockSize - (CacheBlockSize % m_sectorSize), m_sectorSize));
+        m_cache.setEndAddress(m_diskSize);
+        m_cache.setReadAheadBlocks(DefaultReadAheadBlocks);
+        m_cache.resetStatistics();
+
         return true;
     }
 
@@ -234,64 +268,128 @@ namespace hex::plugin::builtin {
 
         m_diskHandle = -1;
 
+        {
+            std::scoped_lock lock(m_directIoMutex);
+            m_directIoBuffer.clear();
+            m_directIoBuffer.shrink_to_fit();
+        }
+
 #endif
+
+        m_cache.invalidate();
     }
 
     void DiskProvider::readRaw(u64 offset, void *buffer, size_t size) {
+        m_cache.read(offset, buffer, size, [this](u64 address, void *blockBuffer, size_t blockSize) {
+            return this->readSectors(address, blockBuffer, blockSize);
+        });
+    }
+
+    bool DiskProvider::readSectors(u64 offset, void *buffer, size_t size) {
 #if defined(OS_WINDOWS)
 
+        // Pass the offset along with the request instead of seeking first. The block cache fetches from multiple threads at once
+        // and the handle's file pointer is shared between all of them
+        OVERLAPPED overlapped = { };
+        overlapped.Offset     = DWORD(offset & 0xFFFF'FFFF);
+        overlapped.OffsetHigh = DWORD(offset >> 32);
+
         DWORD bytesRead = 0;
+        return ::ReadFile(m_diskHandle, buffer, size, &bytesRead, &overlapped) != FALSE && bytesRead == size;
 
-            u64 startOffset = offset;
+#else
 
-            while (size > 0) {
-                LARGE_INTEGER seekPosition;
-                seekPosition.LowPart  = (offset & 0xFFFF'FFFF) - (offset % m_sectorSize);
-                seekPosition.HighPart = LONG(offset >> 32);
-
-                if (m_sectorBufferAddress != static_cast<u64>(seekPosition.QuadPart)) {
-                    ::SetFilePointer(m_diskHandle, seekPosition.LowPart, &seekPosition.HighPart, FILE_BEGIN);
-                    ::ReadFile(m_diskHandle, m_sectorBuffer.data(), m_sectorBuffer.size(), &bytesRead, nullptr);
-                    m_sectorBufferAddress = seekPosition.QuadPart;
-                }
+        auto bytes = static_cast<u8 *>(buffer);
 
-                std::memcpy(static_cast<u8 *>(buffer) + (offset - startOffset), m_sectorBuffer.data() + (offset & (m_sectorSize - 1)), std::min<u64>(m_sectorSize, size));
+        std::unique_lock lock(m_directIoMutex, std::defer_lock);
+        u8 *target = bytes;
+        if (m_directIo) {
+            lock.lock();
+            target = this->getDirectIoBuffer(size);
+        }
 
-                size = std::max<ssize_t>(static_cast<ssize_t>(size) - m_sectorSize, 0);
-                offset += m_sectorSize;
-            }
+        // A single request for the whole range, so fetching many sectors at once only costs one syscall
+        size_t bytesRead = 0;
+        while (bytesRead < size) {
+            const auto result = ::pread(m_diskHandle, target + bytesRead, size - bytesRead, offset + bytesRead);
+            if (result < 0 && errno == EINTR)
+                continue;
+            if (result <= 0)
+                return false;
 
-#else
+            bytesRead += result;
+        }
 
-        u64 startOffset    = offset;
+        if (target != bytes)
+            std::memcpy(bytes, target, size);
 
-        while (size > 0) {
-            u64 seekPosition = offset - (offset % m_sectorSize);
+        return true;
 
-            if (m_sectorBufferAddress != seekPosition || m_sectorBufferAddress == 0) {
-                ::lseek(m_diskHandle, seekPosition, SEEK_SET);
-                if (::read(m_diskHandle, m_sectorBuffer.data(), m_sectorBuffer.size()) == -1)
-                    break;
+#endif
+    }
 
-                m_sectorBufferAddress = seekPosition;
-            }
+    bool DiskProvider::writeSectors(u64 offset, const void *buffer, size_t size) {
+#if defined(OS_WINDOWS)
+
+        OVERLAPPED overlapped = { };
+        overlapped.Offset     = DWORD(offset & 0xFFFF'FFFF);
+        overlapped.OffsetHigh = DWORD(offset >> 32);
+
+        DWORD bytesWritten = 0;
+        return ::WriteFile(m_diskHandle, buffer, size, &bytesWritten, &overlapped) != FALSE && bytesWritten == size;
 
-            std::memcpy(reinterpret_cast<u8 *>(buffer) + (offset - startOffset),
-                        m_sectorBuffer.data() + (offset & (m_sectorSize - 1)),
-                        std::min<u64>(m_sectorSize, size));
+#else
+
+        auto bytes = static_cast<const u8 *>(buffer);
 
-            size = std::max<ssize_t>(static_cast<ssize_t>(size) - m_sectorSize, 0);
-            offset += m_sectorSize;
+        std::unique_lock lock(m_directIoMutex, std::defer_lock);
+        if (m_directIo) {
+            lock.lock();
+            auto alignedBuffer = this->getDirectIoBuffer(size);
+            std::memcpy(alignedBuffer, bytes, size);
+            bytes = alignedBuffer;
         }
 
+        size_t bytesWritten = 0;
+        while (bytesWritten < size) {
+            const auto result = ::pwrite(m_diskHandle, bytes + bytesWritten, size - bytesWritten, offset + bytesWritten);
+            if (result < 0 && errno == EINTR)
+                continue;
+            if (result <= 0)
+                return false;
+
+            bytesWritten += result;
+        }
+
+        return true;
+
+#endif
+    }
+
+#if !defined(OS_WINDOWS)
+    u8 *DiskProvider::getDirectIoBuffer(size_t size) {
+        const auto alignment = std::max<size_t>(DirectIoAlignment, m_sectorSize);
+        if (m_directIoBuffer.size() < size + alignment)
+            m_directIoBuffer.resize(size + alignment);
+
+        const auto address = reinterpret_cast<uintptr_t>(m_directIoBuffer.data());
+        return m_directIoBuffer.data() + ((alignment - (address % alignment)) % alignment);
+    }
 #endif
+
+    void DiskProvider::setSequentialAccessHint(bool sequential) {
+        // Read far ahead while the data is being scanned from start to end. Random access is better off with small fetches
+        m_cache.setReadAheadBlocks(sequential ? SequentialReadAheadBlocks : DefaultReadAheadBlocks);
+
+        #if defined(OS_LINUX)
+            if (m_diskHandle != -1)
+                ::posix_fadvise(m_diskHandle, 0, 0, sequential ? POSIX_FADV_SEQUENTIAL : POSIX_FADV_NORMAL);
+        #endif
     }
 
     void DiskProvider::writeRaw(u64 offset, const void *buffer, size_t size) {
 #if defined(OS_WINDOWS)
 
-        DWORD bytesWritten = 0;
-
             u64 startOffset = offset;
 
             std::vector<u8> modifiedSectorBuffer;
@@ -304,12 +402,10 @@ namespace hex::plugin::builtin {
                 this->readRaw(sectorBase, modifiedSectorBuffer.data(), modifiedSectorBuffer.size());
                 std::memcpy(modifiedSectorBuffer.data() + ((offset - sectorBase) % m_sectorSize), static_cast<const u8 *>(buffer) + (startOffset - offset), currSize);
 
-                LARGE_INTEGER seekPosition;
-                seekPosition.LowPart  = (offset & 0xFFFF'FFFF) - (offset % m_sectorSize);
-                seekPosition.HighPart = offset >> 32;
+                if (!this->writeSectors(sectorBase, modifiedSectorBuffer.data(), modifiedSectorBuffer.size()))
+                    break;
 
-                ::SetFilePointer(m_diskHandle, seekPosition.LowPart, &seekPosition.HighPart, FILE_BEGIN);
-                ::WriteFile(m_diskHandle, modifiedSectorBuffer.data(), modifiedSectorBuffer.size(), &bytesWritten, nullptr);
+                m_cache.update(sectorBase, modifiedSectorBuffer.data(), modifiedSectorBuffer.size());
 
                 offset += currSize;
                 size -= currSize;
@@ -317,24 +413,38 @@ namespace hex::plugin::builtin {
 
 #else
 
-        u64 startOffset = offset;
+        auto bytes = static_cast<const u8 *>(buffer);
 
-        std::vector<u8> modifiedSectorBuffer;
-        modifiedSectorBuffer.resize(m_sectorSize);
+        // Write whole runs of sectors at once instead of one sector at a time. Only the first and last sector
+        // of every run need their previous contents merged in
+        const size_t maxWriteSize = std::max<size_t>(MaxWriteSize - (MaxWriteSize % m_sectorSize), m_sectorSize);
 
+        std::vector<u8> modifiedSectorBuffer;
         while (size > 0) {
-            u64 sectorBase  = offset - (offset % m_sectorSize);
-            size_t currSize = std::min<u64>(size, m_sectorSize);
+            const u64 sectorBase  = offset - (offset % m_sectorSize);
+            const size_t currSize = std::min<u64>(size, maxWriteSize - (offset - sectorBase));
+            const u64 endAddress  = offset + currSize;
+            const u64 sectorEnd   = endAddress + ((m_sectorSize - (endAddress % m_sectorSize)) % m_sectorSize);
+
+            modifiedSectorBuffer.resize(sectorEnd - sectorBase);
 
-            this->readRaw(sectorBase, modifiedSectorBuffer.data(), modifiedSectorBuffer.size());
-            std::memcpy(modifiedSectorBuffer.data() + ((offset - sectorBase) % m_sectorSize), reinterpret_cast<const u8 *>(buffer) + (startOffset - offset), currSize);
+            // Sectors in between are overwritten entirely, there's no need to read them back
+            const u64 lastSectorBase = sectorEnd - m_sectorSize;
+            if (offset != sectorBase)
+                this->readRaw(sectorBase, modifiedSectorBuffer.data(), m_sectorSize);
+            if (endAddress != sectorEnd && (lastSectorBase != sectorBase || offset == sectorBase))
+                this->readRaw(lastSectorBase, modifiedSectorBuffer.data() + (lastSectorBase - sectorBase), m_sectorSize);
 
-            ::lseek(m_diskHandle, sectorBase, SEEK_SET);
-            if (::write(m_diskHandle, modifiedSectorBuffer.data(), modifiedSectorBuffer.size()) < 0)
+            std::memcpy(modifiedSectorBuffer.data() + (offset - sectorBase), bytes, currSize);
+
+            if (!this->writeSectors(sectorBase, modifiedSectorBuffer.data(), modifiedSectorBuffer.size()))
                 break;
 
+            m_cache.update(sectorBase, modifiedSectorBuffer.data(), modifiedSectorBuffer.size());
+
             offset += currSize;
-            size -= currSize;
+            bytes  += currSize;
+            size   -= currSize;
         }
 
 #endif
@@ -475,6 +585,9 @@ namespace hex::plugin::builtin {
                 m_friendlyName = m_pathBuffer;
             }
 
+            ImGui::Checkbox("hex.builtin.provider.disk.direct_io"_lang, &m_directIo);
+            ImGuiExt::InfoTooltip("hex.builtin.provider.disk.direct_io.tooltip"_lang);
+
         #endif
 
         return !m_path.empty();
@@ -484,6 +597,7 @@ namespace hex::plugin::builtin {
         settings["path"] = wolv::util::toUTF8String(m_path);
 
         settings["friendly_name"] = m_friendlyName;
+        settings["direct_io"] = m_directIo;
 
         return Provider::storeSettings(settings);
     }
@@ -495,6 +609,8 @@ namespace hex::plugin::builtin {
 
         if (settings.contains("friendly_name"))
             m_friendlyName = settings.at("friendly_name").get<std::string>();
+        if (settings.contains("direct_io"))
+            m_directIo = settings.at("direct_io").get<bool>();
 
         this->setPath(std::u8string(path.begin(), path.end()));
         this->reloadDrives();
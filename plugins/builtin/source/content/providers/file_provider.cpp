@@ -1,8 +1,10 @@
 #include "content/providers/file_provider.hpp"
 #include "content/providers/memory_file_provider.hpp"
 
+#include <cstdio>
 #include <cstring>
 
+#include <hex/api/content_registry.hpp>
 #include <hex/api/imhex_api.hpp>
 #include <hex/api/localization_manager.hpp>
 #include <hex/api/project_file_manager.hpp>
@@ -10,18 +12,288 @@
 
 #include <hex/helpers/utils.hpp>
 #include <hex/helpers/fmt.hpp>
+#include <hex/helpers/logger.hpp>
 #include <fmt/chrono.h>
 
 #include <wolv/utils/string.hpp>
 
 #include <nlohmann/json.hpp>
 
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <thread>
+
 #if defined(OS_WINDOWS)
     #include <windows.h>
+#else
+    #include <unistd.h>
+    #include <sys/stat.h>
+    #include <sys/xattr.h>
 #endif
 
 namespace hex::plugin::builtin {
 
+    namespace {
+
+        constexpr static u64 CopyChunkSize = 0x80'0000;
+        constexpr static size_t MaxPendingChunks = 4;
+
+        // Part of the provider's data that needs to end up at a specific offset in the output file
+        struct OutputSegment {
+            enum class Type {
+                Original,   // Unmodified data of the original file at sourceOffset
+                Memory,     // Data that is already in memory at data
+                Zero        // Zero bytes
+            } type;
+
+            u64 outputOffset;
+            u64 sourceOffset;
+            const u8 *data;
+            u64 size;
+        };
+
+        bool writeAt(wolv::io::File &file, u64 offset, const u8 *data, u64 size) {
+            #if defined(OS_WINDOWS)
+                file.seek(offset);
+                file.writeBuffer(data, size);
+
+                return std::ferror(file.getHandle()) == 0;
+            #else
+                const auto fd = ::fileno(file.getHandle());
+                while (size > 0) {
+                    const auto written = ::pwrite(fd, data, size, offset);
+                    if (written <= 0)
+                        return false;
+
+                    data   += written;
+                    offset += written;
+                    size   -= written;
+                }
+
+                return true;
+            #endif
+        }
+
+        /**
+         * @brief Lets the kernel copy a range of one file to another without passing the data through user space.
+         * Filesystems with reflink support share the data blocks between both files instead of copying them
+         * @return Number of bytes that were copied, less than size if the copy isn't supported
+         */
+        u64 copyFileRange(wolv::io::File &source, u64 sourceOffset, wolv::io::File &destination, u64 destinationOffset, u64 size) {
+            #if defined(OS_LINUX)
+                auto inOffset = off64_t(sourceOffset), outOffset = off64_t(destinationOffset);
+
+                u64 copied = 0;
+                while (copied < size) {
+                    const auto result = ::copy_file_range(::fileno(source.getHandle()), &inOffset, ::fileno(destination.getHandle()), &outOffset, size - copied, 0);
+                    if (result <= 0)
+                        break;
+
+                    copied += result;
+                }
+
+                return copied;
+            #else
+                hex::unused(source, sourceOffset, destination, destinationOffset, size);
+                return 0;
+            #endif
+        }
+
+        /**
+         * @brief Gives a new file the metadata of the file it's going to replace
+         * @note Replacing a file creates a new one. Hard links would keep pointing to the old file and extended attributes
+         * such as ACLs can't be carried over reliably, so those files have to be overwritten in place instead
+         * @return false if the new file can't end up looking like the old one
+         */
+        bool copyFileMetadata(const std::fs::path &path, const std::fs::path &newPath) {
+            #if defined(OS_WINDOWS)
+                // ReplaceFileW keeps the ACLs, attributes and streams of the original file, only hard links are lost
+                auto handle = CreateFileW(path.c_str(), 0, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+                if (handle == INVALID_HANDLE_VALUE)
+                    return false;
+
+                BY_HANDLE_FILE_INFORMATION fileInfo;
+                const bool singleLink = GetFileInformationByHandle(handle, &fileInfo) != FALSE && fileInfo.nNumberOfLinks == 1;
+                CloseHandle(handle);
+
+                hex::unused(newPath);
+                return singleLink;
+            #else
+                struct stat fileStat = { };
+                if (::stat(path.c_str(), &fileStat) != 0 || fileStat.st_nlink != 1)
+                    return false;
+
+                #if defined(OS_MACOS)
+                    const auto attributesSize = ::listxattr(path.c_str(), nullptr, 0, 0);
+                #else
+                    const auto attributesSize = ::listxattr(path.c_str(), nullptr, 0);
+                #endif
+
+                if (attributesSize > 0 || (attributesSize < 0 && errno != ENOTSUP))
+                    return false;
+
+                // Changing the owner may clear the set-user-ID bits, so the mode is applied afterwards
+                if (::chown(newPath.c_str(), fileStat.st_uid, fileStat.st_gid) != 0)
+                    return false;
+
+                return ::chmod(newPath.c_str(), fileStat.st_mode & 07777) == 0;
+            #endif
+        }
+
+        bool replaceFile(const std::fs::path &path, const std::fs::path &newPath) {
+            #if defined(OS_WINDOWS)
+                return ReplaceFileW(path.c_str(), newPath.c_str(), nullptr, 0, nullptr, nullptr) != FALSE;
+            #else
+                std::error_code error;
+                std::fs::rename(newPath, path, error);
+
+                return !error;
+            #endif
+        }
+
+        /**
+         * @brief Overwrites the contents of a file with the ones of another file. The file itself and its metadata stay untouched
+         */
+        bool overwriteFile(const std::fs::path &path, const std::fs::path &sourcePath) {
+            wolv::io::File source(sourcePath, wolv::io::File::Mode::Read);
+            wolv::io::File file(path, wolv::io::File::Mode::Write);
+            if (!source.isValid() || !file.isValid())
+                return false;
+
+            const u64 size = source.getSize();
+
+            u64 copied = copyFileRange(source, 0, file, 0, size);
+            std::vector<u8> buffer;
+            while (copied < size) {
+                const auto chunkSize = std::min<u64>(CopyChunkSize, size - copied);
+                buffer.resize(chunkSize);
+
+                source.seek(copied);
+                if (source.readBuffer(buffer.data(), chunkSize) != chunkSize || !writeAt(file, copied, buffer.data(), chunkSize))
+                    return false;
+
+                copied += chunkSize;
+            }
+
+            #if defined(OS_WINDOWS)
+                file.setSize(size);
+                return std::fflush(file.getHandle()) == 0 && std::ferror(file.getHandle()) == 0;
+            #else
+                return ::ftruncate(::fileno(file.getHandle()), off_t(size)) == 0;
+            #endif
+        }
+
+        /**
+         * @brief Splits the logical data of a file provider into the parts that need to be written to a new file
+         * @param pieceTable Layout of the data
+         * @param dirtyPages Pages of the original file that were modified in copy-on-write mode
+         * @param dirtyPageSize Size of a dirty page
+         */
+        std::vector<OutputSegment> getOutputSegments(const prv::PieceTable &pieceTable, const std::map<u64, std::vector<u8>> &dirtyPages, u64 dirtyPageSize) {
+            std::vector<OutputSegment> segments;
+
+            pieceTable.forEach(0, pieceTable.getSize(), [&](u64 outputOffset, const prv::PieceTable::Piece &piece) {
+                switch (piece.source) {
+                    using enum prv::PieceTable::Source;
+
+                    case Original: {
+                        // Pages modified in copy-on-write mode replace the corresponding parts of the original file
+                        const auto endOffset = piece.offset + piece.size;
+                        auto currOffset = piece.offset;
+                        for (auto it = dirtyPages.lower_bound(piece.offset - (piece.offset % dirtyPageSize)); it != dirtyPages.end() && it->first < endOffset; ++it) {
+                            const auto &[pageAddress, page] = *it;
+
+                            if (currOffset < pageAddress) {
+                                segments.push_back({ OutputSegment::Type::Original, outputOffset + (currOffset - piece.offset), currOffset, nullptr, pageAddress - currOffset });
+                                currOffset = pageAddress;
+                            }
+
+                            const auto copyEnd = std::min<u64>(endOffset, pageAddress + page.size());
+                            if (currOffset < copyEnd) {
+                                segments.push_back({ OutputSegment::Type::Memory, outputOffset + (currOffset - piece.offset), 0, page.data() + (currOffset - pageAddress), copyEnd - currOffset });
+                                currOffset = copyEnd;
+                            }
+                        }
+
+                        if (currOffset < endOffset)
+                            segments.push_back({ OutputSegment::Type::Original, outputOffset + (currOffset - piece.offset), currOffset, nullptr, endOffset - currOffset });
+                        break;
+                    }
+                    case Buffer:
+                        segments.push_back({ OutputSegment::Type::Memory, outputOffset, 0, pieceTable.getBufferData(piece.offset), piece.size });
+                        break;
+                    case Zero:
+                        segments.push_back({ OutputSegment::Type::Zero, outputOffset, 0, nullptr, piece.size });
+                        break;
+                }
+            });
+
+            return segments;
+        }
+
+        /**
+         * @brief Bounded queue that hands chunks of data from the thread reading them to the thread writing them
+         */
+        class ChunkQueue {
+        public:
+            struct Chunk {
+                u64 outputOffset;
+                std::vector<u8> data;
+            };
+
+            void push(Chunk &&chunk) {
+                std::unique_lock lock(m_mutex);
+                m_notFull.wait(lock, [this] { return m_chunks.size() < MaxPendingChunks || m_aborted; });
+                if (m_aborted)
+                    return;
+
+                m_chunks.emplace_back(std::move(chunk));
+                m_notEmpty.notify_one();
+            }
+
+            std::optional<Chunk> pop() {
+                std::unique_lock lock(m_mutex);
+                m_notEmpty.wait(lock, [this] { return !m_chunks.empty() || m_finished; });
+                if (m_chunks.empty())
+                    return std::nullopt;
+
+                auto chunk = std::move(m_chunks.front());
+                m_chunks.pop_front();
+                m_notFull.notify_one();
+
+                return chunk;
+            }
+
+            // Called by the reading thread once all chunks have been pushed
+            void finish() {
+                std::scoped_lock lock(m_mutex);
+                m_finished = true;
+                m_notEmpty.notify_all();
+            }
+
+            // Called by the writing thread if writing failed, so the reading thread stops
+            void abort() {
+                std::scoped_lock lock(m_mutex);
+                m_aborted = true;
+                m_notFull.notify_all();
+            }
+
+            [[nodiscard]] bool isAborted() {
+                std::scoped_lock lock(m_mutex);
+                return m_aborted;
+            }
+
+        private:
+            std::mutex m_mutex;
+            std::condition_variable m_notFull, m_notEmpty;
+            std::deque<Chunk> m_chunks;
+            bool m_finished = false, m_aborted = false;
+        };
+
+    }
+
     bool FileProvider::isAvailable() const {
         return true;
     }
@@ -43,20 +315,123 @@ namespace hex::plugin::builtin {
     }
 
     void FileProvider::readRaw(u64 offset, void *buffer, size_t size) {
-        if (m_fileSize == 0 || (offset + size) > m_fileSize || buffer == nullptr || size == 0)
+        if ((offset + size) > this->getActualSize() || buffer == nullptr || size == 0)
+            return;
+
+        if (!m_pieceTable.isModified()) {
+            this->readOriginal(offset, buffer, size);
             return;
+        }
 
-        std::memcpy(buffer, m_file.getMapping() + offset, size);
+        m_pieceTable.read(offset, buffer, size, [this](u64 fileOffset, void *pieceBuffer, size_t pieceSize) {
+            this->readOriginal(fileOffset, pieceBuffer, pieceSize);
+        });
     }
 
     void FileProvider::writeRaw(u64 offset, const void *buffer, size_t size) {
         if ((offset + size) > this->getActualSize() || buffer == nullptr || size == 0)
             return;
 
-        std::memcpy(m_file.getMapping() + offset, buffer, size);
+        if (!m_pieceTable.isModified()) {
+            this->writeOriginal(offset, buffer, size);
+            return;
+        }
+
+        m_pieceTable.write(offset, buffer, size, [this](u64 fileOffset, const void *pieceBuffer, size_t pieceSize) {
+            this->writeOriginal(fileOffset, pieceBuffer, pieceSize);
+        });
+    }
+
+    std::optional<std::span<const u8>> FileProvider::getRawSpan(u64 offset, size_t size) {
+        if ((offset + size) > this->getActualSize() || size == 0)
+            return std::nullopt;
+
+        // The range can only be handed out directly if it's backed by a single contiguous piece
+        std::optional<prv::PieceTable::Piece> backingPiece;
+        bool contiguous = true;
+        m_pieceTable.forEach(offset, size, [&](u64, const prv::PieceTable::Piece &piece) {
+            if (backingPiece.has_value())
+                contiguous = false;
+            backingPiece = piece;
+        });
+
+        if (!contiguous || !backingPiece.has_value())
+            return std::nullopt;
+
+        switch (backingPiece->source) {
+            using enum prv::PieceTable::Source;
+
+            case Original: {
+                // Pages that were modified in copy-on-write mode don't match the mapping anymore
+                const auto fileOffset = backingPiece->offset;
+                if (auto it = m_dirtyPages.lower_bound(fileOffset - (fileOffset % DirtyPageSize)); it != m_dirtyPages.end() && it->first < fileOffset + size)
+                    return std::nullopt;
+
+                return std::span<const u8>(m_file.getMapping() + fileOffset, size);
+            }
+            case Buffer:
+                return std::span<const u8>(m_pieceTable.getBufferData(backingPiece->offset), size);
+            default:
+                return std::nullopt;
+        }
     }
 
     void FileProvider::save() {
+        {
+            // Saving replaces the mapping and moves the edits around without going through the apply functions
+            std::unique_lock lock(this->getDataMutex());
+
+            if (m_pieceTable.isModified()) {
+                // Data has been inserted or removed since the file was opened. The original file is still needed as the source
+                // of all unmodified data, so the new layout is streamed into a temporary file first
+                auto tempPath = m_path;
+                tempPath += ".tmp";
+
+                std::error_code error;
+                bool replace = this->writeToFile(tempPath);
+                if (replace) {
+                    replace = copyFileMetadata(m_path, tempPath);
+                } else {
+                    // The file's directory may not be writable, use the system's temporary directory and copy the data back instead
+                    std::fs::remove(tempPath, error);
+
+                    tempPath = std::fs::temp_directory_path(error) / tempPath.filename();
+                    if (error || !this->writeToFile(tempPath)) {
+                        log::error("Failed to write changes to '{}'", wolv::util::toUTF8String(tempPath));
+
+                        std::fs::remove(tempPath, error);
+                        return;
+                    }
+                }
+
+                // The original file cannot be replaced or resized while it's still mapped on some platforms
+                this->close();
+
+                // Replacing the file is atomic. If that's not possible, overwrite the original file with the new data in place
+                if (replace)
+                    replace = replaceFile(m_path, tempPath);
+
+                if (!replace && !overwriteFile(m_path, tempPath)) {
+                    // The original file may have been partially overwritten already, so the edits can't be applied to it anymore
+                    log::error("Failed to write changes to '{}', they have been kept in '{}'", wolv::util::toUTF8String(m_path), wolv::util::toUTF8String(tempPath));
+                    this->open();
+                    return;
+                }
+
+                std::fs::remove(tempPath, error);
+
+                // Reopening the file starts over with a fresh piece table, which drops the append buffer as well
+                if (!this->open())
+                    return;
+            } else if (!this->flushDirtyPages()) {
+                log::error("Failed to write changes to '{}'", wolv::util::toUTF8String(m_path));
+                return;
+            } else {
+                // Data written to pieces that were removed again afterwards is still held in the append buffer
+                m_pieceTable.reset(m_pieceTable.getSize());
+            }
+        }
+
         #if defined(OS_WINDOWS)
             FILETIME ft;
             SYSTEMTIME st;
@@ -75,70 +450,207 @@ namespace hex::plugin::builtin {
     }
 
     void FileProvider::saveAs(const std::fs::path &path) {
-        if (path == m_path)
+        if (path == m_path) {
             this->save();
-        else
+            return;
+        }
+
+        // Overlays are only applied by the generic implementation that reads all data through the provider
+        if (!m_overlays.empty()) {
             Provider::saveAs(path);
+            return;
+        }
+
+        {
+            std::shared_lock lock(this->getDataMutex());
+            if (!this->writeToFile(path)) {
+                log::error("Failed to write '{}'", wolv::util::toUTF8String(path));
+                return;
+            }
+        }
+
+        EventProviderSaved::post(this);
     }
 
     void FileProvider::resizeRaw(u64 newSize) {
-        this->close();
+        m_pieceTable.resize(newSize);
+    }
 
-        {
-            wolv::io::File file(m_path, wolv::io::File::Mode::Write);
+    void FileProvider::insertRaw(u64 offset, u64 size) {
+        m_pieceTable.insert(offset, size);
+    }
 
-            file.setSize(newSize);
-        }
+    void FileProvider::removeRaw(u64 offset, u64 size) {
+        if (offset > this->getActualSize() || size == 0)
+            return;
 
-        (void)this->open();
+        m_pieceTable.remove(offset, size);
     }
 
-    void FileProvider::insertRaw(u64 offset, u64 size) {
-        auto oldSize = this->getActualSize();
-        this->resizeRaw(oldSize + size);
+    u64 FileProvider::getActualSize() const {
+        return m_pieceTable.getSize();
+    }
+
+    bool FileProvider::writeToFile(const std::fs::path &path) {
+        wolv::io::File file(path, wolv::io::File::Mode::Create);
+        if (!file.isValid())
+            return false;
+
+        const auto segments = getOutputSegments(m_pieceTable, m_dirtyPages, DirtyPageSize);
+        bool success = true;
+
+        // Size the file up front so all segments can be written independently of each other. Zero filled ranges stay holes
+        #if defined(OS_WINDOWS)
+            constexpr bool ZeroFilled = false;
+        #else
+            constexpr bool ZeroFilled = true;
+            success = ::ftruncate(::fileno(file.getHandle()), off_t(this->getActualSize())) == 0;
+        #endif
 
-        std::vector<u8> buffer(0x1000);
-        const std::vector<u8> zeroBuffer(0x1000);
+        // Unmodified ranges are copied by the kernel if possible. Whatever it can't copy is read from the mapping instead
+        wolv::io::File source(m_path, wolv::io::File::Mode::Read);
+        bool kernelCopy = source.isValid();
 
-        auto position = oldSize;
-        while (position > offset) {
-            const auto readSize = std::min<size_t>(position - offset, buffer.size());
+        std::vector<OutputSegment> readSegments;
+        for (const auto &segment : segments) {
+            if (!success)
+                break;
 
-            position -= readSize;
+            switch (segment.type) {
+                using enum OutputSegment::Type;
 
-            this->readRaw(position, buffer.data(), readSize);
-            this->writeRaw(position, zeroBuffer.data(), readSize);
-            this->writeRaw(position + size, buffer.data(), readSize);
+                case Original: {
+                    u64 copied = 0;
+                    if (kernelCopy) {
+                        copied = copyFileRange(source, segment.sourceOffset, file, segment.outputOffset, segment.size);
+                        kernelCopy = copied == segment.size;
+                    }
+
+                    if (copied < segment.size)
+                        readSegments.push_back({ Original, segment.outputOffset + copied, segment.sourceOffset + copied, nullptr, segment.size - copied });
+                    break;
+                }
+                case Memory:
+                    success = writeAt(file, segment.outputOffset, segment.data, segment.size);
+                    break;
+                case Zero:
+                    if (!ZeroFilled)
+                        readSegments.push_back(segment);
+                    break;
+            }
         }
+
+        // Read the remaining data on a separate thread while this one writes it out
+        if (success && !readSegments.empty()) {
+            ChunkQueue queue;
+
+            std::thread readerThread([&] {
+                const auto mapping = m_file.getMapping();
+                for (const auto &segment : readSegments) {
+                    for (u64 offset = 0; offset < segment.size && !queue.isAborted(); offset += CopyChunkSize) {
+                        const auto chunkSize = std::min<u64>(CopyChunkSize, segment.size - offset);
+
+                        std::vector<u8> data(chunkSize);
+                        if (segment.type == OutputSegment::Type::Original)
+                            std::memcpy(data.data(), mapping + segment.sourceOffset + offset, chunkSize);
+
+                        queue.push({ segment.outputOffset + offset, std::move(data) });
+                    }
+                }
+
+                queue.finish();
+            });
+
+            while (auto chunk = queue.pop()) {
+                if (!writeAt(file, chunk->outputOffset, chunk->data.data(), chunk->data.size())) {
+                    success = false;
+                    queue.abort();
+                    break;
+                }
+            }
+
+            readerThread.join();
+        }
+
+        return success && std::fflush(file.getHandle()) == 0 && std::ferror(file.getHandle()) == 0;
     }
 
-    void FileProvider::removeRaw(u64 offset, u64 size) {
-        if (offset > this->getActualSize() || size == 0)
+    void FileProvider::readOriginal(u64 offset, void *buffer, size_t size) {
+        auto bytes = static_cast<u8*>(buffer);
+        const auto mapping = m_file.getMapping();
+
+        if (m_dirtyPages.empty()) {
+            std::memcpy(bytes, mapping + offset, size);
             return;
+        }
 
-        if ((offset + size) > this->getActualSize())
-            size = this->getActualSize() - offset;
+        // Fill the buffer from the mapping and patch in all dirty pages that overlap the requested range
+        const auto endOffset = offset + size;
+        auto currOffset = offset;
+        for (auto it = m_dirtyPages.lower_bound(offset - (offset % DirtyPageSize)); it != m_dirtyPages.end() && it->first < endOffset; ++it) {
+            const auto &[pageAddress, page] = *it;
 
-        auto oldSize = this->getActualSize();
+            if (currOffset < pageAddress) {
+                std::memcpy(bytes + (currOffset - offset), mapping + currOffset, pageAddress - currOffset);
+                currOffset = pageAddress;
+            }
 
-        std::vector<u8> buffer(0x1000);
+            const auto copyEnd = std::min<u64>(endOffset, pageAddress + page.size());
+            std::memcpy(bytes + (currOffset - offset), page.data() + (currOffset - pageAddress), copyEnd - currOffset);
+            currOffset = copyEnd;
+        }
 
-        const auto newSize = oldSize - size;
-        auto position = offset;
-        while (position < newSize) {
-            const auto readSize = std::min<size_t>(newSize - position, buffer.size());
+        if (currOffset < endOffset)
+            std::memcpy(bytes + (currOffset - offset), mapping + currOffset, endOffset - currOffset);
+    }
 
-            this->readRaw(position + size, buffer.data(), readSize);
-            this->writeRaw(position, buffer.data(), readSize);
+    void FileProvider::writeOriginal(u64 offset, const void *buffer, size_t size) {
+        auto bytes = static_cast<const u8*>(buffer);
+        const auto mapping = m_file.getMapping();
 
-            position += readSize;
+        if (!m_copyOnWrite) {
+            std::memcpy(mapping + offset, bytes, size);
+            return;
         }
 
-        this->resizeRaw(newSize);
+        const auto endOffset = offset + size;
+        for (auto currOffset = offset; currOffset < endOffset;) {
+            const auto pageAddress = currOffset - (currOffset % DirtyPageSize);
+
+            // Copy the page out of the mapping the first time it gets modified
+            auto &page = m_dirtyPages[pageAddress];
+            if (page.empty()) {
+                page.resize(std::min<u64>(DirtyPageSize, m_fileSize - pageAddress));
+                std::memcpy(page.data(), mapping + pageAddress, page.size());
+            }
+
+            const auto copyEnd = std::min<u64>(endOffset, pageAddress + page.size());
+            std::memcpy(page.data() + (currOffset - pageAddress), bytes + (currOffset - offset), copyEnd - currOffset);
+            currOffset = copyEnd;
+        }
     }
 
-    u64 FileProvider::getActualSize() const {
-        return m_fileSize;
+    bool FileProvider::flushDirtyPages() {
+        if (m_dirtyPages.empty())
+            return true;
+
+        wolv::io::File file(m_path, wolv::io::File::Mode::Write);
+        if (!file.isValid())
+            return false;
+
+        // Pages are ordered by address so they get written back in a single forward pass over the file
+        for (const auto &[pageAddress, page] : m_dirtyPages) {
+            file.seek(pageAddress);
+            file.writeBuffer(page.data(), page.size());
+        }
+
+        if (std::fflush(file.getHandle()) != 0 || std::ferror(file.getHandle()) != 0)
+            return false;
+
+        // The mapping shares the page cache with the file we just wrote to so it now contains the new data
+        m_dirtyPages.clear();
+
+        return true;
     }
 
     std::string FileProvider::getName() const {
@@ -211,6 +723,8 @@ namespace hex::plugin::builtin {
     bool FileProvider::open() {
         m_readable = true;
         m_writable = true;
+        m_copyOnWrite = ContentRegistry::Settings::read("hex.builtin.setting.general", "hex.builtin.setting.general.file_copy_on_write", false);
+        m_dirtyPages.clear();
 
         if (!std::fs::exists(m_path)) {
             this->setErrorMessage(hex::format("hex.builtin.provider.file.error.open"_lang, m_path.string(), ::strerror(ENOENT)));
@@ -229,6 +743,15 @@ namespace hex::plugin::builtin {
             }
         }
 
+        // Modifications never touch the mapping in copy-on-write mode, map the file read-only in that case
+        if (m_writable && m_copyOnWrite) {
+            file = wolv::io::File(m_path, wolv::io::File::Mode::Read);
+            if (!file.isValid()) {
+                this->setErrorMessage(hex::format("hex.builtin.provider.file.error.open"_lang, m_path.string(), ::strerror(errno)));
+                return false;
+            }
+        }
+
         m_fileStats = file.getFileInfo();
         m_file      = std::move(file);
 
@@ -238,6 +761,7 @@ namespace hex::plugin::builtin {
         }
 
         m_fileSize = m_file.getSize();
+        m_pieceTable.reset(m_fileSize);
 
         m_file.close();
 
@@ -246,6 +770,7 @@ namespace hex::plugin::builtin {
 
     void FileProvider::close() {
         m_file.unmap();
+        m_dirtyPages.clear();
     }
 
     void FileProvider::loadSettings(const nlohmann::json &settings) {
@@ -303,17 +828,23 @@ namespace hex::plugin::builtin {
                         ImHexApi::Provider::remove(memoryProvider);
                     });
 
-                    constexpr static size_t BufferSize = 0x10000;
-                    std::vector<u8> buffer(BufferSize);
+                    // Every chunk of the memory file is filled independently, so they can all be read in parallel
+                    constexpr static auto ChunkSize = prv::ChunkedBuffer::ChunkSize;
+                    std::vector<std::vector<u8>> chunks((size + ChunkSize - 1) / ChunkSize);
 
-                    memoryProvider->resize(size);
+                    TaskManager::parallelFor(task, chunks.size(), [&](u64 index) {
+                        auto &chunk = chunks[index];
+                        chunk.resize(std::min<u64>(ChunkSize, size - index * ChunkSize));
 
-                    for (u64 i = 0; i < size; i += BufferSize) {
-                        auto copySize = std::min<size_t>(BufferSize, size - i);
-                        this->read(i, buffer.data(), copySize, true);
-                        memoryProvider->writeRaw(i, buffer.data(), copySize);
-                        task.update(i);
-                    }
+                        this->read(index * ChunkSize, chunk.data(), chunk.size(), true);
+                    });
+
+                    prv::ChunkedBuffer data;
+                    for (auto &chunk : chunks)
+                        data.append(std::move(chunk));
+
+                    memoryProvider->resize(size);
+                    memoryProvider->setData(std::move(data));
 
                     memoryProvider->markDirty(true);
                     memoryProvider->getUndoStack().reset();
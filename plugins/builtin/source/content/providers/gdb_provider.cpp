@@ -1,8 +1,11 @@
 #include "content/providers/gdb_provider.hpp"
 
+#include <algorithm>
 #include <cstring>
+#include <deque>
 #include <thread>
 #include <chrono>
+#include <unordered_map>
 
 #include <imgui.h>
 #include <hex/ui/imgui_imhex_extensions.h>
@@ -11,21 +14,24 @@
 #include <hex/helpers/crypto.hpp>
 #include <hex/api/localization_manager.hpp>
 
+#include <wolv/utils/string.hpp>
+
 #include <nlohmann/json.hpp>
 
 namespace hex::plugin::builtin {
 
-    using namespace std::chrono_literals;
-
     namespace gdb {
 
         namespace {
 
-            u8 calculateChecksum(const std::string &data) {
+            // Number of memory read requests that are sent before waiting for their responses
+            constexpr static size_t MaxPipelinedRequests = 16;
+
+            u8 calculateChecksum(std::string_view data) {
                 u64 checksum = 0;
 
                 for (const auto &c : data)
-                    checksum += c;
+                    checksum += u8(c);
 
                 return checksum & 0xFF;
             }
@@ -34,104 +40,268 @@ namespace hex::plugin::builtin {
                 return hex::format("${}#{:02x}", data, calculateChecksum(data));
             }
 
-            std::optional<std::string> parsePacket(const std::string &packet) {
+            void sendPacket(Connection &connection, const std::string &data) {
+                connection.socket.writeString(createPacket(data));
+            }
+
+            std::optional<std::string> parsePacket(std::string_view packet) {
                 if (packet.length() < 4)
                     return std::nullopt;
 
-                if (!packet.starts_with('$'))
+                if (!packet.starts_with('$') && !packet.starts_with('%'))
                     return std::nullopt;
 
                 if (packet[packet.length() - 3] != '#')
                     return std::nullopt;
 
-                std::string data     = packet.substr(1, packet.length() - 4);
-                std::string checksum = packet.substr(packet.length() - 2, 2);
+                auto data     = packet.substr(1, packet.length() - 4);
+                auto checksum = std::string(packet.substr(packet.length() - 2, 2));
 
                 auto decodedChecksum = crypt::decode16(checksum);
                 if (checksum.length() != 2 || decodedChecksum.empty() || decodedChecksum[0] != calculateChecksum(data))
                     return std::nullopt;
 
-                return data;
+                // Expand run-length encoded sections. A '*' repeats the previous character (N - 29) more times
+                std::string result;
+                result.reserve(data.size());
+                for (size_t i = 0; i < data.size(); i += 1) {
+                    if (data[i] == '*' && !result.empty() && i + 1 < data.size()) {
+                        const auto count = u8(data[i + 1]) - 29;
+                        if (count > 0)
+                            result.append(count, result.back());
+
+                        i += 1;
+                    } else {
+                        result.push_back(data[i]);
+                    }
+                }
+
+                return result;
+            }
+
+            /**
+             * @brief Receives the next packet from the server
+             * @return Payload of the packet, an empty string if it was corrupted or std::nullopt if the connection was lost
+             */
+            std::optional<std::string> receivePacket(Connection &connection) {
+                auto &buffer = connection.receiveBuffer;
+
+                while (true) {
+                    // Drop acknowledgements and anything else in front of the next packet
+                    const auto packetStart = buffer.find_first_of("$%");
+                    if (packetStart == std::string::npos)
+                        buffer.clear();
+                    else
+                        buffer.erase(0, packetStart);
+
+                    if (!buffer.empty()) {
+                        // '#' is always escaped inside of packets so the first one marks the end of the packet
+                        if (const auto packetEnd = buffer.find('#'); packetEnd != std::string::npos && packetEnd + 2 < buffer.size()) {
+                            const auto isNotification = buffer.front() == '%';
+                            auto data = parsePacket(std::string_view(buffer).substr(0, packetEnd + 3));
+                            buffer.erase(0, packetEnd + 3);
+
+                            // Asynchronous notifications are never responses to a request
+                            if (isNotification)
+                                continue;
+
+                            return data.value_or("");
+                        }
+                    }
+
+                    auto received = connection.socket.readString(0x4000);
+                    if (received.empty())
+                        return std::nullopt;
+
+                    buffer += received;
+                }
+            }
+
+            bool isStopReply(std::string_view data) {
+                if (data.empty())
+                    return false;
+
+                switch (data.front()) {
+                    case 'T':
+                    case 'S':
+                    case 'W':
+                    case 'X':
+                        return true;
+                    case 'O':
+                        return data != "OK";
+                    default:
+                        return false;
+                }
+            }
+
+            /**
+             * @brief Receives the response to a previously sent request
+             * @note The target may stop or print console output at any time. Those packets are skipped
+             */
+            std::optional<std::string> receiveResponse(Connection &connection) {
+                while (true) {
+                    auto data = receivePacket(connection);
+                    if (!data.has_value() || !isStopReply(*data))
+                        return data;
+                }
+            }
+
+            std::string createMemoryReadPacket(const Connection &connection, u64 address, size_t size) {
+                if (connection.binaryReads)
+                    return createPacket(hex::format("x{:X},{:X}", address, size));
+                else
+                    return createPacket(hex::format("m{:X},{:X}", address, size));
+            }
+
+            bool decodeMemoryReadResponse(const Connection &connection, std::string_view response, u8 *buffer, size_t size) {
+                if (response.empty() || (response.size() == 3 && response.starts_with('E')))
+                    return false;
+
+                if (connection.binaryReads) {
+                    if (!response.starts_with('b'))
+                        return false;
+
+                    // Escaped bytes are prefixed with '}' and XORed with 0x20
+                    size_t bytesDecoded = 0;
+                    for (size_t i = 1; i < response.size() && bytesDecoded < size; i += 1) {
+                        if (response[i] == '}') {
+                            if (i + 1 >= response.size())
+                                return false;
+
+                            i += 1;
+                            buffer[bytesDecoded] = u8(response[i]) ^ 0x20;
+                        } else {
+                            buffer[bytesDecoded] = u8(response[i]);
+                        }
+
+                        bytesDecoded += 1;
+                    }
+
+                    return bytesDecoded == size;
+                } else {
+                    if (response.size() != size * 2)
+                        return false;
+
+                    auto data = crypt::decode16(std::string(response));
+                    if (data.size() != size)
+                        return false;
+
+                    std::memcpy(buffer, data.data(), size);
+
+                    return true;
+                }
             }
 
         }
 
-        void sendAck(const wolv::net::SocketClient &socket) {
-            socket.writeString("+");
+        void sendAck(Connection &connection) {
+            connection.socket.writeString("+");
         }
 
-        void continueExecution(const wolv::net::SocketClient &socket) {
-            socket.writeString(createPacket("vCont;c"));
+        void continueExecution(Connection &connection) {
+            sendPacket(connection, "vCont;c");
         }
 
-        std::vector<u8> readMemory(const wolv::net::SocketClient &socket, u64 address, size_t size) {
-            std::string packet = createPacket(hex::format("m{:X},{:X}", address, size));
+        /**
+         * @brief Reads a range of memory from the target
+         * @note The range is split into requests that fit into the server's packet buffer. Multiple requests are sent
+         * at once without waiting for the previous responses, so the latency of the connection is only paid once per batch
+         */
+        bool readMemory(Connection &connection, u64 address, void *buffer, size_t size) {
+            auto bytes = static_cast<u8 *>(buffer);
 
-            socket.writeString(packet);
+            std::deque<std::pair<u64, size_t>> pendingRequests;
+            u64 nextOffset = 0;
+            bool success = true;
 
-            auto receivedPacket = socket.readString(size * 2 + 4);
+            while (nextOffset < size || !pendingRequests.empty()) {
+                std::string requests;
+                while (nextOffset < size && pendingRequests.size() < MaxPipelinedRequests) {
+                    const auto requestSize = std::min<u64>(connection.maxReadSize, size - nextOffset);
 
-            if (receivedPacket.empty())
-                return {};
+                    requests += createMemoryReadPacket(connection, address + nextOffset, requestSize);
+                    pendingRequests.emplace_back(nextOffset, requestSize);
 
-            auto receivedData = parsePacket(receivedPacket);
-            if (!receivedData.has_value())
-                return {};
+                    nextOffset += requestSize;
+                }
+
+                if (!requests.empty())
+                    connection.socket.writeString(requests);
 
-            if (receivedData->size() == 3 && receivedData->starts_with("E"))
-                return {};
+                auto response = receiveResponse(connection);
+                if (!response.has_value())
+                    return false;
 
-            auto data = crypt::decode16(receivedData.value());
+                // Keep receiving the remaining responses after a failure so the next request doesn't get them
+                const auto [offset, requestSize] = pendingRequests.front();
+                pendingRequests.pop_front();
 
-            data.resize(size);
+                if (!decodeMemoryReadResponse(connection, *response, bytes + offset, requestSize))
+                    success = false;
+            }
 
-            return data;
+            return success;
         }
 
-        void writeMemory(const wolv::net::SocketClient &socket, u64 address, const void *buffer, size_t size) {
+        bool writeMemory(Connection &connection, u64 address, const void *buffer, size_t size) {
             std::vector<u8> bytes(size);
             std::memcpy(bytes.data(), buffer, size);
 
             std::string byteString = crypt::encode16(bytes);
 
-            std::string packet = createPacket(hex::format("M{:X},{:X}:{}", address, size, byteString));
+            sendPacket(connection, hex::format("M{:X},{:X}:{}", address, size, byteString));
 
-            socket.writeString(packet);
-
-            auto receivedPacket = socket.readString(6);
+            auto response = receiveResponse(connection);
+            return response.has_value() && *response == "OK";
         }
 
-        bool enableNoAckMode(const wolv::net::SocketClient &socket) {
-            socket.writeString(createPacket("QStartNoAckMode"));
-
-            auto ack = socket.readString(1);
+        bool enableNoAckMode(Connection &connection) {
+            sendPacket(connection, "QStartNoAckMode");
 
-            if (ack.empty() || ack[0] != '+')
-                return false;
-
-            auto receivedPacket = socket.readString(6);
-
-            auto receivedData = parsePacket(receivedPacket);
+            auto response = receivePacket(connection);
 
-            if (receivedData && *receivedData == "OK") {
-                sendAck(socket);
+            if (response && *response == "OK") {
+                sendAck(connection);
                 return true;
             } else {
                 return false;
             }
         }
 
+        /**
+         * @brief Queries the features supported by the server and configures the connection accordingly
+         */
+        void queryFeatures(Connection &connection) {
+            sendPacket(connection, "qSupported:binary-upload+");
+
+            auto response = receiveResponse(connection);
+            if (!response.has_value())
+                return;
+
+            for (const auto &feature : wolv::util::splitString(*response, ";")) {
+                if (feature == "binary-upload+") {
+                    connection.binaryReads = true;
+                } else if (feature.starts_with("PacketSize=")) {
+                    const auto packetSize = std::strtoull(feature.c_str() + 11, nullptr, 16);
+
+                    // Leave room for the packet framing. Every byte may need two characters in the response
+                    if (packetSize > 0x20)
+                        connection.maxReadSize = std::min<u64>((packetSize - 0x10) / 2, 0x10000);
+                }
+            }
+        }
+
     }
 
     GDBProvider::GDBProvider() : m_size(0xFFFF'FFFF) {
     }
 
     bool GDBProvider::isAvailable() const {
-        return m_socket.isConnected();
+        return m_connection.socket.isConnected();
     }
 
     bool GDBProvider::isReadable() const {
-        return m_socket.isConnected();
+        return m_connection.socket.isConnected();
     }
 
     bool GDBProvider::isWritable() const {
@@ -152,38 +322,11 @@ namespace hex::plugin::builtin {
 
         offset -= this->getBaseAddress();
 
-        u64 alignedOffset = offset - (offset % CacheLineSize);
-
-        if (size <= CacheLineSize) {
-            std::scoped_lock lock(m_cacheLock);
-
-            const auto &cacheLine = std::find_if(m_cache.begin(), m_cache.end(), [&](auto &line) {
-                return line.address == alignedOffset;
-            });
-
-            if (cacheLine != m_cache.end()) {
-                // Cache hit
-
-            } else {
-                // Cache miss
-
-                m_cache.push_back({ alignedOffset, { 0 } });
-            }
-
-            if (cacheLine != m_cache.end())
-                std::memcpy(buffer, &cacheLine->data[0] + (offset % CacheLineSize), std::min<u64>(size, cacheLine->data.size()));
-        } else {
-            while (size > 0) {
-                size_t readSize = std::min<u64>(size, CacheLineSize);
-
-                auto data = gdb::readMemory(m_socket, offset, size);
-                if (!data.empty())
-                    std::memcpy(buffer, &data[0], data.size());
+        m_cache.read(offset, buffer, size, [this](u64 address, void *blockBuffer, size_t blockSize) {
+            std::scoped_lock lock(m_socketLock);
 
-                size -= readSize;
-                offset += readSize;
-            }
-        }
+            return gdb::readMemory(m_connection, address, blockBuffer, blockSize);
+        });
     }
 
     void GDBProvider::writeRaw(u64 offset, const void *buffer, size_t size) {
@@ -192,7 +335,16 @@ namespace hex::plugin::builtin {
 
         offset -= this->getBaseAddress();
 
-        gdb::writeMemory(m_socket, offset, buffer, size);
+        bool success;
+        {
+            std::scoped_lock lock(m_socketLock);
+            success = gdb::writeMemory(m_connection, offset, buffer, size);
+        }
+
+        if (success)
+            m_cache.update(offset, buffer, size);
+        else
+            m_cache.invalidate(offset, size);
     }
 
     void GDBProvider::save() {
@@ -222,46 +374,28 @@ namespace hex::plugin::builtin {
     }
 
     bool GDBProvider::open() {
-        m_socket = wolv::net::SocketClient(wolv::net::SocketClient::Type::TCP);
-        m_socket.connect(m_ipAddress, m_port);
-        if (!gdb::enableNoAckMode(m_socket)) {
-            m_socket.disconnect();
+        m_connection = { };
+        m_connection.socket = wolv::net::SocketClient(wolv::net::SocketClient::Type::TCP);
+        m_connection.socket.connect(m_ipAddress, m_port);
+        if (!gdb::enableNoAckMode(m_connection)) {
+            m_connection.socket.disconnect();
             return false;
         }
 
-        if (m_socket.isConnected()) {
-            gdb::continueExecution(m_socket);
-
-            m_cacheUpdateThread = std::thread([this] {
-                auto cacheLine = m_cache.begin();
-                while (this->isConnected()) {
-                    {
-                        std::scoped_lock lock(m_cacheLock);
-
-                        if (m_resetCache) {
-                            m_cache.clear();
-                            m_resetCache = false;
-                            cacheLine = m_cache.begin();
-                        }
-
-                        if (cacheLine != m_cache.end()) {
-                            std::vector<u8> data = gdb::readMemory(m_socket, cacheLine->address, CacheLineSize);
+        if (m_connection.socket.isConnected()) {
+            gdb::queryFeatures(m_connection);
+            gdb::continueExecution(m_connection);
 
-                            while (std::count_if(m_cache.begin(), m_cache.end(), [&](auto &line) { return !line.data.empty(); }) > 100) {
-                                m_cache.pop_front();
-                                cacheLine = m_cache.begin();
-                            }
+            m_cache.setEndAddress(m_size);
 
-                            std::memcpy(cacheLine->data.data(), data.data(), data.size());
-                        }
+            {
+                std::scoped_lock lock(m_refreshMutex);
+                m_stopRefresh = false;
+            }
 
-                        if (cacheLine == m_cache.end())
-                            cacheLine = m_cache.begin();
-                        else
-                            ++cacheLine;
-                    }
-                    std::this_thread::sleep_for(10ms);
-                }
+            // The target's memory may change at any time, keep refreshing the cached blocks in the background
+            m_cacheUpdateThread = std::thread([this] {
+                this->refreshCache();
             });
 
             return true;
@@ -271,15 +405,81 @@ namespace hex::plugin::builtin {
     }
 
     void GDBProvider::close() {
-        m_socket.disconnect();
+        {
+            std::scoped_lock lock(m_refreshMutex);
+            m_stopRefresh = true;
+        }
+        m_refreshCondition.notify_all();
+
+        m_connection.socket.disconnect();
 
         if (m_cacheUpdateThread.joinable()) {
             m_cacheUpdateThread.join();
         }
+
+        m_cache.invalidate();
+    }
+
+    void GDBProvider::refreshCache() {
+        auto interval = MinRefreshInterval;
+        std::unordered_map<u64, size_t> blockHashes;
+
+        while (this->isConnected()) {
+            // Only refresh the most recently used blocks, those are the ones that are currently being looked at
+            auto cachedBlocks = m_cache.getCachedBlocks();
+            if (cachedBlocks.size() > MaxRefreshBlocks)
+                cachedBlocks.resize(MaxRefreshBlocks);
+            std::ranges::sort(cachedBlocks);
+
+            bool changed = false;
+            std::unordered_map<u64, size_t> newBlockHashes;
+            for (size_t i = 0; i < cachedBlocks.size();) {
+                // Read runs of adjacent blocks with a single pipelined request
+                size_t runLength = 1;
+                while (i + runLength < cachedBlocks.size() && cachedBlocks[i + runLength] == cachedBlocks[i] + runLength * CacheBlockSize)
+                    runLength += 1;
+
+                const auto address = cachedBlocks[i];
+                const auto size    = std::min<u64>(runLength * CacheBlockSize, m_size - address);
+                i += runLength;
+
+                std::vector<u8> data(size);
+                bool success;
+                {
+                    std::scoped_lock lock(m_socketLock);
+                    success = gdb::readMemory(m_connection, address, data.data(), data.size());
+                }
+
+                if (!success)
+                    continue;
+
+                for (u64 offset = 0; offset < data.size(); offset += CacheBlockSize) {
+                    const auto hash = std::hash<std::string_view>()(std::string_view(reinterpret_cast<const char *>(data.data() + offset), std::min<u64>(CacheBlockSize, data.size() - offset)));
+                    if (auto it = blockHashes.find(address + offset); it != blockHashes.end() && it->second != hash)
+                        changed = true;
+
+                    newBlockHashes[address + offset] = hash;
+                }
+
+                m_cache.update(address, data.data(), data.size());
+            }
+
+            blockHashes = std::move(newBlockHashes);
+
+            // Poll quickly while the target's memory is changing and back off while it's idle
+            if (changed)
+                interval = MinRefreshInterval;
+            else
+                interval = std::min<std::chrono::milliseconds>(interval * 2, MaxRefreshInterval);
+
+            std::unique_lock lock(m_refreshMutex);
+            if (m_refreshCondition.wait_for(lock, interval, [this] { return m_stopRefresh; }))
+                break;
+        }
     }
 
     bool GDBProvider::isConnected() const {
-        return m_socket.isConnected();
+        return m_connection.socket.isConnected();
     }
 
 
@@ -2,8 +2,6 @@
 #include "content/providers/file_provider.hpp"
 #include <popups/popup_text_input.hpp>
 
-#include <cstring>
-
 #include <hex/api/imhex_api.hpp>
 #include <hex/api/localization_manager.hpp>
 #include <hex/api/event_manager.hpp>
@@ -28,14 +26,18 @@ namespace hex::plugin::builtin {
         if (actualSize == 0 || (offset + size) > actualSize || buffer == nullptr || size == 0)
             return;
 
-        std::memcpy(buffer, &m_data.front() + offset, size);
+        m_data.read(offset, buffer, size);
+    }
+
+    std::optional<std::span<const u8>> MemoryFileProvider::getRawSpan(u64 offset, size_t size) {
+        return m_data.getSpan(offset, size);
     }
 
     void MemoryFileProvider::writeRaw(u64 offset, const void *buffer, size_t size) {
         if ((offset + size) > this->getActualSize() || buffer == nullptr || size == 0)
             return;
 
-        std::memcpy(&m_data.front() + offset, buffer, size);
+        m_data.write(offset, buffer, size);
     }
 
     void MemoryFileProvider::save() {
@@ -71,40 +73,11 @@ namespace hex::plugin::builtin {
     }
 
     void MemoryFileProvider::insertRaw(u64 offset, u64 size) {
-        auto oldSize = this->getActualSize();
-        this->resizeRaw(oldSize + size);
-
-        std::vector<u8> buffer(0x1000);
-        const std::vector<u8> zeroBuffer(0x1000);
-
-        auto position = oldSize;
-        while (position > offset) {
-            const auto readSize = std::min<size_t>(position - offset, buffer.size());
-
-            position -= readSize;
-
-            this->readRaw(position, buffer.data(), readSize);
-            this->writeRaw(position, zeroBuffer.data(), readSize);
-            this->writeRaw(position + size, buffer.data(), readSize);
-        }
+        m_data.insert(offset, size);
     }
 
     void MemoryFileProvider::removeRaw(u64 offset, u64 size) {
-        auto oldSize = this->getActualSize();
-        std::vector<u8> buffer(0x1000);
-
-        const auto newSize = oldSize - size;
-        auto position = offset;
-        while (position < newSize) {
-            const auto readSize = std::min<size_t>(newSize - position, buffer.size());
-
-            this->readRaw(position + size, buffer.data(), readSize);
-            this->writeRaw(position, buffer.data(), readSize);
-
-            position += readSize;
-        }
-
-        this->resizeRaw(oldSize - size);
+        m_data.remove(offset, size);
     }
 
     [[nodiscard]] std::string MemoryFileProvider::getName() const {
@@ -132,13 +105,17 @@ namespace hex::plugin::builtin {
     void MemoryFileProvider::loadSettings(const nlohmann::json &settings) {
         Provider::loadSettings(settings);
 
-        m_data = settings["data"].get<std::vector<u8>>();
+        m_data.clear();
+        m_data.append(settings["data"].get<std::vector<u8>>());
         m_name = settings["name"].get<std::string>();
         m_readOnly = settings["readOnly"].get<bool>();
     }
 
     [[nodiscard]] nlohmann::json MemoryFileProvider::storeSettings(nlohmann::json settings) const {
-        settings["data"] = m_data;
+        std::vector<u8> data(m_data.getSize());
+        m_data.read(0, data.data(), data.size());
+
+        settings["data"] = data;
         settings["name"] = m_name;
         settings["readOnly"] = m_readOnly;
 
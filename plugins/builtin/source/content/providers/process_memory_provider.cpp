@@ -1,6 +1,7 @@
 #if defined(OS_WINDOWS) || defined (OS_LINUX)
 
 #include <content/providers/process_memory_provider.hpp>
+#include <content/providers/process_snapshot_provider.hpp>
 
 #if defined(OS_WINDOWS)
     #include <windows.h>
@@ -10,11 +11,17 @@
     #include <sys/uio.h>
 #endif
 
+#include <algorithm>
+#include <mutex>
+
 #include <imgui.h>
 #include <hex/ui/imgui_imhex_extensions.h>
 #include <hex/helpers/utils.hpp>
 #include <hex/helpers/fmt.hpp>
 #include <hex/ui/view.hpp>
+#include <hex/api/imhex_api.hpp>
+#include <hex/api/event_manager.hpp>
+#include <hex/api/task_manager.hpp>
 
 #include <toasts/toast_notification.hpp>
 
@@ -33,40 +40,106 @@ namespace hex::plugin::builtin {
             m_processId = pid_t(m_selectedProcess->id);
         #endif
 
+        m_cache.setMaxAge(CacheMaxAge);
+        m_cache.invalidate();
+
         this->reloadProcessModules();
 
         return true;
     }
 
     void ProcessMemoryProvider::close() {
+        // Snapshot workers read through this provider, wait for them before the process is gone
+        {
+            std::scoped_lock lock(m_snapshotCaptureMutex);
+            for (const auto &weakCapture : m_snapshotCaptures) {
+                if (auto capture = weakCapture.lock(); capture != nullptr) {
+                    capture->cancel();
+                    capture->waitForWorkers();
+                }
+            }
+
+            m_snapshotCaptures.clear();
+        }
+
         #if defined(OS_WINDOWS)
             CloseHandle(m_processHandle);
             m_processHandle = nullptr;
         #elif defined(OS_LINUX)
             m_processId = -1;
         #endif
+
+        m_cache.invalidate();
     }
 
     void ProcessMemoryProvider::readRaw(u64 address, void *buffer, size_t size) {
-        #if defined(OS_WINDOWS)
-            ReadProcessMemory(m_processHandle, reinterpret_cast<LPCVOID>(address), buffer, size, nullptr);
-        #elif defined(OS_LINUX)
-            const iovec local {
-                .iov_base = buffer,
-                .iov_len = size,
-            };
-            const iovec remote = {
-                .iov_base = reinterpret_cast<void*>(address),
-                .iov_len = size,
-            };
+        if (size >= DirectReadSize) {
+            const ReadRequest request = { address, size, buffer };
+            this->readProcessMemory({ &request, 1 });
+            return;
+        }
 
-            auto read = process_vm_readv(m_processId, &local, 1, &remote, 1, 0);
+        m_cache.read(address, buffer, size, [this](u64 pageAddress, void *pageBuffer, size_t pageSize) {
+            const ReadRequest request = { pageAddress, pageSize, pageBuffer };
+            return this->readProcessMemory({ &request, 1 });
+        });
+    }
 
-            if (read == -1) {
-                // TODO error handling strerror(errno)
+    void ProcessMemoryProvider::readRawv(std::span<const ReadRequest> requests) {
+        std::vector<ReadRequest> directRequests;
+        for (const auto &request : requests) {
+            if (request.size >= DirectReadSize)
+                directRequests.push_back(request);
+            else
+                this->readRaw(request.address, request.buffer, request.size);
+        }
+
+        if (!directRequests.empty())
+            this->readProcessMemory(directRequests);
+    }
+
+    bool ProcessMemoryProvider::readProcessMemory(std::span<const ReadRequest> requests) {
+        bool hitHole = false;
+        bool success = true;
+
+        #if defined(OS_WINDOWS) || defined(OS_LINUX)
+            {
+                std::shared_lock lock(m_regionMutex);
+
+                #if defined(OS_WINDOWS)
+                    success = prv::readProcessMemory(m_processHandle, m_mappedRanges, requests, &hitHole);
+                #else
+                    success = prv::readProcessMemory(m_processId, m_mappedRanges, requests, &hitHole);
+                #endif
             }
         #endif
+
+        // Memory that was read as a hole may have been mapped since the regions were loaded, and failed reads hint at regions that are gone
+        this->requestRegionReload(hitHole || !success);
+
+        return success;
     }
+
+    void ProcessMemoryProvider::requestRegionReload(bool readMiss) {
+        const auto lastReload = std::chrono::steady_clock::time_point(std::chrono::steady_clock::duration(m_regionReloadTime.load()));
+        if (std::chrono::steady_clock::now() - lastReload < (readMiss ? RegionMinAge : RegionMaxAge))
+            return;
+
+        if (m_regionReloadPending.exchange(true))
+            return;
+
+        // The regions are drawn by the UI without holding a lock, so they're only ever replaced on the main thread
+        TaskManager::doLater([this] {
+            const auto &providers = ImHexApi::Provider::getProviders();
+            if (std::find(providers.begin(), providers.end(), this) == providers.end())
+                return;
+
+            m_regionReloadPending = false;
+            if (this->isAvailable())
+                this->reloadProcessModules();
+        });
+    }
+
     void ProcessMemoryProvider::writeRaw(u64 address, const void *buffer, size_t size) {
         #if defined(OS_WINDOWS)
             WriteProcessMemory(m_processHandle, reinterpret_cast<LPVOID>(address), buffer, size, nullptr);
@@ -85,24 +158,24 @@ namespace hex::plugin::builtin {
                 // TODO error handling strerror(errno)
             }
         #endif
+
+        m_cache.update(address, buffer, size);
     }
 
     std::pair<Region, bool> ProcessMemoryProvider::getRegionValidity(u64 address) const {
-        for (const auto &memoryRegion : m_memoryRegions) {
-            if (memoryRegion.region.overlaps({ address, 1 }))
-                return { memoryRegion.region, true };
-        }
+        std::shared_lock lock(m_regionMutex);
 
-        Region lastRegion = Region::Invalid();
-        for (const auto &memoryRegion : m_memoryRegions) {
+        auto it = std::ranges::upper_bound(m_mappedRanges, address, { }, &Region::address);
+        if (it != m_mappedRanges.begin() && std::prev(it)->getEndAddress() >= address)
+            return { *std::prev(it), true };
 
-            if (address < memoryRegion.region.getStartAddress())
-                return { Region { lastRegion.getEndAddress() + 1, memoryRegion.region.getStartAddress() - lastRegion.getEndAddress() }, false };
+        // Report the entire hole up to the next mapped range so scans can skip it in one go
+        const u64 holeStart = it == m_mappedRanges.begin() ? 0 : std::prev(it)->getEndAddress() + 1;
+        const u64 holeEnd   = it == m_mappedRanges.end() ? this->getActualSize() : it->getStartAddress();
+        if (address >= holeEnd)
+            return { Region::Invalid(), false };
 
-            lastRegion = memoryRegion.region;
-        }
-
-        return { Region::Invalid(), false };
+        return { Region { holeStart, holeEnd - holeStart }, false };
     }
 
     bool ProcessMemoryProvider::drawLoadInterface() {
@@ -311,8 +384,74 @@ namespace hex::plugin::builtin {
         #endif
     }
 
+    std::vector<ProcessMemoryProvider::MenuEntry> ProcessMemoryProvider::getMenuEntries() {
+        return {
+            MenuEntry { Lang("hex.builtin.provider.process_memory.snapshot"), [this] { this->snapshotProcess(); } }
+        };
+    }
+
+    void ProcessMemoryProvider::snapshotProcess() {
+        std::vector<Region> regions;
+        {
+            std::shared_lock lock(m_regionMutex);
+            regions = m_mappedRanges;
+        }
+
+        auto capture = std::make_shared<prv::SparseMemoryCapture>(regions, SnapshotWorkSize, SnapshotPageSize, [this](std::span<const ReadRequest> requests) {
+            this->readProcessMemory(requests);
+        });
+
+        if (capture->getWorkItemCount() == 0)
+            return;
+
+        // The workers read through this provider, so closing it has to stop them first
+        {
+            std::scoped_lock lock(m_snapshotCaptureMutex);
+            std::erase_if(m_snapshotCaptures, [](const auto &weakCapture) { return weakCapture.expired(); });
+            m_snapshotCaptures.push_back(capture);
+        }
+
+        const auto workerCount = std::min<size_t>(std::max<u32>(std::thread::hardware_concurrency(), 1), capture->getWorkItemCount());
+        for (size_t i = 1; i < workerCount; i += 1) {
+            TaskManager::createBackgroundTask("Creating process snapshot", [capture](Task &) {
+                capture->work();
+            });
+        }
+
+        TaskManager::createTask("Creating process snapshot", capture->getTotalSize(), [capture, regions = std::move(regions), processName = m_selectedProcess->name](Task &task) mutable {
+            task.setInterruptCallback([capture] {
+                capture->cancel();
+            });
+
+            const auto updateProgress = [&task, &capture] {
+                task.update(capture->getBytesProcessed());
+            };
+
+            capture->work(updateProgress);
+            capture->waitForWorkers(updateProgress);
+
+            if (capture->isCancelled())
+                return;
+
+            TaskManager::doLater([capture, regions = std::move(regions), processName = std::move(processName)]() mutable {
+                auto newProvider = ImHexApi::Provider::createProvider("hex.builtin.provider.process_snapshot", true);
+
+                if (auto snapshotProvider = dynamic_cast<ProcessSnapshotProvider*>(newProvider); snapshotProvider != nullptr) {
+                    snapshotProvider->setData(std::move(processName), std::move(regions), capture->takeChunks());
+
+                    if (snapshotProvider->open())
+                        EventProviderOpened::post(newProvider);
+                    else
+                        ImHexApi::Provider::remove(newProvider);
+                }
+            });
+        });
+    }
+
     void ProcessMemoryProvider::reloadProcessModules() {
-        m_memoryRegions.clear();
+        m_regionReloadTime = std::chrono::steady_clock::now().time_since_epoch().count();
+
+        std::vector<MemoryRegion> memoryRegions;
 
         #if defined(OS_WINDOWS)
             DWORD numModules = 0;
@@ -337,7 +476,7 @@ namespace hex::plugin::builtin {
                 if (GetModuleFileNameExA(m_processHandle, module, moduleName, MAX_PATH) == FALSE)
                     continue;
 
-                m_memoryRegions.insert({ { u64(moduleInfo.lpBaseOfDll), size_t(moduleInfo.SizeOfImage) }, std::fs::path(moduleName).filename().string() });
+                memoryRegions.push_back({ { u64(moduleInfo.lpBaseOfDll), size_t(moduleInfo.SizeOfImage) }, std::fs::path(moduleName).filename().string() });
             }
 
             MEMORY_BASIC_INFORMATION memoryInfo;
@@ -353,7 +492,8 @@ namespace hex::plugin::builtin {
                 if (memoryInfo.State & MEM_PRIVATE) name += hex::format("{} ", "hex.builtin.provider.process_memory.region.private"_lang);
                 if (memoryInfo.State & MEM_MAPPED)  name += hex::format("{} ", "hex.builtin.provider.process_memory.region.mapped"_lang);
 
-                m_memoryRegions.insert({ { reinterpret_cast<u64>(memoryInfo.BaseAddress), reinterpret_cast<u64>(memoryInfo.BaseAddress) + memoryInfo.RegionSize }, name });
+                const bool readable = memoryInfo.State == MEM_COMMIT && (memoryInfo.Protect & (PAGE_NOACCESS | PAGE_GUARD)) == 0;
+                memoryRegions.push_back({ { reinterpret_cast<u64>(memoryInfo.BaseAddress), memoryInfo.RegionSize }, name, readable });
             }
 
         #elif defined(OS_LINUX)
@@ -363,7 +503,17 @@ namespace hex::plugin::builtin {
             if (!file.isValid())
                 return;
 
-            for (const auto &line : wolv::util::splitString(file.readString(0xF'FFFF), "\n")) {
+            // Read the whole file, processes with many mappings easily exceed any fixed size
+            std::string maps;
+            while (true) {
+                auto chunk = file.readString(0xF'FFFF);
+                maps += chunk;
+
+                if (chunk.size() < 0xF'FFFF)
+                    break;
+            }
+
+            for (const auto &line : wolv::util::splitString(maps, "\n")) {
                 const auto &split = wolv::util::splitString(line, " ");
                 if (split.size() < 6)
                     continue;
@@ -371,14 +521,47 @@ namespace hex::plugin::builtin {
                 const u64 start = std::stoull(split[0].substr(0, split[0].find('-')), nullptr, 16);
                 const u64 end   = std::stoull(split[0].substr(split[0].find('-') + 1), nullptr, 16);
                 const auto &name = split[5];
+                const bool readable = split[1].starts_with('r');
 
-                m_memoryRegions.insert({ { start, end - start }, name });
+                memoryRegions.push_back({ { start, end - start }, name, readable });
             }
         #endif
+
+        std::ranges::sort(memoryRegions);
+
+        // Merge all readable regions into contiguous ranges so reads spanning multiple regions don't get split up
+        std::vector<Region> mappedRanges;
+        for (const auto &memoryRegion : memoryRegions) {
+            if (!memoryRegion.readable || memoryRegion.region.getSize() == 0)
+                continue;
+
+            if (!mappedRanges.empty() && memoryRegion.region.getStartAddress() <= mappedRanges.back().getEndAddress() + 1) {
+                auto &lastRange = mappedRanges.back();
+                lastRange.size = std::max<u64>(lastRange.getEndAddress(), memoryRegion.region.getEndAddress()) - lastRange.getStartAddress() + 1;
+            } else {
+                mappedRanges.push_back(memoryRegion.region);
+            }
+        }
+
+        // Only drop cached data of regions that were mapped, unmapped or changed since the last reload
+        std::vector<MemoryRegion> changedRegions;
+        std::ranges::set_symmetric_difference(m_memoryRegions, memoryRegions, std::back_inserter(changedRegions));
+        for (const auto &changedRegion : changedRegions)
+            m_cache.invalidate(changedRegion.region.getStartAddress(), changedRegion.region.getSize());
+
+        {
+            std::unique_lock lock(m_regionMutex);
+            m_memoryRegions = std::move(memoryRegions);
+            m_mappedRanges  = std::move(mappedRanges);
+        }
+
+        m_regionSearchWidget.reset();
     }
 
 
     std::variant<std::string, i128> ProcessMemoryProvider::queryInformation(const std::string &category, const std::string &argument) {
+        std::shared_lock lock(m_regionMutex);
+
         auto findRegionByName = [this](const std::string &name) {
             return std::find_if(m_memoryRegions.begin(), m_memoryRegions.end(),
                 [name](const auto &region) {
@@ -0,0 +1,62 @@
+#include "content/providers/process_snapshot_provider.hpp"
+
+#include <hex/api/localization_manager.hpp>
+#include <hex/helpers/fmt.hpp>
+#include <hex/helpers/utils.hpp>
+
+#include <nlohmann/json.hpp>
+
+namespace hex::plugin::builtin {
+
+    std::string ProcessSnapshotProvider::getName() const {
+        return hex::format("hex.builtin.provider.process_snapshot.name"_lang, m_processName);
+    }
+
+    std::vector<ProcessSnapshotProvider::Description> ProcessSnapshotProvider::getDataDescription() const {
+        u64 storedSize = 0;
+        for (const auto &[address, data] : m_chunks)
+            storedSize += data.size();
+
+        return {
+            { "hex.builtin.provider.process_memory.process_name"_lang,  m_processName                    },
+            { "hex.builtin.provider.process_snapshot.regions"_lang,     std::to_string(m_regions.size()) },
+            { "hex.builtin.provider.process_snapshot.stored_size"_lang, hex::toByteString(storedSize)    }
+        };
+    }
+
+    void ProcessSnapshotProvider::loadSettings(const nlohmann::json &settings) {
+        Provider::loadSettings(settings);
+
+        m_processName = settings.at("process_name").get<std::string>();
+
+        m_regions.clear();
+        for (const auto &region : settings.at("regions"))
+            m_regions.push_back({ region.at("address").get<u64>(), region.at("size").get<size_t>() });
+
+        m_chunks.clear();
+        for (const auto &chunk : settings.at("chunks"))
+            m_chunks.emplace(chunk.at("address").get<u64>(), chunk.at("data").get<std::vector<u8>>());
+    }
+
+    nlohmann::json ProcessSnapshotProvider::storeSettings(nlohmann::json settings) const {
+        settings["process_name"] = m_processName;
+
+        auto regions = nlohmann::json::array();
+        for (const auto &region : m_regions)
+            regions.push_back({ { "address", region.getStartAddress() }, { "size", region.getSize() } });
+        settings["regions"] = regions;
+
+        auto chunks = nlohmann::json::array();
+        for (const auto &[address, data] : m_chunks)
+            chunks.push_back({ { "address", address }, { "data", data } });
+        settings["chunks"] = chunks;
+
+        return Provider::storeSettings(settings);
+    }
+
+    void ProcessSnapshotProvider::setData(std::string processName, std::vector<Region> regions, std::map<u64, std::vector<u8>> chunks) {
+        m_processName = std::move(processName);
+        SparseMemoryProvider::setData(std::move(regions), std::move(chunks));
+    }
+
+}
@@ -15,6 +15,7 @@
 #include <wolv/utils/string.hpp>
 
 #include <content/recent.hpp>
+#include <content/backup_journal.hpp>
 #include <toasts/toast_notification.hpp>
 #include <fonts/codicons_font.h>
 
@@ -58,7 +59,7 @@ namespace hex::plugin::builtin::recent {
                         ImGui::TableNextRow();
                         ImGui::TableNextColumn();
                         if (ImGui::Selectable(backup.displayName.c_str())) {
-                            ProjectFile::load(backup.path);
+                            backup::loadAutoBackup(backup.path);
                             Popup::close();
                         }
                     }
@@ -7,6 +7,7 @@
 
 #include <hex/helpers/http_requests.hpp>
 #include <hex/helpers/utils.hpp>
+#include <hex/providers/undo_redo/stack.hpp>
 
 #include <imgui.h>
 #include <hex/ui/imgui_imhex_extensions.h>
@@ -370,7 +371,16 @@ namespace hex::plugin::builtin {
 
         ContentRegistry::Settings::add<Widgets::Checkbox>("hex.builtin.setting.general", "", "hex.builtin.setting.general.show_tips", false);
         ContentRegistry::Settings::add<Widgets::Checkbox>("hex.builtin.setting.general", "", "hex.builtin.setting.general.save_recent_providers", true);
+        ContentRegistry::Settings::add<Widgets::Checkbox>("hex.builtin.setting.general", "", "hex.builtin.setting.general.file_copy_on_write", false);
         ContentRegistry::Settings::add<AutoBackupWidget>("hex.builtin.setting.general", "", "hex.builtin.setting.general.auto_backup_time");
+
+        prv::undo::Stack::setMemoryLimit(ContentRegistry::Settings::read("hex.builtin.setting.general", "hex.builtin.setting.general.undo_memory_limit", 256).get<i32>() * 1024ULL * 1024ULL);
+        ContentRegistry::Settings::add<Widgets::SliderInteger>("hex.builtin.setting.general", "", "hex.builtin.setting.general.undo_memory_limit", 256, 16, 4096).setChangedCallback([](Widgets::Widget &widget) {
+            auto slider = static_cast<Widgets::SliderInteger *>(&widget);
+
+            prv::undo::Stack::setMemoryLimit(slider->getValue() * 1024ULL * 1024ULL);
+        });
+
         ContentRegistry::Settings::add<Widgets::Checkbox>("hex.builtin.setting.general", "hex.builtin.setting.general.patterns", "hex.builtin.setting.general.auto_load_patterns", true);
         ContentRegistry::Settings::add<Widgets::Checkbox>("hex.builtin.setting.general", "hex.builtin.setting.general.patterns", "hex.builtin.setting.general.sync_pattern_source", false);
         ContentRegistry::Settings::add<Widgets::Checkbox>("hex.builtin.setting.general", "hex.builtin.setting.general.network", "hex.builtin.setting.general.network_interface", false);
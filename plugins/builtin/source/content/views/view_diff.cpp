@@ -136,9 +136,11 @@ namespace hex::plugin::builtin {
         m_diffTask = TaskManager::createTask("Diffing...", commonSize, [this, providerA, providerB](Task &task) {
             std::vector<Diff> differences;
 
-            // Set up readers for both providers
-            auto readerA = prv::ProviderReader(providerA);
-            auto readerB = prv::ProviderReader(providerB);
+            // Set up readers for snapshots of both providers so edits made while diffing don't mess up the result
+            const auto snapshotA = providerA->createSnapshot();
+            const auto snapshotB = providerB->createSnapshot();
+            auto readerA = prv::ProviderReader(snapshotA);
+            auto readerB = prv::ProviderReader(snapshotB);
 
             // Iterate over both providers and compare the bytes
             for (auto itA = readerA.begin(), itB = readerB.begin(); itA < readerA.end() && itB < readerB.end(); ++itA, ++itB) {
@@ -176,6 +178,11 @@ namespace hex::plugin::builtin {
                     differences.push_back(Diff { Region{ endA, endB - endA }, ViewDiff::DifferenceType::Removed });
             }
 
+            // Data got inserted or removed while diffing, the differences don't line up with the data anymore.
+            // Leave the providers marked as not analyzed so they get diffed again
+            if (snapshotA.isStale() || snapshotB.isStale())
+                return;
+
             // Move the calculated differences over so they can be displayed
             m_diffs = std::move(differences);
             m_analyzed = true;
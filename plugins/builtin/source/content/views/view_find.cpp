@@ -6,6 +6,12 @@
 #include <hex/providers/buffered_reader.hpp>
 
 #include <array>
+#include <cstring>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <numeric>
+#include <optional>
 #include <ranges>
 #include <regex>
 #include <string>
@@ -151,7 +157,7 @@ namespace hex::plugin::builtin {
     }
 
     template<typename T>
-    static std::string formatBytes(const std::vector<u8> &bytes, std::endian endian) {
+    static std::string formatBytes(std::span<const u8> bytes, std::endian endian) {
         if (bytes.size() > sizeof(T))
             return { };
 
@@ -166,7 +172,20 @@ namespace hex::plugin::builtin {
         return hex::format("{}", value);
     }
 
-    std::vector<ViewFind::Occurrence> ViewFind::searchStrings(Task &task, prv::Provider *provider, hex::Region searchRegion, const SearchSettings::Strings &settings) {
+    template<typename T>
+    static T readNumber(const u8 *bytes, size_t size, std::endian endian) {
+        T value = 0x00;
+        std::memcpy(&value, bytes, size);
+
+        value = hex::changeEndianess(value, size, endian);
+
+        if constexpr (std::signed_integral<T>)
+            value = T(hex::signExtend(size * 8, value));
+
+        return value;
+    }
+
+    std::vector<ViewFind::Occurrence> ViewFind::searchStrings(Task &task, const prv::Snapshot &snapshot, hex::Region searchRegion, const SearchSettings::Strings &settings) {
         using enum SearchSettings::StringType;
 
         std::vector<Occurrence> results;
@@ -175,23 +194,23 @@ namespace hex::plugin::builtin {
             auto newSettings = settings;
 
             newSettings.type = ASCII;
-            auto asciiResults = searchStrings(task, provider, searchRegion, newSettings);
+            auto asciiResults = searchStrings(task, snapshot, searchRegion, newSettings);
             std::copy(asciiResults.begin(), asciiResults.end(), std::back_inserter(results));
 
             if (settings.type == ASCII_UTF16BE) {
                 newSettings.type = UTF16BE;
-                auto utf16Results = searchStrings(task, provider, searchRegion, newSettings);
+                auto utf16Results = searchStrings(task, snapshot, searchRegion, newSettings);
                 std::copy(utf16Results.begin(), utf16Results.end(), std::back_inserter(results));
             } else if (settings.type == ASCII_UTF16LE) {
                 newSettings.type = UTF16LE;
-                auto utf16Results = searchStrings(task, provider, searchRegion, newSettings);
+                auto utf16Results = searchStrings(task, snapshot, searchRegion, newSettings);
                 std::copy(utf16Results.begin(), utf16Results.end(), std::back_inserter(results));
             }
 
             return results;
         }
 
-        auto reader = prv::ProviderReader(provider);
+        auto reader = prv::ProviderReader(snapshot);
         reader.seek(searchRegion.getStartAddress());
         reader.setEndAddress(searchRegion.getEndAddress());
 
@@ -252,13 +271,9 @@ namespace hex::plugin::builtin {
         return results;
     }
 
-    std::vector<ViewFind::Occurrence> ViewFind::searchSequence(Task &task, prv::Provider *provider, hex::Region searchRegion, const SearchSettings::Sequence &settings) {
+    std::vector<ViewFind::Occurrence> ViewFind::searchSequence(Task &task, const prv::Snapshot &snapshot, hex::Region searchRegion, const SearchSettings::Sequence &settings) {
         std::vector<Occurrence> results;
 
-        auto reader = prv::ProviderReader(provider);
-        reader.seek(searchRegion.getStartAddress());
-        reader.setEndAddress(searchRegion.getEndAddress());
-
         auto input = hex::decodeByteString(settings.sequence);
         if (input.empty())
             return { };
@@ -297,9 +312,6 @@ namespace hex::plugin::builtin {
             }
         }
 
-        auto occurrence = reader.begin();
-        u64 progress = 0;
-
         auto searchPredicate = [&] -> bool(*)(u8, u8) {
             if (!settings.ignoreCase)
                 return [](u8 left, u8 right) -> bool {
@@ -317,24 +329,38 @@ namespace hex::plugin::builtin {
         }();
 
 
-        while (true) {
-            task.update(progress);
+        // Search through the region chunk by chunk. Each chunk overlaps the next one by the size of the sequence
+        // so occurrences crossing a chunk boundary are found as well
+        constexpr static u64 ChunkSize = 0x10'0000;
+        const auto searcher = std::default_searcher(bytes.begin(), bytes.end(), searchPredicate);
+
+        std::vector<u8> buffer;
+        for (u64 chunkAddress = searchRegion.getStartAddress(); chunkAddress <= searchRegion.getEndAddress(); chunkAddress += ChunkSize) {
+            task.update(chunkAddress - searchRegion.getStartAddress());
+
+            const auto readSize = std::min<u64>(ChunkSize + bytes.size() - 1, (searchRegion.getEndAddress() - chunkAddress) + 1);
+            if (readSize < bytes.size())
+                break;
 
-            occurrence = std::search(reader.begin(), reader.end(), std::default_searcher(bytes.begin(), bytes.end(), searchPredicate));
-            if (occurrence == reader.end())
+            // Nothing can be read anymore once the snapshot went stale, the caller drops the results in that case
+            const auto data = snapshot.readSpan(chunkAddress, readSize, buffer);
+            if (data.empty())
                 break;
 
-            auto address = occurrence.getAddress();
-            reader.seek(address + 1);
-            results.push_back(Occurrence{ Region { address, bytes.size() }, decodeType, endian, false });
-            progress = address - searchRegion.getStartAddress();
+            for (auto it = std::search(data.begin(), data.end(), searcher); it != data.end(); it = std::search(it + 1, data.end(), searcher)) {
+                const u64 offset = it - data.begin();
+                if (offset >= ChunkSize)
+                    break;
+
+                results.push_back(Occurrence{ Region { chunkAddress + offset, bytes.size() }, decodeType, endian, false });
+            }
         }
 
         return results;
     }
 
-    std::vector<ViewFind::Occurrence> ViewFind::searchRegex(Task &task, prv::Provider *provider, hex::Region searchRegion, const SearchSettings::Regex &settings) {
-        auto stringOccurrences = searchStrings(task, provider, searchRegion, SearchSettings::Strings {
+    std::vector<ViewFind::Occurrence> ViewFind::searchRegex(Task &task, const prv::Snapshot &snapshot, hex::Region searchRegion, const SearchSettings::Regex &settings) {
+        auto stringOccurrences = searchStrings(task, snapshot, searchRegion, SearchSettings::Strings {
             .minLength          = settings.minLength,
             .nullTermination    = settings.nullTermination,
             .type               = settings.type,
@@ -351,7 +377,8 @@ namespace hex::plugin::builtin {
         std::regex regex(settings.pattern);
         for (const auto &occurrence : stringOccurrences) {
             std::string string(occurrence.region.getSize(), '\x00');
-            provider->read(occurrence.region.getStartAddress(), string.data(), occurrence.region.getSize());
+            if (!snapshot.read(occurrence.region.getStartAddress(), string.data(), occurrence.region.getSize()))
+                break;
 
             task.update();
 
@@ -367,10 +394,10 @@ namespace hex::plugin::builtin {
         return result;
     }
 
-    std::vector<ViewFind::Occurrence> ViewFind::searchBinaryPattern(Task &task, prv::Provider *provider, hex::Region searchRegion, const SearchSettings::BinaryPattern &settings) {
+    std::vector<ViewFind::Occurrence> ViewFind::searchBinaryPattern(Task &task, const prv::Snapshot &snapshot, hex::Region searchRegion, const SearchSettings::BinaryPattern &settings) {
         std::vector<Occurrence> results;
 
-        auto reader = prv::ProviderReader(provider);
+        auto reader = prv::ProviderReader(snapshot);
         reader.seek(searchRegion.getStartAddress());
         reader.setEndAddress(searchRegion.getEndAddress());
 
@@ -420,13 +447,7 @@ namespace hex::plugin::builtin {
         return results;
     }
 
-    std::vector<ViewFind::Occurrence> ViewFind::searchValue(Task &task, prv::Provider *provider, Region searchRegion, const SearchSettings::Value &settings) {
-        std::vector<Occurrence> results;
-
-        auto reader = prv::ProviderReader(provider);
-        reader.seek(searchRegion.getStartAddress());
-        reader.setEndAddress(searchRegion.getEndAddress());
-
+    CandidateSet ViewFind::scanValues(Task &task, prv::Provider *provider, const prv::Snapshot &snapshot, Region searchRegion, const SearchSettings::Value &settings) {
         auto inputMin = settings.inputMin;
         auto inputMax = settings.inputMax;
 
@@ -436,55 +457,238 @@ namespace hex::plugin::builtin {
         const auto [validMin, min, sizeMin] = parseNumericValueInput(inputMin, settings.type);
         const auto [validMax, max, sizeMax] = parseNumericValueInput(inputMax, settings.type);
 
-        if (!validMin || !validMax || sizeMin != sizeMax)
+        if (!validMin || !validMax || sizeMin != sizeMax || searchRegion.getSize() < sizeMin)
             return { };
 
-        const auto size = sizeMin;
-
+        const auto size    = sizeMin;
         const auto advance = settings.aligned ? size : 1;
 
-        for (u64 address = searchRegion.getStartAddress(); address < searchRegion.getEndAddress(); address += advance) {
-            task.update(address);
+        // Only scan the parts of the search region that are backed by data. Holes, like the unmapped parts of a process'
+        // address space, would otherwise be read back as zeros and show up as candidates. Valid regions directly
+        // following each other are merged so values crossing the border between them are still found
+        std::vector<Region> validRegions;
+        for (u64 address = searchRegion.getStartAddress(); address <= searchRegion.getEndAddress();) {
+            const auto [region, valid] = provider->getRegionValidity(address);
+            if (region == Region::Invalid() || region.getEndAddress() < address)
+                break;
+
+            const auto regionEnd = std::min(region.getEndAddress(), searchRegion.getEndAddress());
+            if (valid) {
+                if (!validRegions.empty() && validRegions.back().getEndAddress() + 1 == address)
+                    validRegions.back().size += regionEnd - address + 1;
+                else
+                    validRegions.push_back({ address, regionEnd - address + 1 });
+            }
+
+            if (regionEnd == std::numeric_limits<u64>::max())
+                break;
+
+            address = regionEnd + 1;
+        }
+
+        // Every block covers BlockSize possible value addresses and is searched independently of all others
+        struct WorkItem {
+            u64 address;
+            u64 valueCount;
+        };
+
+        std::vector<WorkItem> workItems;
+        for (const auto &region : validRegions) {
+            if (region.getSize() < size)
+                continue;
+
+            const auto lastAddress = region.getEndAddress() - (size - 1);
+            for (u64 blockAddress = region.getStartAddress(); blockAddress <= lastAddress && blockAddress >= region.getStartAddress(); blockAddress += CandidateSet::BlockSize)
+                workItems.push_back({ blockAddress, std::min<u64>(CandidateSet::BlockSize, lastAddress - blockAddress + 1) });
+        }
+
+        // Most blocks usually don't contain any candidates, so only the ones that do are kept around
+        std::mutex blocksMutex;
+        std::map<u64, CandidateSet::Block> blocks;
 
-            auto result = std::visit([&]<typename T>(T) {
-                using DecayedType = std::remove_cvref_t<std::decay_t<T>>;
+        TaskManager::parallelFor(task, workItems.size(), [&](size_t index) {
+            const auto [blockAddress, valueCount] = workItems[index];
 
-                auto minValue = std::get<DecayedType>(min);
-                auto maxValue = std::get<DecayedType>(max);
+            std::vector<u8> data(valueCount + size - 1);
+            if (!snapshot.read(blockAddress, data.data(), data.size()))
+                return;
 
-                DecayedType value = 0;
-                reader.read(address, reinterpret_cast<u8*>(&value), size);
-                value = hex::changeEndianess(value, size, settings.endian);
+            std::vector<u16> offsets;
+            std::vector<u8> values;
+            std::visit([&]<typename T>(T minValue) {
+                const auto maxValue = std::get<T>(max);
 
-                return value >= minValue && value <= maxValue;
+                for (u64 offset = 0; offset < valueCount; offset += advance) {
+                    const auto value = readNumber<T>(data.data() + offset, size, settings.endian);
+                    if (value >= minValue && value <= maxValue) {
+                        offsets.push_back(u16(offset));
+                        values.insert(values.end(), data.begin() + offset, data.begin() + offset + size);
+                    }
+                }
             }, min);
 
-            if (result) {
-                Occurrence::DecodeType decodeType = [&]{
-                    switch (settings.type) {
-                        using enum SearchSettings::Value::Type;
-                        using enum Occurrence::DecodeType;
-
-                        case U8:
-                        case U16:
-                        case U32:
-                        case U64:
-                            return Unsigned;
-                        case I8:
-                        case I16:
-                        case I32:
-                        case I64:
-                            return Signed;
-                        case F32:
-                            return Float;
-                        case F64:
-                            return Double;
-                        default:
-                            return Binary;
+            if (offsets.empty())
+                return;
+
+            CandidateSet::Block block(blockAddress, size, offsets, values);
+
+            std::scoped_lock lock(blocksMutex);
+            blocks.emplace(blockAddress, std::move(block));
+        });
+
+        CandidateSet result;
+        for (auto &[address, block] : blocks)
+            result.addBlock(std::move(block));
+
+        return result;
+    }
+
+    CandidateSet ViewFind::narrowCandidates(Task &task, prv::Provider *provider, const CandidateSet &candidates, const SearchSettings::Value &settings, NextScanFilter filter) {
+        // Only the equals filter needs the entered values, all others only compare against the previous values
+        const bool useInput = filter == NextScanFilter::Equals;
+        const auto inputMin = useInput ? settings.inputMin : "0";
+        const auto inputMax = useInput && !settings.inputMax.empty() ? settings.inputMax : inputMin;
+
+        const auto [validMin, min, size]    = parseNumericValueInput(inputMin, settings.type);
+        const auto [validMax, max, sizeMax] = parseNumericValueInput(inputMax, settings.type);
+
+        if (!validMin || !validMax || size != sizeMax)
+            return { };
+
+        constexpr static size_t BlocksPerWorkItem = 16;
+
+        const auto &blocks = candidates.getBlocks();
+        const auto workItemCount = (blocks.size() + BlocksPerWorkItem - 1) / BlocksPerWorkItem;
+
+        std::vector<std::vector<CandidateSet::Block>> results(workItemCount);
+        TaskManager::parallelFor(task, workItemCount, [&](size_t index) {
+            const auto firstBlock = index * BlocksPerWorkItem;
+            const auto workItem   = std::span(blocks).subspan(firstBlock, std::min(BlocksPerWorkItem, blocks.size() - firstBlock));
+
+            // Read the current values of all candidates in the work item with a single batched read. Dense blocks are
+            // read in one piece, for sparse ones only the bytes of the candidates themselves are requested
+            std::vector<std::vector<u16>> offsets;
+            std::vector<size_t> bufferOffsets;
+            size_t bufferSize = 0;
+            for (const auto &block : workItem) {
+                offsets.push_back(block.getOffsets());
+                bufferOffsets.push_back(bufferSize);
+
+                if (block.isDense())
+                    bufferSize += offsets.back().back() + size;
+                else
+                    bufferSize += offsets.back().size() * size;
+            }
+
+            std::vector<u8> buffer(bufferSize);
+            std::vector<prv::Provider::ReadRequest> requests;
+            for (size_t i = 0; i < workItem.size(); i += 1) {
+                const auto &block = workItem[i];
+                const auto blockBuffer = buffer.data() + bufferOffsets[i];
+
+                if (block.isDense()) {
+                    requests.push_back({ block.getAddress(), offsets[i].back() + size, blockBuffer });
+                } else {
+                    for (size_t j = 0; j < offsets[i].size(); j += 1)
+                        requests.push_back({ block.getAddress() + offsets[i][j], size, blockBuffer + j * size });
+                }
+            }
+
+            provider->readv(requests);
+
+            for (size_t i = 0; i < workItem.size(); i += 1) {
+                const auto &block = workItem[i];
+                const auto blockBuffer    = buffer.data() + bufferOffsets[i];
+                const auto previousValues = block.getValues();
+
+                std::vector<u16> keptOffsets;
+                std::vector<u8> keptValues;
+                std::visit([&]<typename T>(T minValue) {
+                    const auto maxValue = std::get<T>(max);
+
+                    for (size_t j = 0; j < offsets[i].size(); j += 1) {
+                        const auto previous = previousValues.data() + j * size;
+                        const auto current  = blockBuffer + (block.isDense() ? offsets[i][j] : j * size);
+
+                        bool keep = false;
+                        switch (filter) {
+                            using enum NextScanFilter;
+                            case Equals: {
+                                const auto value = readNumber<T>(current, size, settings.endian);
+                                keep = value >= minValue && value <= maxValue;
+                                break;
+                            }
+                            case Changed:
+                                keep = std::memcmp(previous, current, size) != 0;
+                                break;
+                            case Unchanged:
+                                keep = std::memcmp(previous, current, size) == 0;
+                                break;
+                            case Increased:
+                                keep = readNumber<T>(current, size, settings.endian) > readNumber<T>(previous, size, settings.endian);
+                                break;
+                            case Decreased:
+                                keep = readNumber<T>(current, size, settings.endian) < readNumber<T>(previous, size, settings.endian);
+                                break;
+                        }
+
+                        if (keep) {
+                            keptOffsets.push_back(offsets[i][j]);
+                            keptValues.insert(keptValues.end(), current, current + size);
+                        }
                     }
-                }();
+                }, min);
+
+                if (!keptOffsets.empty())
+                    results[index].emplace_back(block.getAddress(), size, keptOffsets, keptValues);
+            }
+        });
+
+        CandidateSet result;
+        for (auto &workItemBlocks : results) {
+            for (auto &block : workItemBlocks)
+                result.addBlock(std::move(block));
+        }
+
+        return result;
+    }
+
+    std::vector<ViewFind::Occurrence> ViewFind::getCandidateOccurrences(const CandidateSet &candidates, const SearchSettings::Value &settings) {
+        // Listing every single candidate of a broad first scan isn't useful and would need far more memory than the
+        // candidate set itself. Only the first ones are turned into occurrences, the rest is only kept in the set
+        constexpr static size_t MaxOccurrences = 100'000;
+
+        const auto decodeType = [&] {
+            switch (settings.type) {
+                using enum SearchSettings::Value::Type;
+                using enum Occurrence::DecodeType;
+
+                case U8:
+                case U16:
+                case U32:
+                case U64:
+                    return Unsigned;
+                case I8:
+                case I16:
+                case I32:
+                case I64:
+                    return Signed;
+                case F32:
+                    return Float;
+                case F64:
+                    return Double;
+                default:
+                    return Binary;
+            }
+        }();
+
+        std::vector<Occurrence> results;
+        for (const auto &block : candidates.getBlocks()) {
+            for (const auto offset : block.getOffsets()) {
+                if (results.size() >= MaxOccurrences)
+                    return results;
 
-                results.push_back(Occurrence { Region { address, size }, decodeType, settings.endian, false });
+                results.push_back(Occurrence { Region { block.getAddress() + offset, block.getValueSize() }, decodeType, settings.endian, false });
             }
         }
 
@@ -509,26 +713,40 @@ namespace hex::plugin::builtin {
         m_searchTask = TaskManager::createTask("hex.builtin.view.find.searching", searchRegion.getSize(), [this, settings = m_searchSettings, searchRegion](auto &task) {
             auto provider = ImHexApi::Provider::get();
 
-            switch (settings.mode) {
-                using enum SearchSettings::Mode;
-                case Strings:
-                    m_foundOccurrences.get(provider) = searchStrings(task, provider, searchRegion, settings.strings);
-                    break;
-                case Sequence:
-                    m_foundOccurrences.get(provider) = searchSequence(task, provider, searchRegion, settings.bytes);
-                    break;
-                case Regex:
-                    m_foundOccurrences.get(provider) = searchRegex(task, provider, searchRegion, settings.regex);
-                    break;
-                case BinaryPattern:
-                    m_foundOccurrences.get(provider) = searchBinaryPattern(task, provider, searchRegion, settings.binaryPattern);
-                    break;
-                case Value:
-                    m_foundOccurrences.get(provider) = searchValue(task, provider, searchRegion, settings.value);
-                    break;
-            }
+            m_candidates.get(provider).clear();
+
+            // Results found in a snapshot that went stale don't line up with the data anymore. Data only gets inserted or removed
+            // every now and then, so simply search again in that case
+            prv::Snapshot snapshot;
+            do {
+                snapshot = provider->createSnapshot();
+
+                switch (settings.mode) {
+                    using enum SearchSettings::Mode;
+                    case Strings:
+                        m_foundOccurrences.get(provider) = searchStrings(task, snapshot, searchRegion, settings.strings);
+                        break;
+                    case Sequence:
+                        m_foundOccurrences.get(provider) = searchSequence(task, snapshot, searchRegion, settings.bytes);
+                        break;
+                    case Regex:
+                        m_foundOccurrences.get(provider) = searchRegex(task, snapshot, searchRegion, settings.regex);
+                        break;
+                    case BinaryPattern:
+                        m_foundOccurrences.get(provider) = searchBinaryPattern(task, snapshot, searchRegion, settings.binaryPattern);
+                        break;
+                    case Value: {
+                        auto &candidates = m_candidates.get(provider);
+                        candidates = scanValues(task, provider, snapshot, searchRegion, settings.value);
+                        m_foundOccurrences.get(provider) = getCandidateOccurrences(candidates, settings.value);
+                        break;
+                    }
+                }
+            } while (snapshot.isStale());
 
             m_sortedOccurrences.get(provider) = m_foundOccurrences.get(provider);
+            m_foundGeneration.get(provider)   = snapshot.getGeneration();
+            m_foundSettings.get(provider)     = settings;
 
             for (const auto &occurrence : m_foundOccurrences.get(provider))
                 m_occurrenceTree->insert({ occurrence.region.getStartAddress(), occurrence.region.getEndAddress() }, occurrence);
@@ -539,10 +757,216 @@ namespace hex::plugin::builtin {
         });
     }
 
+    void ViewFind::runNextScan() {
+        // Filters other than equals compare against the previous values, so the values have to be interpreted the same way as during the first scan
+        auto settings = m_foundSettings->value;
+        settings.inputMin = m_searchSettings.value.inputMin;
+        settings.inputMax = m_searchSettings.value.inputMax;
+
+        m_searchTask = TaskManager::createTask("hex.builtin.view.find.searching", TaskManager::NoProgress, [this, settings, filter = m_nextScanFilter](auto &task) {
+            auto provider = ImHexApi::Provider::get();
+            const auto generation = provider->getGeneration();
+
+            // The current candidates aren't modified while the scan runs, the settings that could reset them are disabled until it's done
+            auto candidates  = narrowCandidates(task, provider, m_candidates.get(provider), settings, filter);
+            auto occurrences = getCandidateOccurrences(candidates, settings);
+
+            // The results are drawn every frame, so only swap them in on the main thread
+            TaskManager::doLater([this, provider, generation, candidates = std::move(candidates), occurrences = std::move(occurrences)]() mutable {
+                const auto &providers = ImHexApi::Provider::getProviders();
+                if (std::find(providers.begin(), providers.end(), provider) == providers.end())
+                    return;
+
+                // A new search was started in the meantime, its results replace these anyway
+                if (m_searchTask.isRunning())
+                    return;
+
+                auto &occurrenceTree = m_occurrenceTree.get(provider);
+                occurrenceTree.clear();
+                for (const auto &occurrence : occurrences)
+                    occurrenceTree.insert({ occurrence.region.getStartAddress(), occurrence.region.getEndAddress() }, occurrence);
+
+                m_candidates.get(provider)        = std::move(candidates);
+                m_sortedOccurrences.get(provider) = occurrences;
+                m_foundOccurrences.get(provider)  = std::move(occurrences);
+                m_foundGeneration.get(provider)   = generation;
+
+                EventHighlightingChanged::post();
+            });
+        });
+    }
+
+    bool ViewFind::tryUpdateOccurrences(prv::Provider *provider) {
+        // Don't walk the modification journal again every frame once it's known the results can't be updated
+        const auto generation = provider->getGeneration();
+        if (m_failedUpdateGeneration.get(provider) == generation)
+            return false;
+
+        if (this->updateOccurrences(provider))
+            return true;
+
+        m_failedUpdateGeneration.get(provider) = generation;
+        return false;
+    }
+
+    bool ViewFind::updateOccurrences(prv::Provider *provider) {
+        // Take the snapshot before looking up what changed. Writes that happen in between are covered by the modified regions
+        // and searched again as of the snapshot, writes after it are picked up by the next update
+        auto snapshot = provider->createSnapshot();
+
+        const auto modifiedRegions = provider->getModifiedRegions(m_foundGeneration.get(provider));
+        if (!modifiedRegions.has_value())
+            return false;
+
+        const auto &settings    = m_foundSettings.get(provider);
+        const auto searchRegion = settings.region;
+
+        // Only searches with matches of a bounded size can be updated by searching again around the modified regions.
+        // Value scans are left alone, candidates narrowed down by later scans can't be recreated by searching again
+        u64 maxMatchSize = 0, alignment = 1;
+        switch (settings.mode) {
+            using enum SearchSettings::Mode;
+            case Sequence:
+                maxMatchSize = hex::decodeByteString(settings.bytes.sequence).size() * 2;
+                break;
+            case BinaryPattern:
+                maxMatchSize = settings.binaryPattern.pattern.getSize();
+                alignment    = std::max<u32>(settings.binaryPattern.alignment, 1);
+                break;
+            default:
+                return false;
+        }
+
+        if (maxMatchSize == 0)
+            return false;
+
+        // Expand every modified region by the size of a match so matches that only partially overlap it are found again
+        constexpr static u64 MaxUpdateSize = 0x100'0000;
+        std::vector<std::pair<Region, Region>> updates;
+        u64 updateSize = 0;
+        for (const auto &modifiedRegion : *modifiedRegions) {
+            if (!modifiedRegion.overlaps(searchRegion))
+                continue;
+
+            auto windowStart = std::max<u64>(searchRegion.getStartAddress(), modifiedRegion.getStartAddress() - std::min<u64>(modifiedRegion.getStartAddress(), maxMatchSize - 1));
+            windowStart -= (windowStart - searchRegion.getStartAddress()) % alignment;
+            const auto windowEnd = std::min<u64>(searchRegion.getEndAddress(), modifiedRegion.getEndAddress() + maxMatchSize - 1);
+
+            updates.emplace_back(modifiedRegion, Region { windowStart, windowEnd - windowStart + 1 });
+            updateSize += windowEnd - windowStart + 1;
+        }
+
+        if (updateSize > MaxUpdateSize)
+            return false;
+
+        // Search again in the background and only swap the results in once done, the old ones stay visible until then
+        m_updateTask = TaskManager::createTask("hex.builtin.view.find.searching", TaskManager::NoProgress, [this, settings, snapshot = std::move(snapshot), updates = std::move(updates), occurrences = m_foundOccurrences.get(provider), baseGeneration = m_foundGeneration.get(provider)](auto &task) mutable {
+            for (const auto &[modifiedRegion, window] : updates) {
+                std::erase_if(occurrences, [&](const Occurrence &occurrence) {
+                    return occurrence.region.overlaps(modifiedRegion);
+                });
+
+                std::vector<Occurrence> windowOccurrences;
+                switch (settings.mode) {
+                    using enum SearchSettings::Mode;
+                    case Sequence:
+                        windowOccurrences = searchSequence(task, snapshot, window, settings.bytes);
+                        break;
+                    case BinaryPattern:
+                        windowOccurrences = searchBinaryPattern(task, snapshot, window, settings.binaryPattern);
+                        break;
+                    default:
+                        break;
+                }
+
+                std::copy_if(windowOccurrences.begin(), windowOccurrences.end(), std::back_inserter(occurrences), [&](const Occurrence &occurrence) {
+                    return occurrence.region.overlaps(modifiedRegion);
+                });
+            }
+
+            std::sort(occurrences.begin(), occurrences.end(), [](const Occurrence &left, const Occurrence &right) {
+                return left.region.getStartAddress() < right.region.getStartAddress();
+            });
+
+            // Data got inserted or removed in the meantime. The modified regions of the next update can't be determined either,
+            // so the results stay outdated
+            if (snapshot.isStale())
+                return;
+
+            // The results are stamped with the snapshot's generation, the data they were found in
+            const auto provider   = snapshot.getProvider();
+            const auto generation = snapshot.getGeneration();
+            snapshot = { };
+
+            TaskManager::doLater([this, provider, baseGeneration, generation, occurrences = std::move(occurrences)]() mutable {
+                const auto &providers = ImHexApi::Provider::getProviders();
+                if (std::find(providers.begin(), providers.end(), provider) == providers.end())
+                    return;
+
+                // Drop the results if they were replaced or reset in the meantime or another task is working on them.
+                // If they're still outdated afterwards, the next frame starts another update
+                if (m_searchTask.isRunning() || m_filterTask.isRunning() || m_foundOccurrences.get(provider).empty() || m_foundGeneration.get(provider) != baseGeneration)
+                    return;
+
+                auto &occurrenceTree = m_occurrenceTree.get(provider);
+                occurrenceTree.clear();
+                for (const auto &occurrence : occurrences)
+                    occurrenceTree.insert({ occurrence.region.getStartAddress(), occurrence.region.getEndAddress() }, occurrence);
+
+                m_sortedOccurrences.get(provider) = occurrences;
+                m_foundOccurrences.get(provider)  = std::move(occurrences);
+                m_foundGeneration.get(provider)   = generation;
+
+                EventHighlightingChanged::post();
+            });
+        });
+
+        return true;
+    }
+
     std::string ViewFind::decodeValue(prv::Provider *provider, const Occurrence &occurrence, size_t maxBytes) const {
         std::vector<u8> bytes(std::min<size_t>(occurrence.region.getSize(), maxBytes));
         provider->read(occurrence.region.getStartAddress(), bytes.data(), bytes.size());
 
+        return this->formatValue(bytes, occurrence, maxBytes);
+    }
+
+    std::vector<std::string> ViewFind::decodeValues(prv::Provider *provider, std::span<const Occurrence> occurrences, size_t maxBytes) const {
+        constexpr static size_t BatchSize = 0x1000;
+
+        std::vector<std::string> result;
+        result.reserve(occurrences.size());
+
+        // Read the data of multiple occurrences at once instead of issuing a separate read for every single one of them
+        std::vector<u8> buffer;
+        std::vector<prv::Provider::ReadRequest> requests;
+        for (size_t batchStart = 0; batchStart < occurrences.size(); batchStart += BatchSize) {
+            const auto batch = occurrences.subspan(batchStart, std::min(BatchSize, occurrences.size() - batchStart));
+
+            size_t batchBytes = 0;
+            for (const auto &occurrence : batch)
+                batchBytes += std::min<size_t>(occurrence.region.getSize(), maxBytes);
+
+            buffer.resize(batchBytes);
+            requests.clear();
+
+            size_t bufferOffset = 0;
+            for (const auto &occurrence : batch) {
+                const auto size = std::min<size_t>(occurrence.region.getSize(), maxBytes);
+                requests.push_back({ occurrence.region.getStartAddress(), size, buffer.data() + bufferOffset });
+                bufferOffset += size;
+            }
+
+            provider->readv(requests);
+
+            for (size_t i = 0; i < batch.size(); i += 1)
+                result.push_back(this->formatValue({ static_cast<const u8*>(requests[i].buffer), requests[i].size }, batch[i], maxBytes));
+        }
+
+        return result;
+    }
+
+    std::string ViewFind::formatValue(std::span<const u8> bytes, const Occurrence &occurrence, size_t maxBytes) const {
         std::string result;
         switch (m_decodeSettings.mode) {
             using enum SearchSettings::Mode;
@@ -556,7 +980,7 @@ namespace hex::plugin::builtin {
                     using enum Occurrence::DecodeType;
                     case Binary:
                     case ASCII:
-                        result = hex::encodeByteString(bytes);
+                        result = hex::encodeByteString({ bytes.begin(), bytes.end() });
                         break;
                     case UTF16:
                         for (size_t i = occurrence.endian == std::endian::little ? 0 : 1; i < bytes.size(); i += 2)
@@ -578,7 +1002,7 @@ namespace hex::plugin::builtin {
             }
                 break;
             case BinaryPattern:
-                result = hex::encodeByteString(bytes);
+                result = hex::encodeByteString({ bytes.begin(), bytes.end() });
                 break;
         }
 
@@ -610,12 +1034,14 @@ namespace hex::plugin::builtin {
                             auto provider = ImHexApi::Provider::get();
                             auto bytes = parseHexString(m_replaceBuffer);
 
+                            prv::WriteBatch batch("hex.builtin.undo_operation.modification");
                             for (const auto &occurrence : *m_sortedOccurrences) {
                                 if (occurrence.selected) {
                                     size_t size = std::min<size_t>(occurrence.region.size, bytes.size());
-                                    provider->write(occurrence.region.getStartAddress(), bytes.data(), size);
+                                    batch.write(occurrence.region.getStartAddress(), bytes.data(), size);
                                 }
                             }
+                            provider->write(batch);
                         }
                         ImGui::EndDisabled();
 
@@ -630,12 +1056,14 @@ namespace hex::plugin::builtin {
                             auto provider = ImHexApi::Provider::get();
                             auto bytes = decodeByteString(m_replaceBuffer);
 
+                            prv::WriteBatch batch("hex.builtin.undo_operation.modification");
                             for (const auto &occurrence : *m_sortedOccurrences) {
                                 if (occurrence.selected) {
                                     size_t size = std::min<size_t>(occurrence.region.size, bytes.size());
-                                    provider->write(occurrence.region.getStartAddress(), bytes.data(), size);
+                                    batch.write(occurrence.region.getStartAddress(), bytes.data(), size);
                                 }
                             }
+                            provider->write(batch);
                         }
                         ImGui::EndDisabled();
 
@@ -885,7 +1313,15 @@ namespace hex::plugin::builtin {
             ImGui::EndDisabled();
 
             ImGui::SameLine();
-            ImGuiExt::TextFormatted("hex.builtin.view.find.search.entries"_lang, m_foundOccurrences->size());
+            if (m_candidates->getCount() > m_foundOccurrences->size())
+                ImGuiExt::TextFormatted("hex.builtin.view.find.value.candidates"_lang, m_foundOccurrences->size(), m_candidates->getCount());
+            else
+                ImGuiExt::TextFormatted("hex.builtin.view.find.search.entries"_lang, m_foundOccurrences->size());
+
+            if (!m_foundOccurrences->empty() && !m_searchTask.isRunning() && !m_filterTask.isRunning() && *m_foundGeneration != provider->getGeneration() && !m_updateTask.isRunning() && !this->tryUpdateOccurrences(provider)) {
+                ImGui::SameLine();
+                ImGuiExt::TextFormattedColored(ImGui::GetStyleColorVec4(ImGuiCol_TextDisabled), "{}", "hex.builtin.view.find.search.outdated"_lang);
+            }
 
             ImGui::BeginDisabled(m_foundOccurrences->empty());
             {
@@ -893,11 +1329,43 @@ namespace hex::plugin::builtin {
                     m_foundOccurrences->clear();
                     m_sortedOccurrences->clear();
                     m_occurrenceTree->clear();
+                    m_candidates->clear();
 
                     EventHighlightingChanged::post();
                 }
             }
             ImGui::EndDisabled();
+
+            if (m_searchSettings.mode == SearchSettings::Mode::Value && !m_candidates->empty()) {
+                ImGui::NewLine();
+
+                const std::array<std::string, 5> Filters = {
+                        "hex.builtin.view.find.value.next_scan.equals"_lang,
+                        "hex.builtin.view.find.value.next_scan.changed"_lang,
+                        "hex.builtin.view.find.value.next_scan.unchanged"_lang,
+                        "hex.builtin.view.find.value.next_scan.increased"_lang,
+                        "hex.builtin.view.find.value.next_scan.decreased"_lang
+                };
+
+                if (ImGui::BeginCombo("hex.builtin.view.find.value.next_scan.filter"_lang, Filters[std::to_underlying(m_nextScanFilter)].c_str())) {
+                    for (size_t i = 0; i < Filters.size(); i++) {
+                        auto filter = static_cast<NextScanFilter>(i);
+
+                        if (ImGui::Selectable(Filters[i].c_str(), filter == m_nextScanFilter))
+                            m_nextScanFilter = filter;
+                    }
+                    ImGui::EndCombo();
+                }
+
+                // The candidates keep the type of the first scan, values to compare against have to be entered as that type as well
+                const bool inputValid = m_settingsValid && m_searchSettings.value.type == m_foundSettings->value.type;
+                ImGui::BeginDisabled(m_nextScanFilter == NextScanFilter::Equals && !inputValid);
+                {
+                    if (ImGui::Button("hex.builtin.view.find.value.next_scan"_lang))
+                        this->runNextScan();
+                }
+                ImGui::EndDisabled();
+            }
         }
         ImGui::EndDisabled();
 
@@ -918,13 +1386,21 @@ namespace hex::plugin::builtin {
 
             if (!m_currFilter->empty()) {
                 m_filterTask = TaskManager::createTask("Filtering", currOccurrences.size(), [this, provider, &currOccurrences](Task &task) {
-                    u64 progress = 0;
-                    std::erase_if(currOccurrences, [this, provider, &task, &progress](const auto &region) {
-                        task.update(progress);
-                        progress += 1;
+                    constexpr static size_t BatchSize = 0x1000;
+
+                    std::vector<Occurrence> filteredOccurrences;
+                    for (size_t batchStart = 0; batchStart < currOccurrences.size(); batchStart += BatchSize) {
+                        task.update(batchStart);
+
+                        const auto batch  = std::span(currOccurrences).subspan(batchStart, std::min(BatchSize, currOccurrences.size() - batchStart));
+                        const auto values = this->decodeValues(provider, batch);
+                        for (size_t i = 0; i < batch.size(); i += 1) {
+                            if (hex::containsIgnoreCase(values[i], m_currFilter.get(provider)))
+                                filteredOccurrences.push_back(batch[i]);
+                        }
+                    }
 
-                        return !hex::containsIgnoreCase(this->decodeValue(provider, region), m_currFilter.get(provider));
-                    });
+                    currOccurrences = std::move(filteredOccurrences);
                 });
             }
         }
@@ -938,8 +1414,28 @@ namespace hex::plugin::builtin {
 
             auto sortSpecs = ImGui::TableGetSortSpecs();
 
-            if (sortSpecs->SpecsDirty) {
-                std::sort(currOccurrences.begin(), currOccurrences.end(), [this, &sortSpecs, provider](const Occurrence &left, const Occurrence &right) -> bool {
+            if (sortSpecs->SpecsDirty && sortSpecs->Specs->ColumnUserID == ImGui::GetID("value")) {
+                // Decode all values once up front instead of reading both values again for every single comparison
+                const auto values = this->decodeValues(provider, currOccurrences);
+
+                std::vector<size_t> order(currOccurrences.size());
+                std::iota(order.begin(), order.end(), 0);
+                std::sort(order.begin(), order.end(), [&values, &sortSpecs](size_t left, size_t right) -> bool {
+                    if (sortSpecs->Specs->SortDirection == ImGuiSortDirection_Ascending)
+                        return values[left] > values[right];
+                    else
+                        return values[left] < values[right];
+                });
+
+                std::vector<Occurrence> sortedOccurrences;
+                sortedOccurrences.reserve(order.size());
+                for (auto index : order)
+                    sortedOccurrences.push_back(currOccurrences[index]);
+
+                currOccurrences = std::move(sortedOccurrences);
+                sortSpecs->SpecsDirty = false;
+            } else if (sortSpecs->SpecsDirty) {
+                std::sort(currOccurrences.begin(), currOccurrences.end(), [&sortSpecs](const Occurrence &left, const Occurrence &right) -> bool {
                     if (sortSpecs->Specs->ColumnUserID == ImGui::GetID("offset")) {
                         if (sortSpecs->Specs->SortDirection == ImGuiSortDirection_Ascending)
                             return left.region.getStartAddress() > right.region.getStartAddress();
@@ -950,11 +1446,6 @@ namespace hex::plugin::builtin {
                             return left.region.getSize() > right.region.getSize();
                         else
                             return left.region.getSize() < right.region.getSize();
-                    } else if (sortSpecs->Specs->ColumnUserID == ImGui::GetID("value")) {
-                        if (sortSpecs->Specs->SortDirection == ImGuiSortDirection_Ascending)
-                            return this->decodeValue(provider, left) > this->decodeValue(provider, right);
-                        else
-                            return this->decodeValue(provider, left) < this->decodeValue(provider, right);
                     }
 
                     return false;
@@ -13,6 +13,7 @@
 #include <wolv/math_eval/math_evaluator.hpp>
 
 #include <content/providers/view_provider.hpp>
+#include <content/providers/undo_operations/operation_fill.hpp>
 #include <popups/popup_file_chooser.hpp>
 
 #include <imgui_internal.h>
@@ -537,13 +538,22 @@ namespace hex::plugin::builtin {
                 return;
 
             auto provider = ImHexApi::Provider::get();
-            u32 patchCount = 0;
-            for (u64 i = 0; i < size; i += bytes.size()) {
-                auto remainingSize = std::min<size_t>(size - i, bytes.size());
-                provider->write(provider->getBaseAddress() + address + i, bytes.data(), remainingSize);
-                patchCount += 1;
-            }
-            provider->getUndoStack().groupOperations(patchCount, "hex.builtin.undo_operation.fill");
+
+            TaskManager::createTask("hex.ui.common.processing", size, [provider, address, size, bytes = std::move(bytes)](Task &task) {
+                provider->getUndoStack().add<undo::OperationFill>(address, size, bytes, [&task](u64 processed, u64 total) {
+                    task.setMaxValue(total);
+
+                    // Task::update() throws once the task got interrupted. Unwinding out of the undo stack halfway through the operation
+                    // would leave the stack in an inconsistent state, so stop the fill through the return value instead
+                    try {
+                        task.update(processed);
+                        return true;
+                    } catch (...) {
+                        return false;
+                    }
+                });
+                provider->markDirty();
+            });
 
             AchievementManager::unlockAchievement("hex.builtin.achievement.hex_editor", "hex.builtin.achievement.hex_editor.fill.name");
         }
@@ -102,12 +102,14 @@ namespace hex::plugin::builtin {
                 m_chunkBasedEntropy.reset(m_inputChunkSize, m_analysisRegion.getStartAddress(), m_analysisRegion.getEndAddress(),
                     provider->getBaseAddress(), provider->getActualSize());
 
-                // Create a handle to the file
-                auto reader = prv::ProviderReader(provider);
+                // Analyze a snapshot of the data so edits made in the meantime don't end up in the results halfway through
+                const auto snapshot = provider->createSnapshot();
+                auto reader = prv::ProviderReader(snapshot);
                 reader.seek(m_analysisRegion.getStartAddress());
                 reader.setEndAddress(m_analysisRegion.getEndAddress());
 
-                m_analyzedRegion = m_analysisRegion;
+                m_analyzedRegion     = m_analysisRegion;
+                m_analyzedGeneration = snapshot.getGeneration();
 
                 u64 count = 0;
 
@@ -129,6 +131,12 @@ namespace hex::plugin::builtin {
                 m_lowestBlockEntropy = m_chunkBasedEntropy.getLowestEntropyBlockValue();
                 m_lowestBlockEntropyAddress = m_chunkBasedEntropy.getLowestEntropyBlockAddress();
                 m_plainTextCharacterPercentage = m_byteTypesDistribution.getPlainTextCharacterPercentage();
+
+                // Data got inserted or removed while analyzing, the results don't line up with the data anymore
+                if (snapshot.isStale()) {
+                    m_dataValid = false;
+                    return;
+                }
             }
                 
             m_dataValid = true;
@@ -196,6 +204,9 @@ namespace hex::plugin::builtin {
                         ImGui::EndTable();
                     }
 
+                    if (m_analyzedGeneration != provider->getGeneration())
+                        ImGuiExt::TextFormattedColored(ImGui::GetStyleColorVec4(ImGuiCol_TextDisabled), "{}", "hex.builtin.view.information.outdated"_lang);
+
                     // Magic information
                     if (!(m_dataDescription.empty() && m_dataMimeType.empty())) {
                         ImGuiExt::Header("hex.builtin.view.information.magic"_lang);
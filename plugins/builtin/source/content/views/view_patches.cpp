@@ -3,11 +3,13 @@
 #include <hex/providers/provider.hpp>
 
 #include <hex/api/project_file_manager.hpp>
+#include <hex/helpers/patches.hpp>
 #include <nlohmann/json.hpp>
 
 #include <content/providers/undo_operations/operation_write.hpp>
 #include <content/providers/undo_operations/operation_insert.hpp>
 #include <content/providers/undo_operations/operation_remove.hpp>
+#include <content/providers/undo_operations/operation_write_batch.hpp>
 
 #include <ranges>
 #include <string>
@@ -19,26 +21,47 @@ namespace hex::plugin::builtin {
     ViewPatches::ViewPatches() : View::Window("hex.builtin.view.patches.name") {
 
         ProjectFile::registerPerProviderHandler({
-            .basePath = "patches.json",
+            .basePath = "patches.bin",
             .required = false,
             .load = [](prv::Provider *provider, const std::fs::path &basePath, const Tar &tar) {
-                auto json = nlohmann::json::parse(tar.readString(basePath));
-                auto patches = json.at("patches").get<std::map<u64, u8>>();
-
-                for (const auto &[address, value] : patches) {
-                    provider->write(address, &value, sizeof(value));
+                const auto baseAddress = provider->getBaseAddress();
+                prv::WriteBatch batch("hex.builtin.undo_operation.patches");
+
+                if (tar.contains(basePath)) {
+                    auto patches = Patches::fromExtentStream(tar.readVector(basePath));
+                    if (!patches.has_value())
+                        return false;
+
+                    patches->get().forEachExtent([&](u64 address, std::span<const u8> data) {
+                        batch.write(baseAddress + address, data.data(), data.size());
+                    });
+                } else if (const auto legacyPath = basePath.parent_path() / "patches.json"; tar.contains(legacyPath)) {
+                    // Projects created by older versions store every patched byte as a separate JSON entry
+                    auto json = nlohmann::json::parse(tar.readString(legacyPath));
+                    auto patches = json.at("patches").get<std::map<u64, u8>>();
+
+                    for (const auto &[address, value] : patches) {
+                        batch.write(baseAddress + address, &value, sizeof(value));
+                    }
                 }
 
-                provider->getUndoStack().groupOperations(patches.size(), "hex.builtin.undo_operation.patches");
+                provider->write(batch);
 
                 return true;
             },
-            .store = [](prv::Provider *, const std::fs::path &, Tar &) {
+            .store = [](prv::Provider *provider, const std::fs::path &basePath, const Tar &tar) {
+                auto patches = Patches::fromProvider(provider);
+                if (!patches.has_value())
+                    return false;
+
+                if (!patches->get().empty())
+                    tar.writeVector(basePath, patches->toExtentStream());
+
                 return true;
             }
         });
 
-        ImHexApi::HexEditor::addForegroundHighlightingProvider([](u64 offset, const u8* buffer, size_t, bool) -> std::optional<color_t> {
+        ImHexApi::HexEditor::addForegroundHighlightingProvider([this](u64 offset, const u8* buffer, size_t, bool) -> std::optional<color_t> {
             hex::unused(buffer);
 
             if (!ImHexApi::Provider::isValid())
@@ -48,12 +71,26 @@ namespace hex::plugin::builtin {
 
             offset -= provider->getBaseAddress();
 
+            // The hex editor asks for every byte separately. Query the undo stack once for the entire block of bytes
+            // around the requested one and answer the following requests from that result
             const auto &undoStack = provider->getUndoStack();
-            for (const auto &operation : undoStack.getAppliedOperations()) {
-                if (!operation->shouldHighlight())
-                    continue;
+            auto &cache = m_highlightCache.get(provider);
+            if (cache.revision != undoStack.getRevision() || !cache.block.overlaps(Region { offset, 1 })) {
+                const auto revision = undoStack.getRevision();
+                const auto block    = Region { offset - (offset % HighlightBlockSize), HighlightBlockSize };
+
+                // The stack is busy executing operations on another thread, try again next time
+                auto regions = undoStack.getHighlightedRegions(block);
+                if (!regions.has_value())
+                    return std::nullopt;
+
+                cache.revision = revision;
+                cache.block    = block;
+                cache.regions  = std::move(*regions);
+            }
 
-                if (operation->getRegion().overlaps(Region { offset, 1}))
+            for (const auto &region : cache.regions) {
+                if (region.overlaps(Region { offset, 1 }))
                     return ImGuiExt::GetCustomColorU32(ImGuiCustomCol_Patches);
             }
 
@@ -75,6 +112,28 @@ namespace hex::plugin::builtin {
             provider->getUndoStack().add<undo::OperationWrite>(offset, size, oldData.data(), data);
         });
 
+        EventProviderDataBatchModified::subscribe(this, [](prv::Provider *provider, const prv::WriteBatch &batch) {
+            const auto baseAddress = provider->getBaseAddress();
+
+            std::vector<undo::OperationWriteBatch::Run> runs;
+            std::vector<u8> oldData(batch.getSize()), newData;
+            std::vector<prv::Provider::ReadRequest> requests;
+
+            runs.reserve(batch.getRunCount());
+            requests.reserve(batch.getRunCount());
+            newData.reserve(oldData.size());
+
+            batch.forEachRun([&](u64 address, std::span<const u8> data) {
+                requests.push_back({ address, data.size(), oldData.data() + newData.size() });
+                runs.push_back({ address - baseAddress, data.size() });
+                newData.insert(newData.end(), data.begin(), data.end());
+            });
+
+            // Fetch the previous data of all runs at once instead of issuing one read per run
+            provider->readv(requests, false);
+            provider->getUndoStack().add<undo::OperationWriteBatch>(batch.getUnlocalizedName(), std::move(runs), std::move(oldData), std::move(newData));
+        });
+
         EventProviderDataInserted::subscribe(this, [](prv::Provider *provider, u64 offset, u64 size) {
             offset -= provider->getBaseAddress();
 
@@ -102,11 +161,17 @@ namespace hex::plugin::builtin {
                 ImGui::TableHeadersRow();
 
                 const auto &undoRedoStack = provider->getUndoStack();
+
+                // Don't block the UI while another thread is modifying the undo stack, the list gets drawn again next frame
+                const auto stackLock = undoRedoStack.tryLockShared();
+
                 std::vector<prv::undo::Operation*> operations;
-                for (const auto &operation : undoRedoStack.getUndoneOperations())
-                    operations.push_back(operation.get());
-                for (const auto &operation : undoRedoStack.getAppliedOperations() | std::views::reverse)
-                    operations.push_back(operation.get());
+                if (stackLock.owns_lock()) {
+                    for (const auto &operation : undoRedoStack.getUndoneOperations())
+                        operations.push_back(operation.get());
+                    for (const auto &operation : undoRedoStack.getAppliedOperations() | std::views::reverse)
+                        operations.push_back(operation.get());
+                }
 
                 u32 index = 0;
 
@@ -174,9 +239,9 @@ namespace hex::plugin::builtin {
 
     void ViewPatches::drawAlwaysVisibleContent() {
         if (auto provider = ImHexApi::Provider::get(); provider != nullptr) {
-            const auto &operations = provider->getUndoStack().getAppliedOperations();
-            if (m_numOperations.get(provider) != operations.size()) {
-                m_numOperations.get(provider) = operations.size();
+            const auto revision = provider->getUndoStack().getRevision();
+            if (m_undoStackRevision.get(provider) != revision) {
+                m_undoStackRevision.get(provider) = revision;
                 EventHighlightingChanged::post();
             }
         }
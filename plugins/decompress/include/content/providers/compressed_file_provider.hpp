@@ -0,0 +1,132 @@
+#pragma once
+
+#include <hex/providers/provider.hpp>
+#include <hex/providers/block_cache.hpp>
+
+#include <wolv/io/file.hpp>
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+
+namespace hex::plugin::decompress {
+
+    /**
+     * @brief Read-only provider showing the decompressed contents of a .gz, .zst, .xz or .bz2 file
+     * @note Instead of decompressing the whole file, a seek point index is built once and stored next to the file.
+     * Reads decompress from the closest seek point before the requested address and a cache of recently decompressed
+     * blocks sits on top, so only the parts of the file that are actually being looked at ever get decompressed
+     */
+    class CompressedFileProvider : public hex::prv::Provider {
+    public:
+        enum class Format : u8 {
+            Unknown     = 0,
+            GZip        = 1,
+            ZStandard   = 2,
+            XZ          = 3,
+            BZip2       = 4
+        };
+
+        struct SeekPoint {
+            u64 uncompressedOffset;
+            u64 compressedOffset;
+
+            // True if decoding starts with a gzip member, zstd frame, xz block or bzip2 stream header at the compressed offset.
+            // Otherwise the point lies between two deflate blocks and the decoder needs to be primed using the fields below
+            bool streamStart;
+
+            // gzip: Number of bits of the byte before the compressed offset that belong to the next block
+            // xz: Check type of the stream the block belongs to
+            u8 bits;
+
+            // gzip: zlib compressed copy of the last 32 KiB of data decompressed before the point
+            std::vector<u8> window;
+        };
+
+        struct Index {
+            Format format = Format::Unknown;
+            u64 uncompressedSize = 0;
+            std::vector<SeekPoint> seekPoints;
+        };
+
+        using ProgressCallback = std::function<void(u64 processedBytes)>;
+
+        /**
+         * @brief Resumable decompressor for one of the supported formats, starting at a seek point
+         */
+        class Decoder;
+
+        CompressedFileProvider();
+        ~CompressedFileProvider() override;
+
+        [[nodiscard]] bool isAvailable() const override { return m_dataValid; }
+        [[nodiscard]] bool isReadable() const override { return true; }
+        [[nodiscard]] bool isWritable() const override { return false; }
+        [[nodiscard]] bool isResizable() const override { return false; }
+        [[nodiscard]] bool isSavable() const override { return false; }
+
+        void readRaw(u64 offset, void *buffer, size_t size) override;
+        void writeRaw(u64 offset, const void *buffer, size_t size) override;
+        [[nodiscard]] u64 getActualSize() const override;
+
+        bool open() override;
+        void close() override;
+
+        [[nodiscard]] std::string getName() const override;
+        [[nodiscard]] std::vector<Description> getDataDescription() const override;
+
+        void loadSettings(const nlohmann::json &settings) override;
+        [[nodiscard]] nlohmann::json storeSettings(nlohmann::json settings) const override;
+
+        [[nodiscard]] std::string getTypeName() const override {
+            return "hex.decompress.provider.compressed_file";
+        }
+
+        [[nodiscard]] bool hasFilePicker() const override { return true; }
+        [[nodiscard]] bool handleFilePicker() override;
+
+        void setPath(const std::fs::path &path) { m_path = path; }
+
+        /**
+         * @brief Sets an index built beforehand so open() doesn't have to load or build it itself
+         */
+        void setIndex(Index index) { m_index = std::move(index); }
+
+        /**
+         * @brief Detects the compression format of a file from its magic bytes
+         */
+        [[nodiscard]] static Format detectFormat(std::span<const u8> data);
+
+        /**
+         * @brief Builds a seek point index by decompressing the entire data once
+         * @param data Compressed file contents
+         * @param progressCallback Called regularly with the number of compressed bytes processed so far
+         * @return The index or std::nullopt if the data is corrupted or its format isn't supported
+         */
+        [[nodiscard]] static std::optional<Index> buildIndex(std::span<const u8> data, const ProgressCallback &progressCallback);
+
+        [[nodiscard]] static std::optional<Index> loadIndex(const std::fs::path &path);
+        static void storeIndex(const std::fs::path &path, const Index &index);
+
+    private:
+        [[nodiscard]] bool decompress(u64 address, void *buffer, size_t size);
+        [[nodiscard]] std::unique_ptr<Decoder> createDecoder(size_t seekPointIndex) const;
+
+    private:
+        std::fs::path m_path;
+        wolv::io::File m_file;
+        std::span<const u8> m_data;
+        bool m_dataValid = false;
+
+        std::optional<Index> m_index;
+        prv::BlockCache m_cache;
+
+        std::mutex m_decoderMutex;
+        std::unique_ptr<Decoder> m_decoder;
+        size_t m_decoderSeekPoint = 0;
+        u64 m_decoderPosition = 0;
+    };
+
+}
@@ -0,0 +1,11 @@
+#include <hex/api/content_registry.hpp>
+
+#include <content/providers/compressed_file_provider.hpp>
+
+namespace hex::plugin::decompress {
+
+    void registerProviders() {
+        ContentRegistry::Provider::add<CompressedFileProvider>();
+    }
+
+}
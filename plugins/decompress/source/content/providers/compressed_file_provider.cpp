@@ -0,0 +1,1091 @@
+#include "content/providers/compressed_file_provider.hpp"
+
+#include <hex/plugin.hpp>
+
+#include <hex/api/event_manager.hpp>
+#include <hex/api/imhex_api.hpp>
+#include <hex/api/localization_manager.hpp>
+#include <hex/api/task_manager.hpp>
+#include <hex/helpers/fmt.hpp>
+#include <hex/helpers/fs.hpp>
+#include <hex/helpers/logger.hpp>
+#include <hex/helpers/utils.hpp>
+
+#include <toasts/toast_notification.hpp>
+
+#include <nlohmann/json.hpp>
+
+#include <wolv/io/fs.hpp>
+#include <wolv/utils/guards.hpp>
+#include <wolv/utils/string.hpp>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <utility>
+
+#if IMHEX_FEATURE_ENABLED(ZLIB)
+    #include <zlib.h>
+#endif
+#if IMHEX_FEATURE_ENABLED(BZIP2)
+    #include <bzlib.h>
+#endif
+#if IMHEX_FEATURE_ENABLED(LIBLZMA)
+    #include <lzma.h>
+#endif
+#if IMHEX_FEATURE_ENABLED(ZSTD)
+    #include <zstd.h>
+#endif
+
+namespace hex::plugin::decompress {
+
+    class CompressedFileProvider::Decoder {
+    public:
+        virtual ~Decoder() = default;
+
+        /**
+         * @brief Decompresses the next bytes
+         * @return Number of bytes written to the buffer. Zero once the end of the data has been reached or the data is corrupted
+         */
+        [[nodiscard]] virtual size_t decode(u8 *buffer, size_t size) = 0;
+    };
+
+    namespace {
+
+        using Format    = CompressedFileProvider::Format;
+        using Index     = CompressedFileProvider::Index;
+        using SeekPoint = CompressedFileProvider::SeekPoint;
+        using Decoder   = CompressedFileProvider::Decoder;
+
+        constexpr static size_t CacheBlockSize = 0x1'0000;
+        constexpr static size_t CacheMaxBlocks = 256;
+        constexpr static size_t SkipBufferSize = 0x1'0000;
+
+        // zlib and bzip2 take sizes as 32 bit integers, data is passed to them in pieces of at most this size
+        constexpr static size_t MaxChunkSize = 0x4000'0000;
+
+        // Input size between two progress updates while building an index
+        constexpr static size_t IndexChunkSize = 0x10'0000;
+
+        constexpr static std::array<u8, 8> IndexMagic = { 'I', 'M', 'H', 'X', 'S', 'E', 'E', 'K' };
+        constexpr static u32 IndexVersion = 1;
+
+        std::fs::path getIndexPath(const std::fs::path &path) {
+            auto result = path;
+            result += ".imhexidx";
+
+            return result;
+        }
+
+        bool isFormatSupported(Format format) {
+            switch (format) {
+                case Format::GZip:      return IMHEX_FEATURE_ENABLED(ZLIB);
+                case Format::ZStandard: return IMHEX_FEATURE_ENABLED(ZSTD);
+                case Format::XZ:        return IMHEX_FEATURE_ENABLED(LIBLZMA);
+                case Format::BZip2:     return IMHEX_FEATURE_ENABLED(BZIP2);
+                default:                return false;
+            }
+        }
+
+        const char* getFormatName(Format format) {
+            switch (format) {
+                case Format::GZip:      return "gzip";
+                case Format::ZStandard: return "zstd";
+                case Format::XZ:        return "xz";
+                case Format::BZip2:     return "bzip2";
+                default:                return "???";
+            }
+        }
+
+        #if IMHEX_FEATURE_ENABLED(ZLIB)
+
+            constexpr static size_t DeflateWindowSize = 0x8000;
+            constexpr static size_t GZipTrailerSize   = 8;
+
+            // Decoding restarts from a checkpoint, so this is the most that has to be decompressed to get to any address
+            constexpr static u64 GZipCheckpointInterval = 8 * 0x10'0000;
+
+            // Window bits value that makes zlib expect a gzip header and use the largest window
+            constexpr static int GZipWindowBits = 15 + 16;
+
+            bool isGZipMember(std::span<const u8> data, u64 offset) {
+                return offset + 2 <= data.size() && data[offset] == 0x1F && data[offset + 1] == 0x8B;
+            }
+
+            std::vector<u8> compressWindow(std::span<const u8> window) {
+                std::vector<u8> result(compressBound(window.size()));
+
+                uLongf size = result.size();
+                if (compress2(result.data(), &size, window.data(), window.size(), Z_BEST_COMPRESSION) != Z_OK)
+                    return { };
+
+                result.resize(size);
+                return result;
+            }
+
+            std::optional<std::vector<u8>> decompressWindow(std::span<const u8> data) {
+                std::vector<u8> result(DeflateWindowSize);
+
+                uLongf size = result.size();
+                if (uncompress(result.data(), &size, data.data(), data.size()) != Z_OK)
+                    return std::nullopt;
+
+                result.resize(size);
+                return result;
+            }
+
+            class GZipDecoder : public Decoder {
+            public:
+                GZipDecoder(std::span<const u8> data, const SeekPoint &seekPoint) : m_data(data), m_position(seekPoint.compressedOffset) {
+                    if (seekPoint.streamStart) {
+                        m_initialized = inflateInit2(&m_stream, GZipWindowBits) == Z_OK;
+                        m_valid = m_initialized;
+                        return;
+                    }
+
+                    // Checkpoints lie between two deflate blocks, continue decoding the raw deflate stream from there
+                    m_initialized = inflateInit2(&m_stream, -15) == Z_OK;
+                    m_raw = true;
+                    if (!m_initialized)
+                        return;
+
+                    // The next block may start in the middle of the byte before the checkpoint
+                    if (seekPoint.bits > 0) {
+                        if (m_position == 0 || inflatePrime(&m_stream, seekPoint.bits, m_data[m_position - 1] >> (8 - seekPoint.bits)) != Z_OK)
+                            return;
+                    }
+
+                    const auto window = decompressWindow(seekPoint.window);
+                    if (!window.has_value() || inflateSetDictionary(&m_stream, window->data(), window->size()) != Z_OK)
+                        return;
+
+                    m_valid = true;
+                }
+
+                ~GZipDecoder() override {
+                    if (m_initialized)
+                        inflateEnd(&m_stream);
+                }
+
+                size_t decode(u8 *buffer, size_t size) override {
+                    size = std::min(size, MaxChunkSize);
+                    m_stream.next_out  = buffer;
+                    m_stream.avail_out = uInt(size);
+
+                    while (m_valid && m_stream.avail_out > 0) {
+                        if (m_stream.avail_in == 0) {
+                            if (m_position >= m_data.size()) {
+                                m_valid = false;
+                                break;
+                            }
+
+                            const auto chunkSize = std::min<u64>(m_data.size() - m_position, MaxChunkSize);
+                            m_stream.next_in  = const_cast<u8*>(m_data.data() + m_position);
+                            m_stream.avail_in = uInt(chunkSize);
+                            m_position += chunkSize;
+                        }
+
+                        const auto result = inflate(&m_stream, Z_NO_FLUSH);
+                        if (result == Z_STREAM_END) {
+                            // Continue with the next member of the file if there is one. Raw deflate streams leave the member's trailer unread
+                            const auto nextMember = m_position - m_stream.avail_in + (m_raw ? GZipTrailerSize : 0);
+                            if (!isGZipMember(m_data, nextMember) || inflateReset2(&m_stream, GZipWindowBits) != Z_OK) {
+                                m_valid = false;
+                                break;
+                            }
+
+                            m_raw = false;
+                            m_position = nextMember;
+                            m_stream.avail_in = 0;
+                        } else if (result != Z_OK) {
+                            m_valid = false;
+                        }
+                    }
+
+                    return size - m_stream.avail_out;
+                }
+
+            private:
+                std::span<const u8> m_data;
+                u64 m_position;
+
+                z_stream m_stream = { };
+                bool m_initialized = false;
+                bool m_valid = false;
+                bool m_raw = false;
+            };
+
+            std::optional<Index> buildGZipIndex(std::span<const u8> data, const CompressedFileProvider::ProgressCallback &progressCallback) {
+                z_stream stream = { };
+                if (inflateInit2(&stream, GZipWindowBits) != Z_OK)
+                    return std::nullopt;
+                ON_SCOPE_EXIT { inflateEnd(&stream); };
+
+                Index index;
+                index.format = Format::GZip;
+                index.seekPoints.push_back({ 0, 0, true, 0, { } });
+
+                // Decompressed data is written into the window in a circle, so it always contains the last 32 KiB of output
+                std::array<u8, DeflateWindowSize> window = { };
+                u64 position = 0, totalIn = 0, totalOut = 0;
+
+                while (true) {
+                    if (stream.avail_in == 0) {
+                        if (position >= data.size())
+                            return std::nullopt;
+
+                        const auto chunkSize = std::min<u64>(data.size() - position, IndexChunkSize);
+                        stream.next_in  = const_cast<u8*>(data.data() + position);
+                        stream.avail_in = uInt(chunkSize);
+                        position += chunkSize;
+
+                        progressCallback(totalIn);
+                    }
+
+                    if (stream.avail_out == 0) {
+                        stream.next_out  = window.data();
+                        stream.avail_out = uInt(window.size());
+                    }
+
+                    const auto availableIn  = stream.avail_in;
+                    const auto availableOut = stream.avail_out;
+
+                    // Z_BLOCK makes inflate return at the end of every deflate block, which are the only places it can be resumed from
+                    const auto result = inflate(&stream, Z_BLOCK);
+                    totalIn  += availableIn - stream.avail_in;
+                    totalOut += availableOut - stream.avail_out;
+
+                    if (result == Z_STREAM_END) {
+                        if (!isGZipMember(data, totalIn))
+                            break;
+
+                        if (inflateReset2(&stream, GZipWindowBits) != Z_OK)
+                            return std::nullopt;
+
+                        position = totalIn;
+                        stream.avail_in = 0;
+
+                        // Member starts can be decoded without any additional state, so every one of them becomes a seek point
+                        if (totalOut > index.seekPoints.back().uncompressedOffset)
+                            index.seekPoints.push_back({ totalOut, totalIn, true, 0, { } });
+
+                        continue;
+                    }
+
+                    if (result != Z_OK)
+                        return std::nullopt;
+
+                    // Bit 7 is set at the end of a block, bit 6 while decoding the last block of a deflate stream
+                    const bool blockEnd = (stream.data_type & 0x80) != 0 && (stream.data_type & 0x40) == 0;
+                    if (blockEnd && totalOut - index.seekPoints.back().uncompressedOffset >= GZipCheckpointInterval) {
+                        const auto windowPosition = window.size() - stream.avail_out;
+
+                        std::array<u8, DeflateWindowSize> orderedWindow;
+                        std::copy(window.begin() + windowPosition, window.end(), orderedWindow.begin());
+                        std::copy(window.begin(), window.begin() + windowPosition, orderedWindow.end() - windowPosition);
+
+                        index.seekPoints.push_back({ totalOut, totalIn, false, u8(stream.data_type & 0x07), compressWindow(orderedWindow) });
+                    }
+                }
+
+                index.uncompressedSize = totalOut;
+                return index;
+            }
+
+        #endif
+
+        #if IMHEX_FEATURE_ENABLED(ZSTD)
+
+            class ZStdDecoder : public Decoder {
+            public:
+                ZStdDecoder(std::span<const u8> data, const SeekPoint &seekPoint) : m_stream(ZSTD_createDStream()) {
+                    m_input = { data.data() + seekPoint.compressedOffset, data.size() - seekPoint.compressedOffset, 0 };
+                    m_valid = m_stream != nullptr && !ZSTD_isError(ZSTD_initDStream(m_stream));
+                }
+
+                ~ZStdDecoder() override {
+                    ZSTD_freeDStream(m_stream);
+                }
+
+                size_t decode(u8 *buffer, size_t size) override {
+                    ZSTD_outBuffer output = { buffer, size, 0 };
+
+                    while (m_valid && output.pos < output.size) {
+                        const auto inputPosition  = m_input.pos;
+                        const auto outputPosition = output.pos;
+
+                        // Frames following each other are decoded one after another by the same stream
+                        const auto result = ZSTD_decompressStream(m_stream, &output, &m_input);
+                        if (ZSTD_isError(result))
+                            m_valid = false;
+                        else if (m_input.pos == inputPosition && output.pos == outputPosition)
+                            break;
+                    }
+
+                    return output.pos;
+                }
+
+            private:
+                ZSTD_DStream *m_stream;
+                ZSTD_inBuffer m_input = { };
+                bool m_valid = false;
+            };
+
+            std::optional<Index> buildZStdIndex(std::span<const u8> data, const CompressedFileProvider::ProgressCallback &progressCallback) {
+                Index index;
+                index.format = Format::ZStandard;
+
+                // Every frame can be decoded on its own, the frame headers usually store how much data they contain
+                u64 offset = 0, totalOut = 0;
+                while (offset < data.size()) {
+                    const auto frame = data.subspan(offset);
+                    const auto frameSize = ZSTD_findFrameCompressedSize(frame.data(), frame.size());
+                    if (ZSTD_isError(frameSize)) {
+                        if (offset == 0)
+                            return std::nullopt;
+
+                        break;
+                    }
+
+                    auto contentSize = ZSTD_getFrameContentSize(frame.data(), frameSize);
+                    if (contentSize == ZSTD_CONTENTSIZE_ERROR)
+                        return std::nullopt;
+
+                    if (contentSize == ZSTD_CONTENTSIZE_UNKNOWN) {
+                        // Frames written by a streaming compressor don't know their size in advance, decompress them to find it out
+                        ZStdDecoder decoder(data.first(offset + frameSize), { 0, offset, true, 0, { } });
+                        std::vector<u8> buffer(ZSTD_DStreamOutSize());
+
+                        contentSize = 0;
+                        while (const auto decoded = decoder.decode(buffer.data(), buffer.size())) {
+                            contentSize += decoded;
+                            progressCallback(offset);
+                        }
+                    }
+
+                    if (contentSize > 0)
+                        index.seekPoints.push_back({ totalOut, offset, true, 0, { } });
+
+                    totalOut += contentSize;
+                    offset   += frameSize;
+
+                    progressCallback(offset);
+                }
+
+                index.uncompressedSize = totalOut;
+                return index;
+            }
+
+        #endif
+
+        #if IMHEX_FEATURE_ENABLED(LIBLZMA)
+
+            class XZDecoder : public Decoder {
+            public:
+                XZDecoder(std::span<const u8> data, const SeekPoint &seekPoint) {
+                    auto input = data.subspan(seekPoint.compressedOffset);
+                    if (input.empty())
+                        return;
+
+                    std::array<lzma_filter, LZMA_FILTERS_MAX + 1> filters;
+
+                    m_block.version     = 0;
+                    m_block.check       = lzma_check(seekPoint.bits);
+                    m_block.filters     = filters.data();
+                    m_block.header_size = lzma_block_header_size_decode(input[0]);
+
+                    if (input.size() < m_block.header_size || lzma_block_header_decode(&m_block, nullptr, input.data()) != LZMA_OK)
+                        return;
+
+                    m_valid = lzma_block_decoder(&m_stream, &m_block) == LZMA_OK;
+
+                    // The filter options are only needed to set up the decoder
+                    for (auto &filter : filters) {
+                        if (filter.id == LZMA_VLI_UNKNOWN)
+                            break;
+
+                        std::free(filter.options);
+                    }
+                    m_block.filters = nullptr;
+
+                    input = input.subspan(m_block.header_size);
+                    m_stream.next_in  = input.data();
+                    m_stream.avail_in = input.size();
+                }
+
+                ~XZDecoder() override {
+                    lzma_end(&m_stream);
+                }
+
+                size_t decode(u8 *buffer, size_t size) override {
+                    m_stream.next_out  = buffer;
+                    m_stream.avail_out = size;
+
+                    // The decoder stops at the end of its block, the next block gets its own decoder
+                    while (m_valid && m_stream.avail_out > 0) {
+                        if (lzma_code(&m_stream, m_stream.avail_in == 0 ? LZMA_FINISH : LZMA_RUN) != LZMA_OK)
+                            m_valid = false;
+                    }
+
+                    return size - m_stream.avail_out;
+                }
+
+            private:
+                lzma_stream m_stream = LZMA_STREAM_INIT;
+
+                // Block decoders keep referring to the block header while decoding
+                lzma_block m_block = { };
+                bool m_valid = false;
+            };
+
+            std::optional<Index> buildXZIndex(std::span<const u8> data) {
+                lzma_index *combinedIndex = nullptr;
+                ON_SCOPE_EXIT { lzma_index_end(combinedIndex, nullptr); };
+
+                // Every stream ends with an index of its blocks, so nothing has to be decompressed. Walk through the streams backwards using their footers to find them
+                u64 position = data.size();
+                while (position > 0) {
+                    // Streams may be followed by zero padding in multiples of four bytes
+                    u64 padding = 0;
+                    while (position >= 4 && std::all_of(data.begin() + (position - 4), data.begin() + position, [](u8 byte) { return byte == 0x00; })) {
+                        position -= 4;
+                        padding  += 4;
+                    }
+
+                    if (position < LZMA_STREAM_HEADER_SIZE * 2)
+                        return std::nullopt;
+
+                    lzma_stream_flags footerFlags;
+                    if (lzma_stream_footer_decode(&footerFlags, data.data() + position - LZMA_STREAM_HEADER_SIZE) != LZMA_OK)
+                        return std::nullopt;
+
+                    if (position < LZMA_STREAM_HEADER_SIZE * 2 + footerFlags.backward_size)
+                        return std::nullopt;
+
+                    const auto indexPosition = position - LZMA_STREAM_HEADER_SIZE - footerFlags.backward_size;
+
+                    lzma_index *streamIndex = nullptr;
+                    ON_SCOPE_EXIT { lzma_index_end(streamIndex, nullptr); };
+
+                    u64 memoryLimit = std::numeric_limits<u64>::max();
+                    size_t indexOffset = 0;
+                    if (lzma_index_buffer_decode(&streamIndex, &memoryLimit, nullptr, data.data() + indexPosition, &indexOffset, footerFlags.backward_size) != LZMA_OK)
+                        return std::nullopt;
+
+                    const auto streamSize = lzma_index_stream_size(streamIndex);
+                    if (position < streamSize)
+                        return std::nullopt;
+
+                    const auto streamStart = position - streamSize;
+
+                    lzma_stream_flags headerFlags;
+                    if (lzma_stream_header_decode(&headerFlags, data.data() + streamStart) != LZMA_OK)
+                        return std::nullopt;
+                    if (lzma_stream_flags_compare(&headerFlags, &footerFlags) != LZMA_OK)
+                        return std::nullopt;
+
+                    if (lzma_index_stream_flags(streamIndex, &footerFlags) != LZMA_OK)
+                        return std::nullopt;
+                    if (lzma_index_stream_padding(streamIndex, padding) != LZMA_OK)
+                        return std::nullopt;
+
+                    if (combinedIndex != nullptr) {
+                        if (lzma_index_cat(streamIndex, combinedIndex, nullptr) != LZMA_OK)
+                            return std::nullopt;
+                    }
+
+                    combinedIndex = std::exchange(streamIndex, nullptr);
+                    position = streamStart;
+                }
+
+                if (combinedIndex == nullptr)
+                    return std::nullopt;
+
+                Index index;
+                index.format = Format::XZ;
+                index.uncompressedSize = lzma_index_uncompressed_size(combinedIndex);
+
+                lzma_index_iter iterator;
+                lzma_index_iter_init(&iterator, combinedIndex);
+                while (!lzma_index_iter_next(&iterator, LZMA_INDEX_ITER_NONEMPTY_BLOCK)) {
+                    const auto &block = iterator.block;
+                    index.seekPoints.push_back({ block.uncompressed_file_offset, block.compressed_file_offset, true, u8(iterator.stream.flags->check), { } });
+                }
+
+                return index;
+            }
+
+        #endif
+
+        #if IMHEX_FEATURE_ENABLED(BZIP2)
+
+            bool isBZip2Stream(std::span<const u8> data, u64 offset) {
+                return offset + 4 <= data.size() && data[offset] == 'B' && data[offset + 1] == 'Z' && data[offset + 2] == 'h' && data[offset + 3] >= '1' && data[offset + 3] <= '9';
+            }
+
+            class BZip2Decoder : public Decoder {
+            public:
+                /**
+                 * @param stopAtStreams Return early whenever a new stream starts, so the caller can find out where they begin
+                 */
+                BZip2Decoder(std::span<const u8> data, const SeekPoint &seekPoint, bool stopAtStreams = false)
+                    : m_data(data), m_position(seekPoint.compressedOffset), m_stopAtStreams(stopAtStreams) {
+                    m_initialized = BZ2_bzDecompressInit(&m_stream, 0, 0) == BZ_OK;
+                    m_valid = m_initialized;
+                }
+
+                ~BZip2Decoder() override {
+                    if (m_initialized)
+                        BZ2_bzDecompressEnd(&m_stream);
+                }
+
+                /**
+                 * @brief Gets the offset of the stream that's currently being decoded
+                 */
+                [[nodiscard]] u64 getStreamOffset() const { return m_streamOffset; }
+
+                /**
+                 * @brief Checks if the end of the last stream has been reached without running into corrupted data
+                 */
+                [[nodiscard]] bool isComplete() const { return m_complete; }
+
+                size_t decode(u8 *buffer, size_t size) override {
+                    size = std::min(size, MaxChunkSize);
+                    m_stream.next_out  = reinterpret_cast<char*>(buffer);
+                    m_stream.avail_out = static_cast<unsigned int>(size);
+
+                    while (m_valid && m_stream.avail_out > 0) {
+                        if (m_stream.avail_in == 0) {
+                            if (m_position >= m_data.size()) {
+                                m_valid = false;
+                                break;
+                            }
+
+                            const auto chunkSize = std::min<u64>(m_data.size() - m_position, MaxChunkSize);
+                            m_stream.next_in  = reinterpret_cast<char*>(const_cast<u8*>(m_data.data() + m_position));
+                            m_stream.avail_in = static_cast<unsigned int>(chunkSize);
+                            m_position += chunkSize;
+                        }
+
+                        const auto result = BZ2_bzDecompress(&m_stream);
+                        if (result == BZ_STREAM_END) {
+                            // Files compressed in parallel consist of many streams, continue with the next one
+                            const auto nextStream = m_position - m_stream.avail_in;
+
+                            BZ2_bzDecompressEnd(&m_stream);
+                            m_initialized = false;
+
+                            if (!isBZip2Stream(m_data, nextStream)) {
+                                m_complete = true;
+                                m_valid = false;
+                                break;
+                            }
+
+                            if (BZ2_bzDecompressInit(&m_stream, 0, 0) != BZ_OK) {
+                                m_valid = false;
+                                break;
+                            }
+
+                            m_initialized = true;
+                            m_position = m_streamOffset = nextStream;
+                            m_stream.avail_in = 0;
+
+                            if (m_stopAtStreams)
+                                break;
+                        } else if (result != BZ_OK) {
+                            m_valid = false;
+                        }
+                    }
+
+                    return size - m_stream.avail_out;
+                }
+
+            private:
+                std::span<const u8> m_data;
+                u64 m_position;
+                u64 m_streamOffset = m_position;
+                bool m_stopAtStreams;
+
+                bz_stream m_stream = { };
+                bool m_initialized = false;
+                bool m_valid = false;
+                bool m_complete = false;
+            };
+
+            std::optional<Index> buildBZip2Index(std::span<const u8> data, const CompressedFileProvider::ProgressCallback &progressCallback) {
+                Index index;
+                index.format = Format::BZip2;
+                index.seekPoints.push_back({ 0, 0, true, 0, { } });
+
+                BZip2Decoder decoder(data, index.seekPoints.front(), true);
+                std::vector<u8> buffer(IndexChunkSize);
+
+                // The decoder returns at the start of every stream, so each of them can be added as a seek point
+                u64 totalOut = 0;
+                while (true) {
+                    const auto decoded = decoder.decode(buffer.data(), buffer.size());
+                    totalOut += decoded;
+
+                    if (decoder.getStreamOffset() > index.seekPoints.back().compressedOffset) {
+                        if (totalOut > index.seekPoints.back().uncompressedOffset)
+                            index.seekPoints.push_back({ totalOut, decoder.getStreamOffset(), true, 0, { } });
+                        else
+                            index.seekPoints.back().compressedOffset = decoder.getStreamOffset();
+                    } else if (decoded == 0) {
+                        break;
+                    }
+
+                    progressCallback(decoder.getStreamOffset());
+                }
+
+                if (!decoder.isComplete())
+                    return std::nullopt;
+
+                index.uncompressedSize = totalOut;
+                return index;
+            }
+
+        #endif
+
+        template<typename T>
+        void appendValue(std::vector<u8> &buffer, T value) {
+            const auto bytes = std::bit_cast<std::array<u8, sizeof(T)>>(value);
+            buffer.insert(buffer.end(), bytes.begin(), bytes.end());
+        }
+
+        template<typename T>
+        bool readValue(std::span<const u8> &data, T &value) {
+            if (data.size() < sizeof(T))
+                return false;
+
+            std::memcpy(&value, data.data(), sizeof(T));
+            data = data.subspan(sizeof(T));
+
+            return true;
+        }
+
+        std::optional<std::pair<u64, i64>> getFileStamp(const std::fs::path &path) {
+            wolv::io::File file(path, wolv::io::File::Mode::Read);
+            if (!file.isValid())
+                return std::nullopt;
+
+            const auto fileInfo = file.getFileInfo();
+            if (!fileInfo.has_value())
+                return std::nullopt;
+
+            return std::pair<u64, i64> { file.getSize(), i64(fileInfo->st_mtime) };
+        }
+
+    }
+
+    CompressedFileProvider::CompressedFileProvider() : m_cache(CacheBlockSize, CacheMaxBlocks) { }
+
+    CompressedFileProvider::~CompressedFileProvider() = default;
+
+    CompressedFileProvider::Format CompressedFileProvider::detectFormat(std::span<const u8> data) {
+        const auto startsWith = [&data](std::initializer_list<u8> magic) {
+            return data.size() >= magic.size() && std::equal(magic.begin(), magic.end(), data.begin());
+        };
+
+        if (startsWith({ 0x1F, 0x8B }))
+            return Format::GZip;
+        if (startsWith({ 0x28, 0xB5, 0x2F, 0xFD }))
+            return Format::ZStandard;
+        if (startsWith({ 0xFD, '7', 'z', 'X', 'Z', 0x00 }))
+            return Format::XZ;
+        if (startsWith({ 'B', 'Z', 'h' }))
+            return Format::BZip2;
+
+        return Format::Unknown;
+    }
+
+    std::optional<CompressedFileProvider::Index> CompressedFileProvider::buildIndex(std::span<const u8> data, const ProgressCallback &progressCallback) {
+        switch (detectFormat(data)) {
+            #if IMHEX_FEATURE_ENABLED(ZLIB)
+                case Format::GZip:      return buildGZipIndex(data, progressCallback);
+            #endif
+            #if IMHEX_FEATURE_ENABLED(ZSTD)
+                case Format::ZStandard: return buildZStdIndex(data, progressCallback);
+            #endif
+            #if IMHEX_FEATURE_ENABLED(LIBLZMA)
+                case Format::XZ:        return buildXZIndex(data);
+            #endif
+            #if IMHEX_FEATURE_ENABLED(BZIP2)
+                case Format::BZip2:     return buildBZip2Index(data, progressCallback);
+            #endif
+            default:
+                hex::unused(progressCallback);
+                return std::nullopt;
+        }
+    }
+
+    std::optional<CompressedFileProvider::Index> CompressedFileProvider::loadIndex(const std::fs::path &path) {
+        const auto fileStamp = getFileStamp(path);
+        if (!fileStamp.has_value())
+            return std::nullopt;
+
+        wolv::io::File file(getIndexPath(path), wolv::io::File::Mode::Read);
+        if (!file.isValid())
+            return std::nullopt;
+
+        const auto content = file.readVector();
+        std::span<const u8> data = content;
+
+        std::array<u8, IndexMagic.size()> magic;
+        u32 version = 0;
+        u64 fileSize = 0, pointCount = 0;
+        i64 modificationTime = 0;
+        u8 format = 0;
+        Index index;
+
+        if (!readValue(data, magic) || magic != IndexMagic)
+            return std::nullopt;
+        if (!readValue(data, version) || version != IndexVersion)
+            return std::nullopt;
+
+        // The index is only valid for the exact file it was built from
+        if (!readValue(data, fileSize) || !readValue(data, modificationTime) || std::pair(fileSize, modificationTime) != *fileStamp)
+            return std::nullopt;
+
+        if (!readValue(data, format) || !readValue(data, index.uncompressedSize) || !readValue(data, pointCount))
+            return std::nullopt;
+
+        index.format = Format(format);
+        if (!isFormatSupported(index.format))
+            return std::nullopt;
+
+        for (u64 i = 0; i < pointCount; i += 1) {
+            SeekPoint seekPoint = { };
+            u8 streamStart = 0;
+            u32 windowSize = 0;
+
+            if (!readValue(data, seekPoint.uncompressedOffset) || !readValue(data, seekPoint.compressedOffset) || !readValue(data, streamStart) || !readValue(data, seekPoint.bits) || !readValue(data, windowSize))
+                return std::nullopt;
+            if (data.size() < windowSize || seekPoint.compressedOffset > fileSize || seekPoint.uncompressedOffset > index.uncompressedSize)
+                return std::nullopt;
+            if (!index.seekPoints.empty() && seekPoint.uncompressedOffset < index.seekPoints.back().uncompressedOffset)
+                return std::nullopt;
+
+            seekPoint.streamStart = streamStart != 0;
+            seekPoint.window.assign(data.begin(), data.begin() + windowSize);
+            data = data.subspan(windowSize);
+
+            index.seekPoints.push_back(std::move(seekPoint));
+        }
+
+        return index;
+    }
+
+    void CompressedFileProvider::storeIndex(const std::fs::path &path, const Index &index) {
+        const auto fileStamp = getFileStamp(path);
+        if (!fileStamp.has_value())
+            return;
+
+        // The index is only a cache for the local machine, so values are simply stored in native byte order
+        std::vector<u8> data;
+        appendValue(data, IndexMagic);
+        appendValue(data, IndexVersion);
+        appendValue(data, fileStamp->first);
+        appendValue(data, fileStamp->second);
+        appendValue(data, u8(index.format));
+        appendValue(data, index.uncompressedSize);
+        appendValue(data, u64(index.seekPoints.size()));
+
+        for (const auto &seekPoint : index.seekPoints) {
+            appendValue(data, seekPoint.uncompressedOffset);
+            appendValue(data, seekPoint.compressedOffset);
+            appendValue(data, u8(seekPoint.streamStart));
+            appendValue(data, seekPoint.bits);
+            appendValue(data, u32(seekPoint.window.size()));
+            data.insert(data.end(), seekPoint.window.begin(), seekPoint.window.end());
+        }
+
+        // Failing to store the index only means it has to be built again next time
+        wolv::io::File file(getIndexPath(path), wolv::io::File::Mode::Create);
+        if (!file.isValid()) {
+            log::warn("Failed to store seek point index for '{}'", wolv::util::toUTF8String(path));
+            return;
+        }
+
+        file.writeVector(data);
+    }
+
+    std::unique_ptr<CompressedFileProvider::Decoder> CompressedFileProvider::createDecoder(size_t seekPointIndex) const {
+        const auto &seekPoint = m_index->seekPoints[seekPointIndex];
+
+        switch (m_index->format) {
+            #if IMHEX_FEATURE_ENABLED(ZLIB)
+                case Format::GZip:      return std::make_unique<GZipDecoder>(m_data, seekPoint);
+            #endif
+            #if IMHEX_FEATURE_ENABLED(ZSTD)
+                case Format::ZStandard: return std::make_unique<ZStdDecoder>(m_data, seekPoint);
+            #endif
+            #if IMHEX_FEATURE_ENABLED(LIBLZMA)
+                case Format::XZ:        return std::make_unique<XZDecoder>(m_data, seekPoint);
+            #endif
+            #if IMHEX_FEATURE_ENABLED(BZIP2)
+                case Format::BZip2:     return std::make_unique<BZip2Decoder>(m_data, seekPoint);
+            #endif
+            default:
+                hex::unused(seekPoint);
+                return nullptr;
+        }
+    }
+
+    bool CompressedFileProvider::decompress(u64 address, void *buffer, size_t size) {
+        std::scoped_lock lock(m_decoderMutex);
+
+        const auto &seekPoints = m_index->seekPoints;
+        const auto findSeekPoint = [&seekPoints](u64 offset) -> std::optional<size_t> {
+            auto it = std::ranges::upper_bound(seekPoints, offset, { }, &SeekPoint::uncompressedOffset);
+            if (it == seekPoints.begin())
+                return std::nullopt;
+
+            return std::distance(seekPoints.begin(), it) - 1;
+        };
+
+        const auto seekPoint = findSeekPoint(address);
+        if (!seekPoint.has_value())
+            return false;
+
+        // Sequential reads continue where the last one stopped. Everything else starts over from the closest seek point
+        if (m_decoder == nullptr || m_decoderPosition > address || m_decoderPosition < seekPoints[*seekPoint].uncompressedOffset) {
+            m_decoder          = this->createDecoder(*seekPoint);
+            m_decoderSeekPoint = *seekPoint;
+            m_decoderPosition  = seekPoints[*seekPoint].uncompressedOffset;
+        }
+
+        const auto decodeNext = [&](u8 *target, size_t count) {
+            size_t decodedSize = 0;
+            while (m_decoder != nullptr && decodedSize < count) {
+                const auto decoded = m_decoder->decode(target + decodedSize, count - decodedSize);
+                if (decoded == 0) {
+                    // Decoders of block based formats stop at the end of their block, switch over to the next one
+                    const auto nextSeekPoint = findSeekPoint(m_decoderPosition);
+                    if (!nextSeekPoint.has_value() || *nextSeekPoint <= m_decoderSeekPoint || seekPoints[*nextSeekPoint].uncompressedOffset != m_decoderPosition)
+                        break;
+
+                    m_decoder          = this->createDecoder(*nextSeekPoint);
+                    m_decoderSeekPoint = *nextSeekPoint;
+                    continue;
+                }
+
+                decodedSize       += decoded;
+                m_decoderPosition += decoded;
+            }
+
+            return decodedSize;
+        };
+
+        if (m_decoderPosition < address) {
+            std::vector<u8> skipBuffer(SkipBufferSize);
+            while (m_decoderPosition < address) {
+                const auto skipSize = std::min<u64>(address - m_decoderPosition, skipBuffer.size());
+                if (decodeNext(skipBuffer.data(), skipSize) != skipSize) {
+                    m_decoder.reset();
+                    return false;
+                }
+            }
+        }
+
+        if (decodeNext(static_cast<u8*>(buffer), size) != size) {
+            m_decoder.reset();
+            return false;
+        }
+
+        return true;
+    }
+
+    void CompressedFileProvider::readRaw(u64 offset, void *buffer, size_t size) {
+        std::memset(buffer, 0x00, size);
+
+        if (!m_dataValid)
+            return;
+
+        m_cache.read(offset, buffer, size, [this](u64 address, void *blockBuffer, size_t blockSize) {
+            return this->decompress(address, blockBuffer, blockSize);
+        });
+    }
+
+    void CompressedFileProvider::writeRaw(u64 offset, const void *buffer, size_t size) {
+        hex::unused(offset, buffer, size);
+    }
+
+    u64 CompressedFileProvider::getActualSize() const {
+        return m_index.has_value() ? m_index->uncompressedSize : 0;
+    }
+
+    bool CompressedFileProvider::open() {
+        m_dataValid = false;
+
+        wolv::io::File file(m_path, wolv::io::File::Mode::Read);
+        if (!file.isValid()) {
+            this->setErrorMessage(hex::format("hex.decompress.provider.compressed_file.error.open"_lang, wolv::util::toUTF8String(m_path), ::strerror(errno)));
+            return false;
+        }
+
+        m_file = std::move(file);
+        if (!m_file.map()) {
+            this->setErrorMessage(hex::format("hex.decompress.provider.compressed_file.error.open"_lang, wolv::util::toUTF8String(m_path), ::strerror(errno)));
+            return false;
+        }
+
+        m_data = { m_file.getMapping(), size_t(m_file.getSize()) };
+        m_file.close();
+
+        const auto format = detectFormat(m_data);
+        if (!isFormatSupported(format)) {
+            this->setErrorMessage("hex.decompress.provider.compressed_file.error.unsupported"_lang);
+            return false;
+        }
+
+        if (!m_index.has_value())
+            m_index = loadIndex(m_path);
+
+        if (!m_index.has_value()) {
+            // Happens when the file is opened from a project or its index went missing in the meantime
+            m_index = buildIndex(m_data, [](u64) { });
+            if (m_index.has_value())
+                storeIndex(m_path, *m_index);
+        }
+
+        if (!m_index.has_value() || m_index->format != format) {
+            this->setErrorMessage("hex.decompress.provider.compressed_file.error.corrupted"_lang);
+            return false;
+        }
+
+        m_decoder.reset();
+        m_cache.invalidate();
+        m_cache.setEndAddress(m_index->uncompressedSize);
+
+        m_dataValid = true;
+
+        return true;
+    }
+
+    void CompressedFileProvider::close() {
+        m_dataValid = false;
+
+        {
+            std::scoped_lock lock(m_decoderMutex);
+            m_decoder.reset();
+        }
+
+        m_cache.invalidate();
+        m_file.unmap();
+        m_data = { };
+    }
+
+    std::string CompressedFileProvider::getName() const {
+        return hex::format("hex.decompress.provider.compressed_file.name"_lang, wolv::util::toUTF8String(m_path.filename()));
+    }
+
+    std::vector<CompressedFileProvider::Description> CompressedFileProvider::getDataDescription() const {
+        std::vector<Description> result;
+
+        result.emplace_back("hex.builtin.provider.file.path"_lang, wolv::util::toUTF8String(m_path));
+        result.emplace_back("hex.decompress.provider.compressed_file.uncompressed_size"_lang, hex::toByteString(this->getActualSize()));
+
+        if (m_index.has_value()) {
+            result.emplace_back("hex.decompress.provider.compressed_file.format"_lang, getFormatName(m_index->format));
+            result.emplace_back("hex.decompress.provider.compressed_file.compressed_size"_lang, hex::toByteString(m_data.size()));
+            result.emplace_back("hex.decompress.provider.compressed_file.seek_points"_lang, std::to_string(m_index->seekPoints.size()));
+        }
+
+        return result;
+    }
+
+    bool CompressedFileProvider::handleFilePicker() {
+        std::fs::path path;
+        auto picked = fs::openFileBrowser(fs::DialogMode::Open, {
+                { "gzip Compressed File",  "gz"  },
+                { "zstd Compressed File",  "zst" },
+                { "xz Compressed File",    "xz"  },
+                { "bzip2 Compressed File", "bz2" }
+            }, [&path](const std::fs::path &pickedPath) {
+                path = pickedPath;
+            }
+        );
+
+        if (!picked)
+            return false;
+        if (!wolv::io::fs::isRegularFile(path))
+            return false;
+
+        m_path = path;
+
+        if (!isFormatSupported(detectFormat(wolv::io::File(path, wolv::io::File::Mode::Read).readVector(8)))) {
+            ui::ToastError::open("hex.decompress.provider.compressed_file.error.unsupported"_lang);
+            return false;
+        }
+
+        // Files that have been opened before already have an index next to them
+        if (auto index = loadIndex(path); index.has_value()) {
+            m_index = std::move(index);
+            return true;
+        }
+
+        // Building the index requires decompressing the whole file once. Do that in the background and open the file once it's done
+        TaskManager::createTask("hex.decompress.provider.compressed_file.indexing", TaskManager::NoProgress, [path](Task &task) {
+            wolv::io::File file(path, wolv::io::File::Mode::Read);
+            if (!file.isValid() || !file.map()) {
+                TaskManager::doLater([path] {
+                    ui::ToastError::open(hex::format("hex.decompress.provider.compressed_file.error.open"_lang, wolv::util::toUTF8String(path), ::strerror(errno)));
+                });
+                return;
+            }
+            ON_SCOPE_EXIT { file.unmap(); };
+
+            const std::span<const u8> data = { file.getMapping(), size_t(file.getSize()) };
+            task.setMaxValue(data.size());
+
+            auto index = buildIndex(data, [&task](u64 processedBytes) {
+                task.update(processedBytes);
+            });
+
+            if (!index.has_value()) {
+                TaskManager::doLater([] {
+                    ui::ToastError::open("hex.decompress.provider.compressed_file.error.corrupted"_lang);
+                });
+                return;
+            }
+
+            storeIndex(path, *index);
+
+            TaskManager::doLater([path, index = std::move(*index)]() mutable {
+                auto newProvider = ImHexApi::Provider::createProvider("hex.decompress.provider.compressed_file", true);
+
+                if (auto compressedFileProvider = dynamic_cast<CompressedFileProvider*>(newProvider); compressedFileProvider != nullptr) {
+                    compressedFileProvider->setPath(path);
+                    compressedFileProvider->setIndex(std::move(index));
+
+                    if (compressedFileProvider->open()) {
+                        EventProviderOpened::post(newProvider);
+                    } else {
+                        ui::ToastError::open(hex::format("hex.builtin.provider.error.open"_lang, compressedFileProvider->getErrorMessage()));
+                        ImHexApi::Provider::remove(newProvider);
+                    }
+                }
+            });
+        });
+
+        return false;
+    }
+
+    void CompressedFileProvider::loadSettings(const nlohmann::json &settings) {
+        Provider::loadSettings(settings);
+
+        auto path = settings.at("path").get<std::string>();
+        m_path = std::u8string(path.begin(), path.end());
+    }
+
+    nlohmann::json CompressedFileProvider::storeSettings(nlohmann::json settings) const {
+        settings["path"] = wolv::util::toUTF8String(m_path);
+
+        return Provider::storeSettings(settings);
+    }
+
+}
@@ -4,10 +4,12 @@
 #include <hex/helpers/logger.hpp>
 
 #include <romfs/romfs.hpp>
+#include <nlohmann/json.hpp>
 
 namespace hex::plugin::decompress {
 
     void registerPatternLanguageFunctions();
+    void registerProviders();
 
 }
 
@@ -16,8 +18,11 @@ using namespace hex::plugin::decompress;
 
 IMHEX_PLUGIN_SETUP("Decompressing", "WerWolv", "Support for decompressing data") {
     hex::log::debug("Using romfs: '{}'", romfs::name());
+    for (auto &path : romfs::list("lang"))
+        hex::ContentRegistry::Language::addLocalization(nlohmann::json::parse(romfs::get(path).string()));
 
     registerPatternLanguageFunctions();
+    registerProviders();
 }
 
 IMHEX_PLUGIN_FEATURES() {
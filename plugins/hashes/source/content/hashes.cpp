@@ -19,16 +19,11 @@ namespace hex::plugin::hashes {
         using namespace wolv::literals;
 
         std::vector<u8> hashProviderRegion(const Region& region, prv::Provider *provider, auto &hashFunction) {
-            auto reader = prv::ProviderReader(provider);
-            reader.seek(region.getStartAddress());
-            reader.setEndAddress(region.getEndAddress());
-
-            for (u64 address = region.getStartAddress(); address < region.getEndAddress(); address += 1_MiB) {
-                u64 readSize = std::min<u64>(1_MiB, (region.getEndAddress() - address) + 1);
-
-                auto data = reader.read(address, readSize);
-                hashFunction->TransformBytes({ data.begin(), data.end() }, address - region.getStartAddress(), data.size());
-            }
+            // Hash the chunks straight out of the provider. The data stays locked until the callback returns, which only covers a single chunk
+            prv::forEachChunk(provider, region, [&](u64, std::span<const u8> data) {
+                hashFunction->TransformUntyped(data.data(), data.size());
+                return true;
+            });
 
             auto result = hashFunction->TransformFinal();
 
@@ -217,15 +217,13 @@ namespace hex::ui {
                     std::vector<u8> oldData(m_editingBytes.size());
                     m_provider->read(*m_editingAddress, oldData.data(), oldData.size());
 
-                    size_t writtenBytes = 0;
+                    prv::WriteBatch batch("hex.builtin.undo_operation.modification");
                     for (size_t i = 0; i < m_editingBytes.size(); i += 1) {
-                        if (m_editingBytes[i] != oldData[i]) {
-                            m_provider->write(*m_editingAddress + i, &m_editingBytes[i], 1);
-                            writtenBytes += 1;
-                        }
+                        if (m_editingBytes[i] != oldData[i])
+                            batch.write(*m_editingAddress + i, &m_editingBytes[i], 1);
                     }
 
-                    m_provider->getUndoStack().groupOperations(writtenBytes, "hex.builtin.undo_operation.modification");
+                    m_provider->write(batch);
                 }
 
 
@@ -409,6 +407,19 @@ namespace hex::ui {
                     m_visibleRowCount = ImGui::GetWindowSize().y / CharacterSize.y;
                     m_visibleRowCount = std::clamp<u32>(m_visibleRowCount, 1, numRows - m_scrollPosition);
 
+                    // Read the data of all visible rows in one batch
+                    const ImS64 endRow = std::min<ImS64>(m_scrollPosition + m_visibleRowCount + 5, numRows);
+                    std::vector<u8> visibleBytes(std::max<ImS64>(endRow - m_scrollPosition, 0) * m_bytesPerRow, 0x00);
+                    {
+                        std::vector<prv::Provider::ReadRequest> rowRequests;
+                        for (ImS64 y = m_scrollPosition; y < endRow; y++) {
+                            const u8 validBytes = std::min<u64>(m_bytesPerRow, m_provider->getSize() - y * m_bytesPerRow);
+                            rowRequests.push_back({ y * m_bytesPerRow + m_provider->getBaseAddress() + m_provider->getCurrentPageAddress(), validBytes, &visibleBytes[(y - m_scrollPosition) * m_bytesPerRow] });
+                        }
+
+                        m_provider->readv(rowRequests);
+                    }
+
                     // Loop over rows
                     for (ImS64 y = m_scrollPosition; y < (m_scrollPosition + m_visibleRowCount + 5) && y < numRows && numRows != 0; y++) {
                         // Draw address column
@@ -419,8 +430,7 @@ namespace hex::ui {
 
                         const u8 validBytes = std::min<u64>(m_bytesPerRow, m_provider->getSize() - y * m_bytesPerRow);
 
-                        std::vector<u8> bytes(m_bytesPerRow, 0x00);
-                        m_provider->read(y * m_bytesPerRow + m_provider->getBaseAddress() + m_provider->getCurrentPageAddress(), bytes.data(), validBytes);
+                        const std::span<u8> bytes(visibleBytes.data() + (y - m_scrollPosition) * m_bytesPerRow, m_bytesPerRow);
 
                         std::vector<std::tuple<std::optional<color_t>, std::optional<color_t>>> cellColors;
                         {
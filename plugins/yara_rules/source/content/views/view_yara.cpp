@@ -340,6 +340,8 @@ namespace hex::plugin::yara {
                         return nullptr;
 
                     block->size = context.currBlock.size;
+
+                    // Always copy the block, a direct view into the provider would block all writes to it while YARA is scanning
                     provider->read(context.currBlock.base + provider->getBaseAddress(), context.buffer.data(), context.buffer.size());
 
                     return context.buffer.data();
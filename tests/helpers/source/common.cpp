@@ -1,11 +1,33 @@
 #include <hex/test/tests.hpp>
 #include <hex/test/test_provider.hpp>
 
+#include <hex/helpers/candidate_set.hpp>
 #include <hex/helpers/crypto.hpp>
+#include <hex/helpers/interval_index.hpp>
+#include <hex/helpers/patches.hpp>
+#include <hex/providers/chunked_buffer.hpp>
+#include <hex/providers/piece_table.hpp>
+#include <hex/providers/process_memory.hpp>
+#include <hex/providers/sparse_memory_provider.hpp>
+#include <hex/providers/undo_redo/stack.hpp>
+#include <hex/providers/undo_redo/modification_data.hpp>
+
+#include <wolv/utils/guards.hpp>
 
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <thread>
 #include <vector>
 
+#if defined(OS_LINUX)
+    #include <csignal>
+    #include <sys/mman.h>
+    #include <sys/wait.h>
+    #include <unistd.h>
+#endif
+
 TEST_SEQUENCE("TestSucceeding") {
     TEST_SUCCESS();
 };
@@ -77,3 +99,511 @@ TEST_SEQUENCE("TestProvider_write") {
 
     TEST_SUCCESS();
 };
+
+TEST_SEQUENCE("PieceTable") {
+    std::vector<u8> original { 0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77 };
+    auto readOriginal  = [&](u64 offset, void *buffer, size_t size) { std::copy_n(original.begin() + offset, size, static_cast<u8*>(buffer)); };
+    auto writeOriginal = [&](u64 offset, const void *buffer, size_t size) { std::copy_n(static_cast<const u8*>(buffer), size, original.begin() + offset); };
+
+    hex::prv::PieceTable table(original.size());
+    TEST_ASSERT(!table.isModified());
+
+    table.insert(2, 3);
+    TEST_ASSERT(table.getSize() == 11);
+    TEST_ASSERT(table.isModified());
+
+    std::array<u8, 3> inserted { 0xAA, 0xBB, 0xCC };
+    table.write(2, inserted.data(), inserted.size(), writeOriginal);
+    table.remove(6, 2);
+
+    std::vector<u8> result(table.getSize());
+    table.read(0, result.data(), result.size(), readOriginal);
+    std::vector<u8> expected { 0x00, 0x11, 0xAA, 0xBB, 0xCC, 0x22, 0x55, 0x66, 0x77 };
+    TEST_ASSERT(result == expected);
+
+    u8 value = 0xFF;
+    table.write(0, &value, 1, writeOriginal);
+    TEST_ASSERT(original[0] == 0xFF);
+
+    table.reset(original.size());
+    TEST_ASSERT(!table.isModified());
+    TEST_ASSERT(table.getPieceCount() == 1);
+
+    TEST_SUCCESS();
+};
+
+TEST_SEQUENCE("ChunkedBuffer") {
+    constexpr static auto ChunkSize = hex::prv::ChunkedBuffer::ChunkSize;
+
+    std::vector<u8> data(ChunkSize * 3 + 0x10);
+    for (size_t i = 0; i < data.size(); i += 1)
+        data[i] = u8(i * 7);
+
+    hex::prv::ChunkedBuffer buffer;
+    buffer.append(data);
+    TEST_ASSERT(buffer.getSize() == data.size());
+    TEST_ASSERT(buffer.getPieceCount() == 4);
+
+    std::vector<u8> result(data.size());
+    buffer.read(0, result.data(), result.size());
+    TEST_ASSERT(result == data);
+
+    // Inserted bytes don't take up any storage until they get written to
+    buffer.insert(0x100, ChunkSize * 0x100);
+    data.insert(data.begin() + 0x100, ChunkSize * 0x100, 0x00);
+    TEST_ASSERT(buffer.getSize() == data.size());
+    TEST_ASSERT(buffer.getStorageSize() == ChunkSize * 3 + 0x10);
+
+    const std::array<u8, 4> bytes { 0xAA, 0xBB, 0xCC, 0xDD };
+    buffer.write(0xFE, bytes.data(), bytes.size());
+    buffer.write(ChunkSize * 0x80, bytes.data(), bytes.size());
+    std::copy(bytes.begin(), bytes.end(), data.begin() + 0xFE);
+    std::copy(bytes.begin(), bytes.end(), data.begin() + ChunkSize * 0x80);
+    TEST_ASSERT(buffer.getStorageSize() == ChunkSize * 5 + 0x10);
+
+    buffer.remove(0x80, ChunkSize * 0x90);
+    data.erase(data.begin() + 0x80, data.begin() + 0x80 + ChunkSize * 0x90);
+
+    result.resize(data.size());
+    buffer.read(0, result.data(), result.size());
+    TEST_ASSERT(result == data);
+
+    auto span = buffer.getSpan(0x10, 0x20);
+    TEST_ASSERT(span.has_value() && std::equal(span->begin(), span->end(), data.begin() + 0x10));
+    TEST_ASSERT(!buffer.getSpan(0x100, 0x10).has_value());
+
+    buffer.resize(0x20);
+    TEST_ASSERT(buffer.getSize() == 0x20);
+
+    TEST_SUCCESS();
+};
+
+TEST_SEQUENCE("IntervalIndex") {
+    hex::IntervalIndex<int> index;
+    index.insert(0x00, 0x10, 0, 1);
+    index.insert(0x08, 0x20, 1, 2);
+    index.insert(0x30, 0x40, 2, 3);
+    index.insert(0x50, 0x50, 3, 4);
+
+    TEST_ASSERT(index.size() == 3);
+    TEST_ASSERT(index.overlaps(0x0F, 0x10));
+    TEST_ASSERT(!index.overlaps(0x20, 0x30));
+
+    std::vector<int> values;
+    index.forEachOverlapping(0x0C, 0x31, [&](u64, u64, u64, int value) { values.push_back(value); });
+    TEST_ASSERT(values == std::vector<int>({ 1, 2, 3 }));
+
+    TEST_ASSERT(index.erase(0x08, 1));
+    TEST_ASSERT(!index.erase(0x08, 1));
+    TEST_ASSERT(!index.overlaps(0x10, 0x20));
+
+    TEST_SUCCESS();
+};
+
+TEST_SEQUENCE("ProviderSnapshot") {
+    std::vector<u8> data { 0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77 };
+    hex::test::TestProvider provider(&data);
+
+    std::array<u8, 4> newData { 0xAA, 0xBB, 0xCC, 0xDD };
+    provider.applyWrite(0, newData.data(), 2);
+
+    auto snapshot = provider.createSnapshot();
+    TEST_ASSERT(snapshot.getGeneration() == provider.getGeneration());
+
+    provider.applyWrite(1, newData.data() + 1, 3);
+    provider.applyWrite(2, newData.data(), 4);
+    TEST_ASSERT(provider.getGeneration() == snapshot.getGeneration() + 2);
+
+    std::vector<u8> result(data.size());
+    snapshot.read(0, result.data(), result.size());
+    std::vector<u8> expected { 0xAA, 0xBB, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77 };
+    TEST_ASSERT(result == expected);
+
+    provider.read(0, result.data(), result.size());
+    expected = { 0xAA, 0xBB, 0xAA, 0xBB, 0xCC, 0xDD, 0x66, 0x77 };
+    TEST_ASSERT(result == expected);
+    TEST_ASSERT(!snapshot.isStale());
+
+    // Inserting data shifts everything around, reads through older snapshots have to fail from then on
+    provider.applyInsert(0, 1);
+    TEST_ASSERT(snapshot.isStale());
+    TEST_ASSERT(!snapshot.read(0, result.data(), result.size()));
+    TEST_ASSERT(std::ranges::all_of(result, [](u8 byte) { return byte == 0x00; }));
+
+    std::vector<u8> fallbackBuffer;
+    TEST_ASSERT(snapshot.readSpan(0, result.size(), fallbackBuffer).empty());
+
+    TEST_SUCCESS();
+};
+
+TEST_SEQUENCE("ProviderModifiedRegions") {
+    std::vector<u8> data(0x100);
+    hex::test::TestProvider provider(&data);
+
+    const auto generation = provider.getGeneration();
+
+    std::array<u8, 0x10> newData { };
+    provider.applyWrite(0x20, newData.data(), 0x10);
+    provider.applyWrite(0x08, newData.data(), 0x08);
+    provider.applyWrite(0x28, newData.data(), 0x10);
+    provider.applyWrite(0x80, newData.data(), 0x01);
+
+    const auto modifiedRegions = provider.getModifiedRegions(generation);
+    TEST_ASSERT(modifiedRegions.has_value());
+
+    const std::vector<hex::Region> expected { { 0x08, 0x08 }, { 0x20, 0x18 }, { 0x80, 0x01 } };
+    TEST_ASSERT(*modifiedRegions == expected);
+
+    TEST_ASSERT(provider.getModifiedRegions(provider.getGeneration())->empty());
+
+    TEST_SUCCESS();
+};
+
+TEST_SEQUENCE("WriteBatch") {
+    hex::prv::WriteBatch batch("test");
+
+    std::array<u8, 0x10> newData { 0xAA, 0xBB, 0xCC, 0xDD, 0xEE };
+    batch.write(0x10, newData.data(), 2);
+    batch.write(0x12, newData.data() + 2, 2);
+    batch.write(0x20, newData.data(), 4);
+    batch.write(0x0F, newData.data() + 3, 2);
+    TEST_ASSERT(batch.getRunCount() == 2);
+    TEST_ASSERT(batch.getSize() == 9);
+
+    const std::vector<hex::Region> expectedRegions { { 0x0F, 0x05 }, { 0x20, 0x04 } };
+    TEST_ASSERT(batch.getRegions() == expectedRegions);
+
+    std::vector<u8> firstRun;
+    batch.forEachRun([&](u64 address, std::span<const u8> data) {
+        if (address == 0x0F)
+            firstRun.assign(data.begin(), data.end());
+    });
+
+    const std::vector<u8> expectedData { 0xDD, 0xEE, 0xBB, 0xCC, 0xDD };
+    TEST_ASSERT(firstRun == expectedData);
+
+    batch.write(0x14, newData.data(), 0x0C);
+    TEST_ASSERT(batch.getRunCount() == 1);
+
+    TEST_SUCCESS();
+};
+
+namespace {
+
+    class TestOperation : public hex::prv::undo::Operation {
+    public:
+        explicit TestOperation(std::vector<hex::Region> regions) : m_regions(std::move(regions)) { }
+
+        void undo(hex::prv::Provider *) override { }
+        void redo(hex::prv::Provider *) override { }
+
+        [[nodiscard]] hex::Region getRegion() const override { return m_regions.front(); }
+        [[nodiscard]] std::vector<hex::Region> getRegions() const override { return m_regions; }
+        [[nodiscard]] std::string format() const override { return "test"; }
+
+        [[nodiscard]] std::unique_ptr<Operation> clone() const override { return std::make_unique<TestOperation>(*this); }
+
+    private:
+        std::vector<hex::Region> m_regions;
+    };
+
+}
+
+TEST_SEQUENCE("UndoStackHighlighting") {
+    std::vector<u8> data(0x100);
+    hex::test::TestProvider provider(&data);
+
+    auto &stack = provider.getUndoStack();
+    stack.add<TestOperation>(std::vector<hex::Region> { { 0x10, 0x04 }, { 0x40, 0x10 } });
+    stack.add<TestOperation>(std::vector<hex::Region> { { 0x12, 0x08 } });
+
+    std::vector<hex::Region> expected { { 0x10, 0x04 }, { 0x12, 0x08 } };
+    TEST_ASSERT(*stack.getHighlightedRegions({ 0x00, 0x20 }) == expected);
+
+    stack.undo();
+    expected = { { 0x10, 0x04 } };
+    TEST_ASSERT(*stack.getHighlightedRegions({ 0x00, 0x20 }) == expected);
+
+    stack.redo();
+    stack.groupOperations(2, "test");
+    expected = { { 0x10, 0x04 }, { 0x12, 0x08 }, { 0x40, 0x10 } };
+    TEST_ASSERT(*stack.getHighlightedRegions({ 0x00, 0x100 }) == expected);
+    TEST_ASSERT(stack.getHighlightedRegions({ 0x20, 0x20 })->empty());
+
+    TEST_SUCCESS();
+};
+
+TEST_SEQUENCE("UndoModificationData") {
+    std::vector<u8> oldData(0x1000, 0x00), newData(0x1000, 0x00);
+    for (size_t i = 0; i < oldData.size(); i += 1)
+        oldData[i] = u8(i * 7);
+    newData = oldData;
+    newData[0x123] = 0xAA;
+    std::fill_n(newData.begin() + 0x800, 0x100, 0xFF);
+
+    hex::prv::undo::ModificationData data(oldData, newData);
+
+    data.compress();
+    TEST_ASSERT(data.isCompressed());
+    TEST_ASSERT(data.getMemoryUsage() < oldData.size() + newData.size());
+    TEST_ASSERT(data.getOldData() == oldData);
+    TEST_ASSERT(data.getNewData() == newData);
+
+    if (data.spill()) {
+        TEST_ASSERT(data.getMemoryUsage() == 0);
+        TEST_ASSERT(data.getOldData() == oldData);
+        TEST_ASSERT(data.getNewData() == newData);
+    }
+
+    TEST_SUCCESS();
+};
+
+TEST_SEQUENCE("UndoStackReentrancy") {
+    std::vector<u8> data(0x100);
+    hex::test::TestProvider firstProvider(&data), secondProvider(&data);
+
+    class NestingOperation : public TestOperation {
+    public:
+        explicit NestingOperation(hex::prv::Provider *target) : TestOperation({ { 0x00, 0x01 } }), m_target(target) { }
+
+        void redo(hex::prv::Provider *provider) override {
+            // Operations added to the executing stack itself get dropped, other stacks must still accept them
+            m_addedToSelf  = provider->getUndoStack().add<TestOperation>(std::vector<hex::Region> { { 0x10, 0x01 } });
+            m_addedToOther = m_target->getUndoStack().add<TestOperation>(std::vector<hex::Region> { { 0x20, 0x01 } });
+        }
+
+        bool m_addedToSelf = false, m_addedToOther = false;
+
+    private:
+        hex::prv::Provider *m_target;
+    };
+
+    TEST_ASSERT(firstProvider.getUndoStack().add<NestingOperation>(&secondProvider));
+
+    const auto operation = static_cast<NestingOperation*>(firstProvider.getUndoStack().getAppliedOperations().back().get());
+    TEST_ASSERT(!operation->m_addedToSelf);
+    TEST_ASSERT(operation->m_addedToOther);
+    TEST_ASSERT(firstProvider.getUndoStack().getAppliedOperations().size() == 1);
+    TEST_ASSERT(secondProvider.getUndoStack().getAppliedOperations().size() == 1);
+
+    TEST_SUCCESS();
+};
+
+TEST_SEQUENCE("IPSPatch") {
+    hex::Patches patches;
+
+    std::vector<u8> data(0x1'2000, 0xAA);
+    patches.get().write(0x100, data.data(), data.size());
+    patches.get().write(0x50, data.data(), 0x10);
+    patches.get().write(0x60, data.data(), 0x10);
+    TEST_ASSERT(patches.get().getExtentCount() == 2);
+
+    auto ipsPatch = patches.toIPSPatch();
+    TEST_ASSERT(ipsPatch.has_value());
+
+    auto loadedPatches = hex::Patches::fromIPSPatch(*ipsPatch);
+    TEST_ASSERT(loadedPatches.has_value());
+    TEST_ASSERT(loadedPatches->get().getRegions() == patches.get().getRegions());
+
+    std::vector<u8> streamedPatch;
+    TEST_ASSERT(patches.writeIPSPatch([&](std::span<const u8> part) { streamedPatch.insert(streamedPatch.end(), part.begin(), part.end()); }).has_value());
+    TEST_ASSERT(streamedPatch == *ipsPatch);
+
+    patches.get().write(0x1'0000'0000, data.data(), 0x10);
+    TEST_ASSERT(!patches.toIPS32Patch().has_value());
+
+    auto storedPatches = hex::Patches::fromExtentStream(patches.toExtentStream());
+    TEST_ASSERT(storedPatches.has_value());
+    TEST_ASSERT(storedPatches->get().getRegions() == patches.get().getRegions());
+    patches.get().erase(0x1'0000'0000, 0x10);
+
+    patches.get().removeRange(0x58, 0x10);
+    patches.get().insertGap(0x200, 0x08);
+    const std::vector<hex::Region> expected { { 0x50, 0x10 }, { 0xF0, 0x110 }, { 0x208, 0x1'1EF0 } };
+    TEST_ASSERT(patches.get().getRegions() == expected);
+
+    TEST_SUCCESS();
+};
+
+TEST_SEQUENCE("CandidateSet") {
+    hex::CandidateSet candidates;
+
+    // Sparse block with two candidates, dense block with one candidate at every even address
+    const std::vector<u16> sparseOffsets { 0x10, 0xFFFE };
+    const std::vector<u8> sparseValues { 0x11, 0x22, 0x33, 0x44 };
+    candidates.addBlock({ 0x1000, 2, sparseOffsets, sparseValues });
+
+    std::vector<u16> denseOffsets;
+    std::vector<u8> denseValues;
+    for (u32 offset = 0; offset < hex::CandidateSet::BlockSize; offset += 2) {
+        denseOffsets.push_back(offset);
+        denseValues.push_back(u8(offset));
+        denseValues.push_back(u8(offset >> 8));
+    }
+    candidates.addBlock({ 0x2'0000, 2, denseOffsets, denseValues });
+    candidates.addBlock({ 0x3'0000, 2, { }, { } });
+
+    TEST_ASSERT(candidates.getBlocks().size() == 2);
+    TEST_ASSERT(!candidates.getBlocks()[0].isDense());
+    TEST_ASSERT(candidates.getBlocks()[1].isDense());
+    TEST_ASSERT(candidates.getCount() == 2 + denseOffsets.size());
+    TEST_ASSERT(candidates.getBlocks()[1].getOffsets() == denseOffsets);
+
+    TEST_ASSERT(candidates.contains(0x1010));
+    TEST_ASSERT(candidates.contains(0x1'0FFE));
+    TEST_ASSERT(!candidates.contains(0x1011));
+    TEST_ASSERT(candidates.contains(0x2'1234));
+    TEST_ASSERT(!candidates.contains(0x2'1235));
+    TEST_ASSERT(!candidates.contains(0x3'0000));
+
+    u64 count = 0;
+    bool valuesMatch = true;
+    candidates.forEach([&](u64 address, std::span<const u8> value) {
+        if (address >= 0x2'0000)
+            valuesMatch = valuesMatch && value[0] == u8(address) && value[1] == u8(address >> 8);
+        else if (address == 0x1'0FFE)
+            valuesMatch = valuesMatch && value[0] == 0x33 && value[1] == 0x44;
+        count += 1;
+    });
+    TEST_ASSERT(count == candidates.getCount());
+    TEST_ASSERT(valuesMatch);
+
+    candidates.clear();
+    TEST_ASSERT(candidates.empty());
+    TEST_ASSERT(candidates.getCount() == 0);
+
+    TEST_SUCCESS();
+};
+
+TEST_SEQUENCE("ProcessSnapshot") {
+#if defined(OS_LINUX)
+    const auto pageSize = size_t(::sysconf(_SC_PAGESIZE));
+
+    // Four pages: data, zeros, an unmapped hole and a page with a single non-zero byte
+    auto memory = static_cast<u8*>(::mmap(nullptr, pageSize * 4, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+    TEST_ASSERT(memory != MAP_FAILED);
+    ::munmap(memory + pageSize * 2, pageSize);
+
+    const auto address = reinterpret_cast<u64>(memory);
+    ON_SCOPE_EXIT {
+        ::munmap(memory, pageSize * 2);
+        ::munmap(memory + pageSize * 3, pageSize);
+    };
+
+    int readyPipe[2];
+    TEST_ASSERT(::pipe(readyPipe) == 0);
+    ON_SCOPE_EXIT {
+        ::close(readyPipe[0]);
+        ::close(readyPipe[1]);
+    };
+
+    const auto childPid = ::fork();
+    TEST_ASSERT(childPid != -1);
+    if (childPid == 0) {
+        // The child gets its own copy of the mapping, fill it with data the parent never writes
+        std::memset(memory, 0xAA, pageSize);
+        memory[pageSize * 3 + 0x10] = 0x55;
+
+        const u8 ready = 1;
+        if (::write(readyPipe[1], &ready, sizeof(ready)) == sizeof(ready))
+            ::pause();
+        ::_exit(0);
+    }
+
+    ON_SCOPE_EXIT {
+        ::kill(childPid, SIGKILL);
+        ::waitpid(childPid, nullptr, 0);
+    };
+
+    u8 ready = 0;
+    TEST_ASSERT(::read(readyPipe[0], &ready, sizeof(ready)) == sizeof(ready));
+
+    const std::vector<hex::Region> regions = { { address, pageSize * 2 }, { address + pageSize * 3, pageSize } };
+
+    // Reads skip the unmapped hole and fill it with zeros
+    {
+        std::vector<u8> data(pageSize * 4, 0xFF);
+        const hex::prv::Provider::ReadRequest request = { address, data.size(), data.data() };
+
+        bool hitHole = false;
+        TEST_ASSERT(hex::prv::readProcessMemory(childPid, regions, { &request, 1 }, &hitHole));
+        TEST_ASSERT(hitHole);
+        TEST_ASSERT(std::all_of(data.begin(), data.begin() + pageSize, [](u8 byte) { return byte == 0xAA; }));
+        TEST_ASSERT(std::all_of(data.begin() + pageSize, data.begin() + pageSize * 3, [](u8 byte) { return byte == 0x00; }));
+        TEST_ASSERT(data[pageSize * 3 + 0x10] == 0x55);
+    }
+
+    // Without known regions, the unmapped page is read anyway and fails
+    {
+        std::vector<u8> data(pageSize, 0xFF);
+        const hex::prv::Provider::ReadRequest request = { address + pageSize * 2, data.size(), data.data() };
+
+        TEST_ASSERT(!hex::prv::readProcessMemory(childPid, { }, { &request, 1 }));
+        TEST_ASSERT(std::all_of(data.begin(), data.end(), [](u8 byte) { return byte == 0x00; }));
+    }
+
+    std::atomic<size_t> readCount = 0;
+    const auto readChild = [&](std::span<const hex::prv::Provider::ReadRequest> requests) {
+        readCount += 1;
+        hex::prv::readProcessMemory(childPid, regions, requests);
+    };
+
+    // A cancelled capture doesn't read anything anymore
+    {
+        hex::prv::SparseMemoryCapture capture(regions, pageSize, pageSize, readChild);
+        capture.cancel();
+        capture.work();
+        capture.waitForWorkers();
+
+        TEST_ASSERT(readCount == 0);
+        TEST_ASSERT(capture.getBytesProcessed() == 0);
+    }
+
+    // Capture the child's memory with one piece per page, split up between multiple workers
+    hex::prv::SparseMemoryCapture capture(regions, pageSize, pageSize, readChild);
+    TEST_ASSERT(capture.getWorkItemCount() == 3);
+    TEST_ASSERT(capture.getTotalSize() == pageSize * 3);
+
+    std::vector<std::thread> workers;
+    for (u32 i = 0; i < 3; i += 1)
+        workers.emplace_back([&capture] { capture.work(); });
+
+    capture.work();
+    capture.waitForWorkers();
+    TEST_ASSERT(readCount == 3);
+    TEST_ASSERT(capture.getBytesProcessed() == pageSize * 3);
+
+    for (auto &worker : workers)
+        worker.join();
+
+    auto chunks = capture.takeChunks();
+
+    // Only the two pages with data are stored, the zero page is left out
+    TEST_ASSERT(chunks.size() == 2);
+    TEST_ASSERT(chunks.contains(address) && chunks.at(address).size() == pageSize);
+    TEST_ASSERT(chunks.contains(address + pageSize * 3) && chunks.at(address + pageSize * 3).size() == pageSize);
+
+    hex::prv::SparseMemoryProvider provider;
+    provider.setData(regions, std::move(chunks));
+    TEST_ASSERT(provider.open());
+
+    std::vector<u8> data(pageSize * 4, 0xFF);
+    provider.read(address, data.data(), data.size());
+    TEST_ASSERT(std::all_of(data.begin(), data.begin() + pageSize, [](u8 byte) { return byte == 0xAA; }));
+    TEST_ASSERT(data[pageSize * 3 + 0x10] == 0x55);
+    data[pageSize * 3 + 0x10] = 0x00;
+    TEST_ASSERT(std::all_of(data.begin() + pageSize, data.end(), [](u8 byte) { return byte == 0x00; }));
+
+    // The data has to come from the child, the parent's copy of the mapping was never written to
+    TEST_ASSERT(memory[0] == 0x00);
+
+    TEST_ASSERT(provider.getRegionValidity(0) == std::pair(hex::Region { 0, address }, false));
+    TEST_ASSERT(provider.getRegionValidity(address + 0x10) == std::pair(regions[0], true));
+    TEST_ASSERT(provider.getRegionValidity(address + pageSize + 0x10) == std::pair(regions[0], true));
+    TEST_ASSERT(provider.getRegionValidity(address + pageSize * 2 + 0x10) == std::pair(hex::Region { address + pageSize * 2, pageSize }, false));
+    TEST_ASSERT(provider.getRegionValidity(address + pageSize * 3) == std::pair(regions[1], true));
+    TEST_ASSERT(provider.getRegionValidity(address + pageSize * 4) == std::pair(hex::Region::Invalid(), false));
+#endif
+
+    TEST_SUCCESS();
+};